@@ -0,0 +1,146 @@
+#define STDFUNCS_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Callback algorithms from STDFUNCS_IMPL against the ones
+// generated by STD_ALGO_DECL/STD_ORD_ALGO_DECL, on the
+// same data. The generated ones inline the predicate and
+// vectorize. The array fits in L2 so memory bandwidth
+// does not hide the difference, and the callbacks are
+// called through volatile pointers like they would be
+// from another translation unit.
+
+#define N (1 << 16)
+#define REPS 2048
+
+int
+is_positive_cb(const void *x)
+{
+  return *(const int *)x >= 0;
+}
+
+int
+compare_int(const void *a, const void *b)
+{
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y)-(x < y);
+}
+
+static inline int
+is_positive(int x)
+{
+  return x >= 0;
+}
+
+STD_ALGO_DECL(int, is_positive);
+STD_ORD_ALGO_DECL(int);
+
+int
+main(void)
+{
+  int *arr = malloc(N*sizeof(int));
+  for (int i = 0; i < N; ++i) {
+    arr[i] = i;
+  }
+  int (*volatile pred_cb)(const void *) = is_positive_cb;
+  CompareFunction volatile compare_cb = compare_int;
+  volatile size_t sink = 0;
+  double start;
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += stdall_of(arr, sizeof(int), N, pred_cb);
+  }
+  BENCH_REPORT("all_of callback", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += stdall_of_is_positive(arr, N);
+  }
+  BENCH_REPORT("all_of STD_ALGO_DECL", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    size_t count = 0;
+    for (size_t i = 0; i < N; ++i) {
+      count += pred_cb(&arr[i]);
+    }
+    sink += count;
+  }
+  BENCH_REPORT("count_if callback loop", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += stdcount_if_is_positive(arr, N);
+  }
+  BENCH_REPORT("count_if STD_ALGO_DECL", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += (const int *)std_is_sorted_until(arr, arr+N, sizeof(int), compare_cb)-arr;
+  }
+  BENCH_REPORT("is_sorted_until callback", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += stdis_sorted_until_int(arr, N);
+  }
+  BENCH_REPORT("is_sorted_until STD_ORD_ALGO_DECL", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += __std_is_sorted_until_i32_scalar(arr, N, STD_SORT_ASC, 1);
+  }
+  BENCH_REPORT("is_sorted_until_i32 scalar", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += std_is_sorted_until_i32(arr, N, STD_SORT_ASC);
+  }
+  BENCH_REPORT("is_sorted_until_i32 dispatched", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += stdmax_element_int(arr, N);
+  }
+  BENCH_REPORT("max_element STD_ORD_ALGO_DECL", (size_t)N*REPS, bench_now()-start);
+
+  int *out = malloc(N*sizeof(int));
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += (size_t)__std_sum_i32_scalar(arr, N, 0);
+  }
+  BENCH_REPORT("reduce_sum_i32 scalar", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += (size_t)std_reduce_sum_i32(arr, N);
+  }
+  BENCH_REPORT("reduce_sum_i32 dispatched", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    size_t lo = 0, hi = 0;
+    sink += std_minmax_i32(arr, N, &lo, &hi)+hi;
+  }
+  BENCH_REPORT("minmax_i32 dispatched", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    (void)__std_scan_i32_scalar(arr, out, N, 0, 0);
+    sink += (size_t)out[N-1];
+  }
+  BENCH_REPORT("inclusive_scan_i32 scalar", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    std_inclusive_scan_i32(arr, out, N);
+    sink += (size_t)out[N-1];
+  }
+  BENCH_REPORT("inclusive_scan_i32 dispatched", (size_t)N*REPS, bench_now()-start);
+
+  free(out);
+
+  free(arr);
+  return sink == 0;
+}
@@ -0,0 +1,32 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+// Wall clock time in seconds.
+static inline double
+bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec+(double)ts.tv_nsec*1e-9;
+}
+
+// Number of online CPUs, at least 1.
+static inline int
+bench_ncpus(void)
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n < 1 ? 1 : (int)n;
+}
+
+// Print one result line.
+#define BENCH_REPORT(name, items, secs)                                 \
+  do {                                                                  \
+    printf("%-40s %10.2f Mitems/s  (%.3fs)\n", (name),                  \
+           (double)(items)/(secs)/1e6, (secs));                         \
+  } while (0)
+
+#endif // BENCH_H
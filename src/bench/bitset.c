@@ -0,0 +1,59 @@
+#define STDBITSET_IMPL
+#define STDFUNCS_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Intersecting two flag masks and counting the result,
+// stored as an int per flag against a StdBitset.
+
+#define N (1 << 20)
+#define REPS 256
+
+int
+main(void)
+{
+  int *a = malloc(N*sizeof(int)), *b = malloc(N*sizeof(int)), *c = malloc(N*sizeof(int));
+  StdBitset x = stdbitset_new(N), y = stdbitset_new(N), z = stdbitset_new(N);
+  for (size_t i = 0; i < N; ++i) {
+    a[i] = i%3 == 0;
+    b[i] = i%5 == 0;
+    if (a[i]) stdbitset_set(&x, i);
+    if (b[i]) stdbitset_set(&y, i);
+  }
+  volatile size_t sink = 0;
+  double start;
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    size_t count = 0;
+    for (size_t i = 0; i < N; ++i) {
+      c[i] = a[i] & b[i];
+      count += c[i];
+    }
+    sink += count;
+  }
+  BENCH_REPORT("int flags and+count", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    stdbitset_fill(&z, 1);
+    stdbitset_and(&z, &x);
+    stdbitset_and(&z, &y);
+    sink += stdbitset_count(&z);
+  }
+  BENCH_REPORT("StdBitset and+count", (size_t)N*REPS, bench_now()-start);
+
+  start = bench_now();
+  for (int r = 0; r < REPS; ++r) {
+    sink += stdbitset_rank(&z, N/2);
+  }
+  BENCH_REPORT("StdBitset rank", (size_t)REPS, bench_now()-start);
+
+  free(a);
+  free(b);
+  free(c);
+  stdbitset_free(&x);
+  stdbitset_free(&y);
+  stdbitset_free(&z);
+  return sink == 0;
+}
@@ -0,0 +1,64 @@
+#define STDCONCURRENTMAP_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Read throughput of a shared StdConcurrentMap with
+// t = 1..max reader threads.
+
+#define N_KEYS (1 << 20)
+#define N_LOOKUPS (1 << 23)
+
+struct Ctx
+{
+  StdConcurrentMap *map;
+  size_t n;
+  uint64_t seed;
+  size_t hits;
+};
+
+void *
+reader(void *arg)
+{
+  struct Ctx *ctx = (struct Ctx *)arg;
+  uint64_t x = ctx->seed;
+  uint64_t v;
+  for (size_t i = 0; i < ctx->n; ++i) {
+    x = x*6364136223846793005ull+1442695040888963407ull;
+    uint64_t key = (x >> 33) % N_KEYS;
+    ctx->hits += stdconcurrentmap_get(ctx->map, &key, &v);
+  }
+  return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+  int max = argc > 1 ? atoi(argv[1]) : bench_ncpus();
+  StdConcurrentMap map = stdconcurrentmap_new(sizeof(uint64_t), sizeof(uint64_t), 64);
+  char name[64];
+
+  for (uint64_t i = 0; i < N_KEYS; ++i) {
+    stdconcurrentmap_put(&map, &i, &i);
+  }
+
+  for (int t = 1; t <= max; ++t) {
+    pthread_t threads[t];
+    struct Ctx ctxs[t];
+
+    double start = bench_now();
+    for (int i = 0; i < t; ++i) {
+      ctxs[i] = (struct Ctx) { .map = &map, .n = N_LOOKUPS/t, .seed = i+1, .hits = 0 };
+      pthread_create(&threads[i], NULL, reader, &ctxs[i]);
+    }
+    for (int i = 0; i < t; ++i) {
+      pthread_join(threads[i], NULL);
+    }
+    double secs = bench_now()-start;
+
+    snprintf(name, sizeof(name), "concurrentmap get %d threads", t);
+    BENCH_REPORT(name, (N_LOOKUPS/t)*t, secs);
+  }
+
+  stdconcurrentmap_free(&map);
+  return 0;
+}
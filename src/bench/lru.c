@@ -0,0 +1,150 @@
+#define STDLIST_IMPL
+#define STDVEC_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// An LRU cache of int keys with a fixed capacity, built
+// three ways: an intrusive StdList, a StdSlabList, and a
+// StdVec kept in recency order (the old way, which has to
+// find and memmove on every hit).
+
+#define N_KEYS (1 << 16)
+#define CAPACITY 4096
+#define N_ACCESSES (1 << 22)
+
+struct Entry
+{
+  int key;
+  StdListNode node;
+};
+
+// Keys are skewed so that most accesses hit.
+int *
+make_accesses(void)
+{
+  int *keys = malloc(N_ACCESSES*sizeof(int));
+  uint64_t x = 42;
+  for (size_t i = 0; i < N_ACCESSES; ++i) {
+    x = x*6364136223846793005ull+1442695040888963407ull;
+    uint64_t r = x >> 33;
+    keys[i] = (r & 7) ? (int)(r % (CAPACITY*3/4)) : (int)(r % N_KEYS);
+  }
+  return keys;
+}
+
+size_t
+lru_intrusive(int *accesses, size_t n)
+{
+  struct Entry *entries = malloc(CAPACITY*sizeof(*entries));
+  struct Entry **where = calloc(N_KEYS, sizeof(*where));
+  StdList lru = stdlist_new();
+  size_t used = 0, hits = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    int key = accesses[i];
+    struct Entry *e = where[key];
+    if (e) {
+      stdlist_move_to_front(&lru, &e->node);
+      ++hits;
+      continue;
+    }
+    if (used < CAPACITY) {
+      e = &entries[used++];
+    } else {
+      e = STDLIST_ENTRY(stdlist_pop_back(&lru), struct Entry, node);
+      where[e->key] = NULL;
+    }
+    e->key = key;
+    where[key] = e;
+    stdlist_push_front(&lru, &e->node);
+  }
+
+  free(where);
+  free(entries);
+  return hits;
+}
+
+size_t
+lru_slab(int *accesses, size_t n)
+{
+  int **where = calloc(N_KEYS, sizeof(*where));
+  StdSlabList lru = stdslablist_new(sizeof(int));
+  size_t hits = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    int key = accesses[i];
+    if (where[key]) {
+      stdslablist_move_to_front(&lru, where[key]);
+      ++hits;
+      continue;
+    }
+    if (stdslablist_len(&lru) == CAPACITY) {
+      int old;
+      stdslablist_pop_back(&lru, &old);
+      where[old] = NULL;
+    }
+    where[key] = stdslablist_push_front(&lru, &key);
+  }
+
+  stdslablist_free(&lru);
+  free(where);
+  return hits;
+}
+
+size_t
+lru_vec(int *accesses, size_t n)
+{
+  // Most recent at the end.
+  StdVec lru = stdvec_wcap(sizeof(int), CAPACITY+1);
+  char *present = calloc(N_KEYS, 1);
+  size_t hits = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    int key = accesses[i];
+    if (present[key]) {
+      int *p = stdvec_contains(&lru, &key);
+      stdvec_rm_at(&lru, (size_t)(p-(int *)lru.data));
+      ++hits;
+    } else if (lru.len == CAPACITY) {
+      present[*(int *)stdvec_at(&lru, 0)] = 0;
+      stdvec_rm_at(&lru, 0);
+    }
+    present[key] = 1;
+    stdvec_push(&lru, &key);
+  }
+
+  free(present);
+  stdvec_free(&lru);
+  return hits;
+}
+
+int
+main(void)
+{
+  int *accesses = make_accesses();
+  size_t hits[3];
+  double start;
+
+  start = bench_now();
+  hits[0] = lru_intrusive(accesses, N_ACCESSES);
+  BENCH_REPORT("lru StdList (intrusive)", N_ACCESSES, bench_now()-start);
+
+  start = bench_now();
+  hits[1] = lru_slab(accesses, N_ACCESSES);
+  BENCH_REPORT("lru StdSlabList", N_ACCESSES, bench_now()-start);
+
+  // The StdVec version is O(capacity) per access,
+  // so only run it on a prefix.
+  start = bench_now();
+  hits[2] = lru_vec(accesses, N_ACCESSES/256);
+  BENCH_REPORT("lru StdVec", N_ACCESSES/256, bench_now()-start);
+
+  if (hits[0] != hits[1] || lru_intrusive(accesses, N_ACCESSES/256) != hits[2]) {
+    fprintf(stderr, "hit counts differ: %zu %zu %zu\n", hits[0], hits[1], hits[2]);
+    return 1;
+  }
+  printf("hit rate: %.1f%%\n", 100.0*(double)hits[0]/N_ACCESSES);
+
+  free(accesses);
+  return 0;
+}
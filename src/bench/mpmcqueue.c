@@ -0,0 +1,65 @@
+#define STDMPMCQUEUE_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Moves N_ITEMS through one StdMpmcQueue with `t` producers
+// and `t` consumers for t = 1..max threads.
+
+#define N_ITEMS (1 << 22)
+
+struct Ctx
+{
+  StdMpmcQueue *q;
+  size_t n;
+};
+
+void *
+producer(void *arg)
+{
+  struct Ctx *ctx = (struct Ctx *)arg;
+  for (size_t i = 0; i < ctx->n; ++i) {
+    stdmpmcqueue_enqueue(ctx->q, &i);
+  }
+  return NULL;
+}
+
+void *
+consumer(void *arg)
+{
+  struct Ctx *ctx = (struct Ctx *)arg;
+  size_t buf[16];
+  size_t got = 0;
+  while (got < ctx->n) {
+    size_t want = ctx->n-got < 16 ? ctx->n-got : 16;
+    got += stdmpmcqueue_dequeue_n(ctx->q, buf, want);
+  }
+  return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+  int max = argc > 1 ? atoi(argv[1]) : bench_ncpus();
+  char name[64];
+
+  for (int t = 1; t <= max; ++t) {
+    StdMpmcQueue q = stdmpmcqueue_new(sizeof(size_t), 4096);
+    pthread_t threads[2*t];
+    struct Ctx ctx = { .q = &q, .n = N_ITEMS/t };
+
+    double start = bench_now();
+    for (int i = 0; i < t; ++i) {
+      pthread_create(&threads[i], NULL, producer, &ctx);
+      pthread_create(&threads[t+i], NULL, consumer, &ctx);
+    }
+    for (int i = 0; i < 2*t; ++i) {
+      pthread_join(threads[i], NULL);
+    }
+    double secs = bench_now()-start;
+
+    snprintf(name, sizeof(name), "mpmcqueue %dP/%dC", t, t);
+    BENCH_REPORT(name, ctx.n*t, secs);
+    stdmpmcqueue_free(&q);
+  }
+  return 0;
+}
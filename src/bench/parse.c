@@ -0,0 +1,86 @@
+#define STDSTR_IMPL
+#define STDVEC_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Parsing a column of numbers the way a CSV reader with
+// no null bytes has to with strtod()/strtoll(): copy each
+// field into a C string first. Against that, the
+// stdstr_parse_* functions on the fields in place, and
+// stdstr_parse_column_* on the whole column.
+
+#define N (1 << 21)
+
+static StdStr
+make_column(int floats)
+{
+  StdStr col = stdstr_new();
+  uint64_t state = 42;
+  char buf[64];
+  for (size_t i = 0; i < N; ++i) {
+    state = state*6364136223846793005ull+1442695040888963407ull;
+    if (floats) {
+      (void)snprintf(buf, sizeof(buf), "%.*g\n", 4+(int)(i%14),
+                     (double)(state >> 11)/(1ull << 40)-4096.0);
+    } else {
+      (void)snprintf(buf, sizeof(buf), "%lld\n", (long long)((int64_t)state >> (i%48)));
+    }
+    stdstr_append(&col, buf);
+  }
+  return col;
+}
+
+static void
+run(const char *what, int floats)
+{
+  StdStr col = make_column(floats);
+  volatile double sink = 0;
+  char name[64];
+  char field[64];
+  double start;
+
+  start = bench_now();
+  for (size_t i = 0; i < col.len;) {
+    size_t n = 0;
+    while (col.data[i+n] != '\n') {
+      n += 1;
+    }
+    (void)memcpy(field, col.data+i, n);
+    field[n] = '\0';
+    sink += floats ? strtod(field, NULL) : (double)strtoll(field, NULL, 10);
+    i += n+1;
+  }
+  (void)snprintf(name, sizeof(name), "%s copy + strto*", what);
+  BENCH_REPORT(name, N, bench_now()-start);
+
+  start = bench_now();
+  for (size_t i = 0; i < col.len;) {
+    double d;
+    int64_t v;
+    StdParseResult r = floats ? stdstr_parse_f64(col.data+i, col.len-i, &d)
+      : stdstr_parse_i64(col.data+i, col.len-i, &v);
+    sink += floats ? d : (double)v;
+    i += r.len+1;
+  }
+  (void)snprintf(name, sizeof(name), "%s stdstr_parse", what);
+  BENCH_REPORT(name, N, bench_now()-start);
+
+  StdVec out = floats ? stdvec_wcap(sizeof(double), N) : stdvec_wcap(sizeof(int64_t), N);
+  start = bench_now();
+  StdParseResult r = floats ? stdstr_parse_column_f64(col.data, col.len, '\n', &out)
+    : stdstr_parse_column_i64(col.data, col.len, '\n', &out);
+  (void)snprintf(name, sizeof(name), "%s stdstr_parse_column", what);
+  BENCH_REPORT(name, N, bench_now()-start);
+  sink += (double)r.err+(double)out.len;
+
+  stdvec_free(&out);
+  stdstr_free(&col);
+}
+
+int
+main(void)
+{
+  run("f64", 1);
+  run("i64", 0);
+  return 0;
+}
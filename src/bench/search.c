@@ -0,0 +1,95 @@
+#define STDSEARCHINDEX_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Random lookups in a sorted array of uint64_t with
+// bsearch, std_lower_bound, std_lower_bound_u64 and a
+// StdSearchIndex, one key at a time and in batches, for
+// an array that fits in L2 and one that is far bigger
+// than the last level cache.
+
+#define QUERIES (1 << 22)
+
+static int
+compare_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y)-(x < y);
+}
+
+static void
+run(size_t n)
+{
+  StdVec vec = stdvec_wcap(sizeof(uint64_t), n);
+  for (uint64_t i = 0; i < n; ++i) {
+    uint64_t x = 2*i;
+    stdvec_push(&vec, &x);
+  }
+  const uint64_t *arr = vec.data;
+  uint64_t *keys = malloc(QUERIES*sizeof(uint64_t));
+  size_t *out = malloc(QUERIES*sizeof(size_t));
+  uint64_t state = 1;
+  for (size_t i = 0; i < QUERIES; ++i) {
+    state = state*6364136223846793005ull+1442695040888963407ull;
+    keys[i] = (state >> 11) % (2*n);
+  }
+  CompareFunction volatile compare = compare_u64;
+  StdSearchIndex idx = stdsearchindex_new(&vec, compare_u64);
+  volatile size_t sink = 0;
+  char name[64];
+  double start;
+
+  start = bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    sink += bsearch(&keys[i], arr, n, sizeof(uint64_t), compare) != NULL;
+  }
+  (void)snprintf(name, sizeof(name), "bsearch n=%zu", n);
+  BENCH_REPORT(name, QUERIES, bench_now()-start);
+
+  start = bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    sink += (const uint64_t *)std_lower_bound(arr, arr+n, sizeof(uint64_t), &keys[i], compare)-arr;
+  }
+  (void)snprintf(name, sizeof(name), "std_lower_bound n=%zu", n);
+  BENCH_REPORT(name, QUERIES, bench_now()-start);
+
+  start = bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    sink += std_lower_bound_u64(arr, n, keys[i]);
+  }
+  (void)snprintf(name, sizeof(name), "std_lower_bound_u64 n=%zu", n);
+  BENCH_REPORT(name, QUERIES, bench_now()-start);
+
+  start = bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    sink += stdsearchindex_lower_bound(&idx, &keys[i]);
+  }
+  (void)snprintf(name, sizeof(name), "index lower_bound n=%zu", n);
+  BENCH_REPORT(name, QUERIES, bench_now()-start);
+
+  start = bench_now();
+  for (size_t i = 0; i < QUERIES; ++i) {
+    sink += stdsearchindex_lower_bound_u64(&idx, keys[i]);
+  }
+  (void)snprintf(name, sizeof(name), "index lower_bound_u64 n=%zu", n);
+  BENCH_REPORT(name, QUERIES, bench_now()-start);
+
+  start = bench_now();
+  stdsearchindex_lower_bound_batch_u64(&idx, keys, QUERIES, out);
+  sink += out[QUERIES-1];
+  (void)snprintf(name, sizeof(name), "index batch_u64 n=%zu", n);
+  BENCH_REPORT(name, QUERIES, bench_now()-start);
+
+  stdsearchindex_free(&idx);
+  stdvec_free(&vec);
+  free(keys);
+  free(out);
+}
+
+int
+main(void)
+{
+  run(1 << 14);
+  run(1 << 25);
+  return 0;
+}
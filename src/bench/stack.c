@@ -0,0 +1,47 @@
+#define STDSTACK_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// A DFS-like push/pop pattern on a contiguous and a
+// segmented stack. Besides throughput, reports the
+// slowest single push, which for the contiguous stack
+// is the realloc() copy of the whole stack.
+
+#define N (1 << 23)
+
+typedef struct { size_t node, depth, parent, edge; } Frame;
+
+static void
+run(const char *name, StdStack *s)
+{
+  Frame f = {0};
+  double worst = 0, start = bench_now();
+  for (size_t round = 0; round < 4; ++round) {
+    for (size_t i = 0; i < N; ++i) {
+      f.node = i;
+      double t = bench_now();
+      stdstack_push(s, &f);
+      t = bench_now()-t;
+      worst = t > worst ? t : worst;
+    }
+    while (stdstack_pop_into(s, &f)) {}
+  }
+  double secs = bench_now()-start;
+  char label[64];
+  snprintf(label, sizeof(label), "%s push+pop", name);
+  BENCH_REPORT(label, (size_t)4*N, secs);
+  printf("%-40s %10.3f ms\n", "  slowest push", worst*1e3);
+}
+
+int
+main(void)
+{
+  StdStack flat = stdstack_new(sizeof(Frame));
+  run("contiguous", &flat);
+  stdstack_free(&flat);
+
+  StdStack seg = stdstack_new_segmented(sizeof(Frame), 0);
+  run("segmented", &seg);
+  stdstack_free(&seg);
+  return 0;
+}
@@ -0,0 +1,55 @@
+#define STDSTR_IMPL
+#define STDVEC_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Sorting a stdvec of StdStr with stdvec_qsort and
+// stdstr_cmp against stdvec_radix_sort_str, for random
+// keys and for keys with a long shared prefix, like
+// paths or URLs.
+
+#define N (1 << 21)
+
+static void
+fill(StdVec *v, const char *prefix)
+{
+  uint64_t state = 1;
+  char buf[96];
+  for (size_t i = 0; i < N; ++i) {
+    state = state*6364136223846793005ull+1442695040888963407ull;
+    (void)snprintf(buf, sizeof(buf), "%s%016llx", prefix, (unsigned long long)state);
+    StdStr str = stdstr_from(buf);
+    stdvec_push(v, &str);
+  }
+}
+
+static void
+run(const char *what, const char *prefix)
+{
+  char name[64];
+  for (int radix = 0; radix < 2; ++radix) {
+    StdVec v = stdvec_new(sizeof(StdStr));
+    fill(&v, prefix);
+    double start = bench_now();
+    if (radix) {
+      stdvec_radix_sort_str(&v);
+    } else {
+      stdvec_qsort(&v, stdstr_cmp);
+    }
+    double secs = bench_now()-start;
+    (void)snprintf(name, sizeof(name), "%s %s", what, radix ? "radix sort" : "qsort");
+    BENCH_REPORT(name, N, secs);
+    for (size_t i = 0; i < v.len; ++i) {
+      stdstr_free(stdvec_at(&v, i));
+    }
+    stdvec_free(&v);
+  }
+}
+
+int
+main(void)
+{
+  run("random keys", "");
+  run("shared prefix", "https://example.com/static/assets/");
+  return 0;
+}
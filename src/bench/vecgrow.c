@@ -0,0 +1,40 @@
+#define _GNU_SOURCE
+#define STDVEC_IMPL
+#include "../cstd.h"
+#include "./bench.h"
+
+// Appends to a 512MiB StdVec and reports the slowest
+// single push, which is the growth step. The default
+// path grows large vectors with mremap(). The aligned
+// allocator has no realloc, so it copies on every
+// growth like a plain malloc/memcpy/free would.
+
+#define N ((size_t)1 << 26)
+
+static void
+run(const char *name, StdVec *v)
+{
+  double worst = 0, start = bench_now();
+  for (size_t i = 0; i < N; ++i) {
+    double t = bench_now();
+    stdvec_push(v, &i);
+    t = bench_now()-t;
+    worst = t > worst ? t : worst;
+  }
+  BENCH_REPORT(name, N, bench_now()-start);
+  printf("%-40s %10.3f ms\n", "  slowest push", worst*1e3);
+}
+
+int
+main(void)
+{
+  StdVec v = stdvec_new(sizeof(size_t));
+  run("push, mremap growth", &v);
+  stdvec_free(&v);
+
+  StdAllocator copy = stdallocator_aligned(64);
+  v = stdvec_new_alloc(sizeof(size_t), &copy);
+  run("push, copying growth", &v);
+  stdvec_free(&v);
+  return 0;
+}
@@ -31,5 +31,13 @@ if [ "$1" == "-r" ]; then
     make run
 else if [ "$1" == "-v" ]; then
     make vrun
+else if [ "$1" == "-t" ]; then
+    make tsan
+else if [ "$1" == "-b" ]; then
+    cd ../bench
+    make clean
+    make run
+fi
+fi
 fi
 fi
@@ -26,13 +26,422 @@
 #include <aio.h>
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define __STD_X86 1
+#include <immintrin.h>
+#endif
 
 // NOTE: all functions/macros starting with two
 // underscores `__` are to be treated as private.
 
+// Some implementations are built on top of others.
+#ifdef STDPARFUNCS_IMPL
+#define STDTHREADPOOL_IMPL
+#define STDFUNCS_IMPL
+#endif
+#ifdef STDTHREADPOOL_IMPL
+#define STDPOOL_IMPL
+#define STDQUEUE_IMPL
+#endif
+#ifdef STDLIST_IMPL
+#define STDPOOL_IMPL
+#endif
+#ifdef STDITER_IMPL
+#define STDVEC_IMPL
+#endif
+#ifdef STDSEARCHINDEX_IMPL
+#define STDVEC_IMPL
+#define STDFUNCS_IMPL
+#endif
+
+//////////////////////////////
+// Instrumentation
+//
+// Building with STD_INSTRUMENT defined counts every
+// allocation made by the containers, per call site and
+// per container type (the call site's function name up
+// to its first `_`, e.g. "stdvec"). The counters are:
+//   allocs, reallocs, frees  number of calls
+//   bytes                    bytes asked for by malloc/realloc
+//   moved                    bytes copied by a realloc that moved
+//   wasted                   capacity allocated past what a growing
+//                            container needed when it grew
+//   live, peak               bytes held now and at most (per type
+//                            and in total, glibc only)
+// Without STD_INSTRUMENT, all of this compiles away and
+// the containers call malloc() and friends directly.
+// std_instrument_dump then does nothing and
+// std_instrument_stats reports zeroes.
+// Example usage:
+//   #define STD_INSTRUMENT
+//   #define STDVEC_IMPL
+//   #include "cstd.h"
+//   ...
+//   std_instrument_dump(stderr, 0);
+
+// A snapshot of the counters of one type, or of all.
+struct StdInstrumentStats
+{
+  uint64_t allocs;
+  uint64_t reallocs;
+  uint64_t frees;
+  uint64_t bytes;
+  uint64_t moved;
+  uint64_t wasted;
+  int64_t live;
+  int64_t peak;
+};
+typedef struct StdInstrumentStats StdInstrumentStats;
+
+#ifdef STD_INSTRUMENT
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#define __STD_INSTR_USABLE(ptr) malloc_usable_size(ptr)
+#else
+#define __STD_INSTR_USABLE(ptr) ((size_t)0)
+#endif // __GLIBC__
+
+#define __STD_INSTR_MAX_TYPES 64
+
+struct __StdInstrCounters
+{
+  _Atomic uint64_t allocs;
+  _Atomic uint64_t reallocs;
+  _Atomic uint64_t frees;
+  _Atomic uint64_t bytes;
+  _Atomic uint64_t moved;
+  _Atomic uint64_t wasted;
+  _Atomic int64_t live;
+  _Atomic int64_t peak;
+};
+
+struct __StdInstrType
+{
+  char name[32];
+  struct __StdInstrCounters counters;
+};
+
+struct __StdInstrSite
+{
+  const char *file;
+  const char *func;
+  int line;
+  _Atomic int registered;
+  struct __StdInstrType *type;
+  struct __StdInstrSite *next;
+  struct __StdInstrCounters counters;
+};
+
+static pthread_mutex_t __std_instr_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct __StdInstrSite *__std_instr_sites = NULL;
+static struct __StdInstrType __std_instr_types[__STD_INSTR_MAX_TYPES];
+static size_t __std_instr_ntypes = 0;
+static struct __StdInstrCounters __std_instr_total;
+
+// Private: the record of the call site it is used at,
+// registered the first time that site runs.
+#define __STD_INSTR_SITE() ({                                           \
+      static struct __StdInstrSite __std_site = {.file = __FILE__, .line = __LINE__}; \
+      if (!atomic_load_explicit(&__std_site.registered, memory_order_acquire)) { \
+        __std_instr_register(&__std_site, __func__);                    \
+      }                                                                 \
+      &__std_site;                                                      \
+    })
+
+#define __STD_MALLOC(bytes) __std_instr_malloc(__STD_INSTR_SITE(), (bytes))
+#define __STD_CALLOC(n, size) __std_instr_calloc(__STD_INSTR_SITE(), (n), (size))
+#define __STD_ALIGNED_ALLOC(align, bytes)                               \
+  __std_instr_aligned_alloc(__STD_INSTR_SITE(), (align), (bytes))
+#define __STD_REALLOC(ptr, bytes) __std_instr_realloc(__STD_INSTR_SITE(), (ptr), (bytes))
+#define __STD_FREE(ptr) __std_instr_free(__STD_INSTR_SITE(), (ptr))
+#define __STD_INSTR_WASTE(bytes) __std_instr_waste(__STD_INSTR_SITE(), (bytes))
+
+static inline void
+__std_instr_register(struct __StdInstrSite *site, const char *func)
+{
+  pthread_mutex_lock(&__std_instr_lock);
+  if (!atomic_load_explicit(&site->registered, memory_order_relaxed)) {
+    char name[32] = {0};
+    const char *f = func;
+    while (*f == '_') {
+      ++f;
+    }
+    for (size_t i = 0; i < sizeof(name)-1 && f[i] && f[i] != '_'; ++i) {
+      name[i] = f[i];
+    }
+    struct __StdInstrType *type = NULL;
+    for (size_t i = 0; i < __std_instr_ntypes && !type; ++i) {
+      if (strcmp(__std_instr_types[i].name, name) == 0) {
+        type = &__std_instr_types[i];
+      }
+    }
+    if (!type && __std_instr_ntypes < __STD_INSTR_MAX_TYPES) {
+      type = &__std_instr_types[__std_instr_ntypes++];
+      (void)memcpy(type->name, name, sizeof(name));
+    }
+    if (!type) {
+      type = &__std_instr_types[__STD_INSTR_MAX_TYPES-1];
+    }
+    site->func = func;
+    site->type = type;
+    site->next = __std_instr_sites;
+    __std_instr_sites = site;
+    atomic_store_explicit(&site->registered, 1, memory_order_release);
+  }
+  pthread_mutex_unlock(&__std_instr_lock);
+}
+
+// Private: adds `delta` live bytes to `c`, keeping its peak.
+static inline void
+__std_instr_live(struct __StdInstrCounters *c, int64_t delta)
+{
+  int64_t live = atomic_fetch_add_explicit(&c->live, delta, memory_order_relaxed)+delta;
+  int64_t peak = atomic_load_explicit(&c->peak, memory_order_relaxed);
+  while (live > peak
+         && !atomic_compare_exchange_weak_explicit(&c->peak, &peak, live,
+                                                   memory_order_relaxed,
+                                                   memory_order_relaxed)) {}
+}
+
+// Private: records one event on the site, its type and the total.
+static inline void
+__std_instr_count(struct __StdInstrSite *site, _Atomic uint64_t *(*field)(struct __StdInstrCounters *),
+                  uint64_t n)
+{
+  atomic_fetch_add_explicit(field(&site->counters), n, memory_order_relaxed);
+  atomic_fetch_add_explicit(field(&site->type->counters), n, memory_order_relaxed);
+  atomic_fetch_add_explicit(field(&__std_instr_total), n, memory_order_relaxed);
+}
+
+#define __STD_INSTR_FIELD(f)                                            \
+  static inline _Atomic uint64_t *                                      \
+  __std_instr_##f(struct __StdInstrCounters *c)                         \
+  {                                                                     \
+    return &c->f;                                                       \
+  }
+__STD_INSTR_FIELD(allocs)
+__STD_INSTR_FIELD(reallocs)
+__STD_INSTR_FIELD(frees)
+__STD_INSTR_FIELD(bytes)
+__STD_INSTR_FIELD(moved)
+__STD_INSTR_FIELD(wasted)
+
+// Private: accounts for `ptr` gaining `delta` usable bytes.
+static inline void
+__std_instr_grow(struct __StdInstrSite *site, int64_t delta)
+{
+  __std_instr_live(&site->type->counters, delta);
+  __std_instr_live(&__std_instr_total, delta);
+}
+
+static inline void *
+__std_instr_malloc(struct __StdInstrSite *site, size_t bytes)
+{
+  void *ptr = malloc(bytes);
+  if (ptr) {
+    __std_instr_count(site, __std_instr_allocs, 1);
+    __std_instr_count(site, __std_instr_bytes, bytes);
+    __std_instr_grow(site, (int64_t)__STD_INSTR_USABLE(ptr));
+  }
+  return ptr;
+}
+
+static inline void *
+__std_instr_calloc(struct __StdInstrSite *site, size_t n, size_t size)
+{
+  void *ptr = calloc(n, size);
+  if (ptr) {
+    __std_instr_count(site, __std_instr_allocs, 1);
+    __std_instr_count(site, __std_instr_bytes, n*size);
+    __std_instr_grow(site, (int64_t)__STD_INSTR_USABLE(ptr));
+  }
+  return ptr;
+}
+
+static inline void *
+__std_instr_aligned_alloc(struct __StdInstrSite *site, size_t align, size_t bytes)
+{
+  void *ptr = aligned_alloc(align, bytes);
+  if (ptr) {
+    __std_instr_count(site, __std_instr_allocs, 1);
+    __std_instr_count(site, __std_instr_bytes, bytes);
+    __std_instr_grow(site, (int64_t)__STD_INSTR_USABLE(ptr));
+  }
+  return ptr;
+}
+
+static inline void *
+__std_instr_realloc(struct __StdInstrSite *site, void *old, size_t bytes)
+{
+  size_t oldsize = old ? __STD_INSTR_USABLE(old) : 0;
+  void *ptr = realloc(old, bytes);
+  if (ptr) {
+    __std_instr_count(site, old ? __std_instr_reallocs : __std_instr_allocs, 1);
+    __std_instr_count(site, __std_instr_bytes, bytes);
+    if (old && ptr != old) {
+      __std_instr_count(site, __std_instr_moved, oldsize < bytes ? oldsize : bytes);
+    }
+    __std_instr_grow(site, (int64_t)__STD_INSTR_USABLE(ptr)-(int64_t)oldsize);
+  }
+  return ptr;
+}
+
+static inline void
+__std_instr_free(struct __StdInstrSite *site, void *ptr)
+{
+  if (ptr) {
+    __std_instr_count(site, __std_instr_frees, 1);
+    __std_instr_grow(site, -(int64_t)__STD_INSTR_USABLE(ptr));
+  }
+  free(ptr);
+}
+
+static inline void
+__std_instr_waste(struct __StdInstrSite *site, size_t bytes)
+{
+  __std_instr_count(site, __std_instr_wasted, bytes);
+}
+
+// Private: copies the counters in `c` into `out`.
+static inline void
+__std_instr_snapshot(struct __StdInstrCounters *c, StdInstrumentStats *out)
+{
+  out->allocs   = atomic_load_explicit(&c->allocs, memory_order_relaxed);
+  out->reallocs = atomic_load_explicit(&c->reallocs, memory_order_relaxed);
+  out->frees    = atomic_load_explicit(&c->frees, memory_order_relaxed);
+  out->bytes    = atomic_load_explicit(&c->bytes, memory_order_relaxed);
+  out->moved    = atomic_load_explicit(&c->moved, memory_order_relaxed);
+  out->wasted   = atomic_load_explicit(&c->wasted, memory_order_relaxed);
+  out->live     = atomic_load_explicit(&c->live, memory_order_relaxed);
+  out->peak     = atomic_load_explicit(&c->peak, memory_order_relaxed);
+}
+
+// Fill `out` with the counters of container type `type`,
+// or of everything if `type` is NULL. Returns 0 if
+// nothing of that type allocated yet, 1 otherwise.
+static inline int
+std_instrument_stats(const char *type, StdInstrumentStats *out)
+{
+  if (!type) {
+    __std_instr_snapshot(&__std_instr_total, out);
+    return 1;
+  }
+  int found = 0;
+  pthread_mutex_lock(&__std_instr_lock);
+  for (size_t i = 0; i < __std_instr_ntypes; ++i) {
+    if (strcmp(__std_instr_types[i].name, type) == 0) {
+      __std_instr_snapshot(&__std_instr_types[i].counters, out);
+      found = 1;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&__std_instr_lock);
+  if (!found) {
+    (void)memset(out, 0, sizeof(*out));
+  }
+  return found;
+}
+
+// Private: prints `c` as JSON fields or a text row.
+static inline void
+__std_instr_print(FILE *out, struct __StdInstrCounters *c, int json)
+{
+  StdInstrumentStats st;
+  __std_instr_snapshot(c, &st);
+  fprintf(out, json
+          ? "\"allocs\":%llu,\"reallocs\":%llu,\"frees\":%llu,\"bytes\":%llu,"
+            "\"moved\":%llu,\"wasted\":%llu,\"live\":%lld,\"peak\":%lld"
+          : "%10llu %10llu %10llu %14llu %14llu %14llu %12lld %12lld",
+          (unsigned long long)st.allocs, (unsigned long long)st.reallocs,
+          (unsigned long long)st.frees, (unsigned long long)st.bytes,
+          (unsigned long long)st.moved, (unsigned long long)st.wasted,
+          (long long)st.live, (long long)st.peak);
+}
+
+// Print every counter to `out`, as a table or, if
+// `json` is set, as one JSON object with "total",
+// "types" and "sites". Per site live/peak are left
+// out, since memory is often freed elsewhere than it
+// was allocated.
+static inline void
+std_instrument_dump(FILE *out, int json)
+{
+  pthread_mutex_lock(&__std_instr_lock);
+  if (json) {
+    fprintf(out, "{\"total\":{");
+    __std_instr_print(out, &__std_instr_total, 1);
+    fprintf(out, "},\"types\":[");
+    for (size_t i = 0; i < __std_instr_ntypes; ++i) {
+      fprintf(out, "%s{\"type\":\"%s\",", i ? "," : "", __std_instr_types[i].name);
+      __std_instr_print(out, &__std_instr_types[i].counters, 1);
+      fprintf(out, "}");
+    }
+    fprintf(out, "],\"sites\":[");
+    for (struct __StdInstrSite *s = __std_instr_sites; s; s = s->next) {
+      fprintf(out, "%s{\"file\":\"%s\",\"line\":%d,\"func\":\"%s\",",
+              s == __std_instr_sites ? "" : ",", s->file, s->line, s->func);
+      __std_instr_print(out, &s->counters, 1);
+      fprintf(out, "}");
+    }
+    fprintf(out, "]}\n");
+  } else {
+    fprintf(out, "%-32s %10s %10s %10s %14s %14s %14s %12s %12s\n", "type/site",
+            "allocs", "reallocs", "frees", "bytes", "moved", "wasted", "live", "peak");
+    fprintf(out, "%-32s ", "total");
+    __std_instr_print(out, &__std_instr_total, 0);
+    fprintf(out, "\n");
+    for (size_t i = 0; i < __std_instr_ntypes; ++i) {
+      fprintf(out, "%-32s ", __std_instr_types[i].name);
+      __std_instr_print(out, &__std_instr_types[i].counters, 0);
+      fprintf(out, "\n");
+      for (struct __StdInstrSite *s = __std_instr_sites; s; s = s->next) {
+        if (s->type == &__std_instr_types[i]) {
+          fprintf(out, "  %-30s ", s->func);
+          __std_instr_print(out, &s->counters, 0);
+          fprintf(out, "  %s:%d\n", s->file, s->line);
+        }
+      }
+    }
+  }
+  pthread_mutex_unlock(&__std_instr_lock);
+}
+
+#else
+
+#define __STD_MALLOC(bytes) malloc(bytes)
+#define __STD_CALLOC(n, size) calloc((n), (size))
+#define __STD_ALIGNED_ALLOC(align, bytes) aligned_alloc((align), (bytes))
+#define __STD_REALLOC(ptr, bytes) realloc((ptr), (bytes))
+#define __STD_FREE(ptr) free(ptr)
+#define __STD_INSTR_WASTE(bytes) ((void)0)
+#define std_instrument_dump(out, json) ((void)0)
+
+// Nothing is counted, so `out` is zeroed and this
+// always returns 0.
+static inline int
+std_instrument_stats(const char *type, StdInstrumentStats *out)
+{
+  (void)type;
+  (void)memset(out, 0, sizeof(*out));
+  return 0;
+}
+
+#endif // STD_INSTRUMENT
+
 // A variadic panic out and exit with a message.
 // Example usage:
 //   int num;
@@ -64,7 +473,9 @@
   do {                                                                  \
     if ((da)->dalen >= (da)->dacap) {                                   \
       (da)->dacap *= 2;                                                 \
-      (da)->dadata = realloc((da)->dadata, (da)->dacap*(da)->dastride); \
+      (da)->dadata = __STD_REALLOC((da)->dadata, (da)->dacap*(da)->dastride); \
+      __STD_CHECK_MEM((da)->dadata);                                    \
+      __STD_INSTR_WASTE(((da)->dacap-(da)->dalen-1)*(da)->dastride);   \
     }                                                                   \
     (void)memcpy((da)->dadata+(da)->dalen*(da)->dastride, (value), (da)->dastride); \
     (da)->dalen += 1;                                                   \
@@ -83,7 +494,7 @@
 // Example usage:
 //   int *ptr = __STD_S_MALLOC(sizeof(int));
 #define __STD_S_MALLOC(bytes) ({                        \
-      void *p = malloc(bytes);                          \
+      void *p = __STD_MALLOC(bytes);                          \
       if (!p) {                                         \
         fprintf(stderr, "Memory allocation failed.\n"); \
         exit(EXIT_FAILURE);                             \
@@ -91,9 +502,527 @@
       p;                                                \
     })
 
+// An allocator the containers can be created with in
+// place of malloc(). `realloc` and `free` are given the
+// current size of the block, so an allocator does not
+// need to keep it. A container keeps a pointer to its
+// allocator, so it must outlive the container. A NULL
+// allocator means malloc().
+struct StdAllocator
+{
+  void *(*alloc)(void *ctx, size_t bytes);
+  void *(*realloc)(void *ctx, void *ptr, size_t old, size_t bytes);
+  void (*free)(void *ctx, void *ptr, size_t bytes);
+  void *ctx;
+};
+typedef struct StdAllocator StdAllocator;
+
+// Blocks of at least this many bytes made by containers
+// without an allocator get their own mmap() region and
+// grow with mremap(), which moves the pages instead of
+// copying them. Define it before including cstd.h to
+// change it. mremap() needs _GNU_SOURCE; without it,
+// large blocks grow by mapping a new region and copying.
+#ifndef STD_MREMAP_THRESHOLD
+#define STD_MREMAP_THRESHOLD ((size_t)16*1024*1024)
+#endif
+
+// Private: a large block in its own mapping.
+static inline void *
+__std_map_alloc(size_t bytes)
+{
+  void *mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return mem == MAP_FAILED ? NULL : mem;
+}
+
+static inline void
+__std_map_free(void *ptr, size_t bytes)
+{
+  if (ptr) {
+    (void)munmap(ptr, bytes);
+  }
+}
+
+// Private: resizes a block from `old` to `bytes`,
+// either of which is at least STD_MREMAP_THRESHOLD.
+static inline void *
+__std_map_realloc(void *ptr, size_t old, size_t bytes)
+{
+  if (!ptr) {
+    return bytes >= STD_MREMAP_THRESHOLD ? __std_map_alloc(bytes) : __STD_MALLOC(bytes);
+  }
+#ifdef MREMAP_MAYMOVE
+  if (old >= STD_MREMAP_THRESHOLD && bytes >= STD_MREMAP_THRESHOLD) {
+    void *mem = mremap(ptr, old, bytes, MREMAP_MAYMOVE);
+    return mem == MAP_FAILED ? NULL : mem;
+  }
+#endif
+  void *mem = bytes >= STD_MREMAP_THRESHOLD ? __std_map_alloc(bytes) : __STD_MALLOC(bytes);
+  if (mem) {
+    (void)memcpy(mem, ptr, old < bytes ? old : bytes);
+    if (old >= STD_MREMAP_THRESHOLD) {
+      __std_map_free(ptr, old);
+    } else {
+      __STD_FREE(ptr);
+    }
+  }
+  return mem;
+}
+
+// Private: __STD_S_MALLOC, realloc() and free() through
+// the allocator `a`. With no allocator, blocks from
+// STD_MREMAP_THRESHOLD up are mapped, see above.
+#define __STD_A_ALLOC(a, bytes) ({                                      \
+      const StdAllocator *__a = (a);                                    \
+      size_t __bytes = (bytes);                                         \
+      void *__ptr = __a ? __a->alloc(__a->ctx, __bytes)                 \
+        : __bytes >= STD_MREMAP_THRESHOLD ? __std_map_alloc(__bytes)    \
+        : __STD_MALLOC(__bytes);                                        \
+      if (!__ptr) {                                                     \
+        fprintf(stderr, "Memory allocation failed.\n");                 \
+        exit(EXIT_FAILURE);                                             \
+      }                                                                 \
+      __ptr;                                                            \
+    })
+#define __STD_A_REALLOC(a, ptr, old, bytes)                             \
+  ((a) ? (a)->realloc((a)->ctx, (ptr), (old), (bytes))                  \
+   : (old) >= STD_MREMAP_THRESHOLD || (bytes) >= STD_MREMAP_THRESHOLD   \
+   ? __std_map_realloc((ptr), (old), (bytes))                           \
+   : __STD_REALLOC((ptr), (bytes)))
+#define __STD_A_FREE(a, ptr, bytes)                                     \
+  ((a) ? (a)->free((a)->ctx, (ptr), (bytes))                            \
+   : (bytes) >= STD_MREMAP_THRESHOLD ? __std_map_free((ptr), (bytes))   \
+   : __STD_FREE(ptr))
+
+// Same as __STD_DA_APPEND, for dynamic arrays
+// that also have an allocator field `daalloc`.
+#define __STD_DA_APPEND_A(da, dadata, dastride, dalen, dacap, daalloc, value) \
+  do {                                                                  \
+    if ((da)->dalen >= (da)->dacap) {                                   \
+      (da)->dadata = __STD_A_REALLOC((da)->daalloc, (da)->dadata,       \
+                                     (da)->dacap*(da)->dastride,        \
+                                     2*(da)->dacap*(da)->dastride);     \
+      __STD_CHECK_MEM((da)->dadata);                                    \
+      (da)->dacap *= 2;                                                 \
+      __STD_INSTR_WASTE(((da)->dacap-(da)->dalen-1)*(da)->dastride);   \
+    }                                                                   \
+    (void)memcpy((da)->dadata+(da)->dalen*(da)->dastride, (value), (da)->dastride); \
+    (da)->dalen += 1;                                                   \
+  } while (0)
+
+// Private: the aligned allocator. `ctx` is the alignment.
+static inline void *
+__std_aligned_alloc(void *ctx, size_t bytes)
+{
+  size_t align = (size_t)(uintptr_t)ctx;
+  return __STD_ALIGNED_ALLOC(align, (bytes+align-1)/align*align);
+}
+
+static inline void *
+__std_aligned_realloc(void *ctx, void *ptr, size_t old, size_t bytes)
+{
+  void *mem = __std_aligned_alloc(ctx, bytes);
+  if (mem && ptr) {
+    (void)memcpy(mem, ptr, old < bytes ? old : bytes);
+    __STD_FREE(ptr);
+  }
+  return mem;
+}
+
+static inline void
+__std_aligned_free(void *ctx, void *ptr, size_t bytes)
+{
+  (void)ctx;
+  (void)bytes;
+  __STD_FREE(ptr);
+}
+
+// Returns an allocator whose blocks start at a multiple
+// of `align`, a power of two, e.g. 64 for cache lines
+// or SIMD loads.
+// Example usage:
+//   StdAllocator a = stdallocator_aligned(64);
+//   StdVec v = stdvec_new_alloc(sizeof(float), &a);
+static inline StdAllocator
+stdallocator_aligned(size_t align)
+{
+  if (align < sizeof(void *) || (align & (align-1)) != 0) {
+    __STD_PANIC("alignment %zu is not a power of two >= %zu", align, sizeof(void *));
+  }
+  return (StdAllocator) {
+    .alloc   = __std_aligned_alloc,
+    .realloc = __std_aligned_realloc,
+    .free    = __std_aligned_free,
+    .ctx     = (void *)(uintptr_t)align,
+  };
+}
+
+// Size and alignment of a transparent huge page.
+#define __STD_HUGEPAGE ((size_t)2*1024*1024)
+
+// Private: `bytes` rounded up to whole huge pages.
+static inline size_t
+__std_huge_len(size_t bytes)
+{
+  return (bytes+__STD_HUGEPAGE-1)/__STD_HUGEPAGE*__STD_HUGEPAGE;
+}
+
+// Private: maps `len` bytes aligned to a huge page and
+// asks the kernel to back them with huge pages. Maps
+// one huge page more than needed, then unmaps the
+// unaligned head and the tail.
+static inline void *
+__std_huge_map(size_t len)
+{
+  char *raw = mmap(NULL, len+__STD_HUGEPAGE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (raw == MAP_FAILED) {
+    return NULL;
+  }
+  char *mem = (char *)(((uintptr_t)raw+__STD_HUGEPAGE-1) & ~(uintptr_t)(__STD_HUGEPAGE-1));
+  if (mem > raw) {
+    (void)munmap(raw, mem-raw);
+  }
+  if (mem+len < raw+len+__STD_HUGEPAGE) {
+    (void)munmap(mem+len, raw+len+__STD_HUGEPAGE-(mem+len));
+  }
+#ifdef MADV_HUGEPAGE
+  (void)madvise(mem, len, MADV_HUGEPAGE);
+#endif
+  return mem;
+}
+
+// Private: the huge page allocator. `ctx` is the size
+// from which blocks are mapped instead of malloc()ed.
+static inline void *
+__std_hugepage_alloc(void *ctx, size_t bytes)
+{
+  if (bytes < (size_t)(uintptr_t)ctx) {
+    return __STD_MALLOC(bytes);
+  }
+  return __std_huge_map(__std_huge_len(bytes));
+}
+
+static inline void
+__std_hugepage_free(void *ctx, void *ptr, size_t bytes)
+{
+  if (bytes < (size_t)(uintptr_t)ctx) {
+    __STD_FREE(ptr);
+  } else if (ptr) {
+    (void)munmap(ptr, __std_huge_len(bytes));
+  }
+}
+
+static inline void *
+__std_hugepage_realloc(void *ctx, void *ptr, size_t old, size_t bytes)
+{
+  size_t threshold = (size_t)(uintptr_t)ctx;
+  if (!ptr) {
+    return __std_hugepage_alloc(ctx, bytes);
+  }
+  if (old < threshold && bytes < threshold) {
+    return __STD_REALLOC(ptr, bytes);
+  }
+  if (old >= threshold && bytes >= threshold
+      && __std_huge_len(old) == __std_huge_len(bytes)) {
+    return ptr;
+  }
+  void *mem = __std_hugepage_alloc(ctx, bytes);
+  if (mem) {
+    (void)memcpy(mem, ptr, old < bytes ? old : bytes);
+    __std_hugepage_free(ctx, ptr, old);
+  }
+  return mem;
+}
+
+// Returns an allocator that maps blocks of `threshold`
+// bytes or more with mmap(), aligned to 2MiB and marked
+// with madvise(MADV_HUGEPAGE), so large containers are
+// backed by transparent huge pages and take fewer TLB
+// misses. Smaller blocks use malloc(). A `threshold`
+// of 0 means 2MiB.
+// Example usage:
+//   StdAllocator a = stdallocator_hugepage(0);
+//   StdVec v = stdvec_wcap_alloc(sizeof(double), 1 << 28, &a);
+static inline StdAllocator
+stdallocator_hugepage(size_t threshold)
+{
+  return (StdAllocator) {
+    .alloc   = __std_hugepage_alloc,
+    .realloc = __std_hugepage_realloc,
+    .free    = __std_hugepage_free,
+    .ctx     = (void *)(uintptr_t)(threshold ? threshold : __STD_HUGEPAGE),
+  };
+}
+
 // Compound Literal.
 #define STDCL(type, x) ((void*)&(type){(x)})
 
+// Get a pointer to the struct of type `type` that
+// contains `ptr` as its member `member`.
+// Example usage:
+//   struct Foo { int x; StdListNode node; };
+//   struct Foo *foo = STD_CONTAINER_OF(nodeptr, struct Foo, node);
+#define STD_CONTAINER_OF(ptr, type, member)             \
+  ((type *)((char *)(ptr)-offsetof(type, member)))
+
+// Size of a cache line. Used to keep data that is
+// written by different threads from false sharing.
+#define __STD_CACHE_LINE 64
+
+// Hint to the CPU that we are in a spin-wait loop.
+#if defined(__x86_64__) || defined(__i386__)
+#define __STD_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define __STD_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define __STD_CPU_RELAX() do {} while (0)
+#endif
+
+// Private 64-bit hash of `len` bytes at `data`. Reads
+// 8 bytes at a time and finishes with the splitmix64
+// mixer so every input bit affects every output bit.
+static inline uint64_t
+__std_hash_bytes(const void *data, size_t len, uint64_t seed)
+{
+  const unsigned char *p = (const unsigned char *)data;
+  uint64_t h = seed^(len*0x9e3779b97f4a7c15ull);
+  uint64_t w;
+  while (len >= 8) {
+    (void)memcpy(&w, p, 8);
+    h ^= w*0xff51afd7ed558ccdull;
+    h = ((h << 31) | (h >> 33))*0xc4ceb9fe1a85ec53ull;
+    p += 8;
+    len -= 8;
+  }
+  if (len > 0) {
+    w = 0;
+    (void)memcpy(&w, p, len);
+    h ^= w*0xff51afd7ed558ccdull;
+    h = ((h << 31) | (h >> 33))*0xc4ceb9fe1a85ec53ull;
+  }
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ull;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebull;
+  h ^= h >> 31;
+  return h;
+}
+
+// Private backoff for spin-waits. Spins for a while
+// and then starts yielding the CPU to other threads.
+// `spins` should start at 0 for every new wait.
+static inline void
+__std_backoff(unsigned *spins)
+{
+  if (*spins < 64) {
+    __STD_CPU_RELAX();
+    *spins += 1;
+  } else {
+    sched_yield();
+  }
+}
+
+// Private: calls M(ctx, i, x) for every x in the
+// variadic list, i being its index. Up to 8 items.
+#define __STD_CAT(a, b) __STD_CAT_(a, b)
+#define __STD_CAT_(a, b) a##b
+#define __STD_NARGS(...) __STD_NARGS_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __STD_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define __STD_FOREACH(M, ctx, ...)                                      \
+  __STD_CAT(__STD_FOREACH_, __STD_NARGS(__VA_ARGS__))(M, ctx, __VA_ARGS__)
+#define __STD_FOREACH_1(M, c, a) M(c, 0, a)
+#define __STD_FOREACH_2(M, c, a, b) __STD_FOREACH_1(M, c, a) M(c, 1, b)
+#define __STD_FOREACH_3(M, c, a, b, d) __STD_FOREACH_2(M, c, a, b) M(c, 2, d)
+#define __STD_FOREACH_4(M, c, a, b, d, e) __STD_FOREACH_3(M, c, a, b, d) M(c, 3, e)
+#define __STD_FOREACH_5(M, c, a, b, d, e, f)    \
+  __STD_FOREACH_4(M, c, a, b, d, e) M(c, 4, f)
+#define __STD_FOREACH_6(M, c, a, b, d, e, f, g)         \
+  __STD_FOREACH_5(M, c, a, b, d, e, f) M(c, 5, g)
+#define __STD_FOREACH_7(M, c, a, b, d, e, f, g, h)      \
+  __STD_FOREACH_6(M, c, a, b, d, e, f, g) M(c, 6, h)
+#define __STD_FOREACH_8(M, c, a, b, d, e, f, g, h, k)   \
+  __STD_FOREACH_7(M, c, a, b, d, e, f, g, h) M(c, 7, k)
+
+//////////////////////////////
+// Snapshots
+//
+// stdvec_save() and stdstr_save() write a container to a
+// file as a 64-byte header followed by the raw elements,
+// so loading it back is a single read with no parsing.
+// The header has a magic number, a format version, the
+// kind of container, the element size and count, and a
+// checksum of the elements. It also records the byte
+// order, as the elements are stored as they are in
+// memory. Being a cache line, the header keeps the
+// elements of a mapped snapshot 64-byte aligned.
+// Snapshots are written to `<path>.tmp` and renamed, so
+// a crash never leaves a torn file at `path`.
+
+#define __STD_SNAP_MAGIC "CSTDSNAP"
+#define __STD_SNAP_VERSION 1
+#define __STD_SNAP_BYTE_ORDER 0x0102030405060708ull
+
+enum __StdSnapKind
+{
+  __STD_SNAP_VEC = 1,
+  __STD_SNAP_STR = 2,
+};
+
+struct __StdSnapHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t kind;
+  uint64_t byte_order;
+  uint64_t stride;
+  uint64_t len;
+  uint64_t checksum;
+  uint64_t reserved[2];
+};
+
+_Static_assert(sizeof(struct __StdSnapHeader) == __STD_CACHE_LINE,
+               "snapshot header must be one cache line");
+
+// Private: checksum of the elements of a snapshot.
+static inline uint64_t
+__std_snap_checksum(const void *data, size_t bytes)
+{
+  return __std_hash_bytes(data, bytes, __STD_SNAP_BYTE_ORDER);
+}
+
+// Private: writes a snapshot of `len` elements of
+// `stride` bytes. Returns 1 on success, or 0 with
+// errno set.
+static inline int
+__std_snap_save(const char *path, uint32_t kind, size_t stride, size_t len, const void *data)
+{
+  struct __StdSnapHeader header = {
+    .version = __STD_SNAP_VERSION,
+    .kind = kind,
+    .byte_order = __STD_SNAP_BYTE_ORDER,
+    .stride = stride,
+    .len = len,
+    .checksum = __std_snap_checksum(data, stride*len),
+  };
+  (void)memcpy(header.magic, __STD_SNAP_MAGIC, sizeof(header.magic));
+
+  size_t pathlen = strlen(path);
+  char *tmp = __STD_S_MALLOC(pathlen+5);
+  (void)memcpy(tmp, path, pathlen);
+  (void)memcpy(tmp+pathlen, ".tmp", 5);
+
+  int ok = 0;
+  FILE *fp = fopen(tmp, "wb");
+  if (fp) {
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1
+      && fwrite(data, 1, stride*len, fp) == stride*len
+      && fflush(fp) == 0
+      && fsync(fileno(fp)) == 0;
+    ok = fclose(fp) == 0 && ok;
+    ok = ok && rename(tmp, path) == 0;
+    if (!ok) {
+      int err = errno;
+      (void)remove(tmp);
+      errno = err;
+    }
+  }
+  __STD_FREE(tmp);
+  return ok;
+}
+
+// Private: maps the snapshot at `path` read-only and
+// checks its header against `kind` and the file size,
+// and its checksum if `verify` is set. Returns the
+// mapping, which is `*size` bytes, or NULL with errno
+// set (EINVAL for a file that is not a valid snapshot).
+static inline const struct __StdSnapHeader *
+__std_snap_map(const char *path, uint32_t kind, int verify, size_t *size)
+{
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    (void)close(fd);
+    errno = err;
+    return NULL;
+  }
+  if ((size_t)st.st_size < sizeof(struct __StdSnapHeader)) {
+    (void)close(fd);
+    errno = EINVAL;
+    return NULL;
+  }
+  *size = (size_t)st.st_size;
+  void *mem = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int err = errno;
+  (void)close(fd);
+  if (mem == MAP_FAILED) {
+    errno = err;
+    return NULL;
+  }
+
+  const struct __StdSnapHeader *header = mem;
+  size_t bytes = *size-sizeof(*header);
+  int ok = memcmp(header->magic, __STD_SNAP_MAGIC, sizeof(header->magic)) == 0
+    && header->version == __STD_SNAP_VERSION
+    && header->kind == kind
+    && header->byte_order == __STD_SNAP_BYTE_ORDER
+    && header->stride > 0
+    && header->len <= bytes/header->stride
+    && header->len*header->stride == bytes;
+  if (ok && verify) {
+    ok = __std_snap_checksum(header+1, bytes) == header->checksum;
+  }
+  if (!ok) {
+    (void)munmap(mem, *size);
+    errno = EINVAL;
+    return NULL;
+  }
+  return header;
+}
+
+// Private: the allocator of a mapped snapshot. It
+// cannot grow, and freeing it unmaps the file.
+static inline void *
+__std_snap_alloc(void *ctx, size_t bytes)
+{
+  (void)ctx;
+  (void)bytes;
+  __STD_PANIC("a mapped snapshot is read-only");
+}
+
+static inline void *
+__std_snap_realloc(void *ctx, void *ptr, size_t old, size_t bytes)
+{
+  (void)ptr;
+  (void)old;
+  return __std_snap_alloc(ctx, bytes);
+}
+
+static inline void
+__std_snap_free(void *ctx, void *ptr, size_t bytes)
+{
+  (void)ctx;
+  if (ptr) {
+    (void)munmap((char *)ptr-sizeof(struct __StdSnapHeader),
+                 sizeof(struct __StdSnapHeader)+bytes);
+  }
+}
+
+static inline const StdAllocator *
+__std_snap_allocator(void)
+{
+  static const StdAllocator alloc = {
+    .alloc   = __std_snap_alloc,
+    .realloc = __std_snap_realloc,
+    .free    = __std_snap_free,
+  };
+  return &alloc;
+}
+
 //////////////////////////////
 // StdVec IMPLEMENTATION
 #ifdef STDVEC_IMPL
@@ -104,6 +1033,7 @@ struct StdVec
   size_t stride;
   size_t len;
   size_t cap;
+  const StdAllocator *alloc;  // NULL for malloc()
 };
 typedef struct StdVec StdVec;
 
@@ -112,7 +1042,7 @@ typedef struct StdVec StdVec;
 StdVec
 stdvec_new(size_t stride)
 {
-  void *data = __STD_S_MALLOC(stride);
+  void *data = __STD_A_ALLOC(NULL, stride);
   if (!data) {
     __STD_PANIC("could not allocate %zu bytes", stride);
   }
@@ -129,7 +1059,7 @@ StdVec
 stdvec_wcap(size_t stride, size_t cap)
 {
   size_t bytes = stride*cap;
-  void *data = __STD_S_MALLOC(bytes);
+  void *data = __STD_A_ALLOC(NULL, bytes);
   return (StdVec) {
     .data = data,
     .cap = cap,
@@ -138,12 +1068,35 @@ stdvec_wcap(size_t stride, size_t cap)
   };
 }
 
+// Same as stdvec_wcap, allocating
+// through `alloc` instead of malloc().
+StdVec
+stdvec_wcap_alloc(size_t stride, size_t cap, const StdAllocator *alloc)
+{
+  cap = cap ? cap : 1;
+  return (StdVec) {
+    .data = __STD_A_ALLOC(alloc, stride*cap),
+    .cap = cap,
+    .len = 0,
+    .stride = stride,
+    .alloc = alloc,
+  };
+}
+
+// Same as stdvec_new, allocating
+// through `alloc` instead of malloc().
+StdVec
+stdvec_new_alloc(size_t stride, const StdAllocator *alloc)
+{
+  return stdvec_wcap_alloc(stride, 1, alloc);
+}
+
 // Push a value into the end of the stdvec.
 void
 stdvec_push(StdVec *stdvec, void *value)
 {
   __STD_CHECK_MEM(stdvec->data);
-  __STD_DA_APPEND(stdvec, data, stride, len, cap, value);
+  __STD_DA_APPEND_A(stdvec, data, stride, len, cap, alloc, value);
 }
 
 // Return the value at a specific index.
@@ -202,7 +1155,7 @@ void
 stdvec_free(StdVec *stdvec)
 {
   __STD_CHECK_MEM(stdvec->data);
-  free(stdvec->data);
+  __STD_A_FREE(stdvec->alloc, stdvec->data, stdvec->cap*stdvec->stride);
   stdvec->data = NULL;
   stdvec->len = stdvec->cap = stdvec->stride = 0;
 }
@@ -212,7 +1165,7 @@ stdvec_free(StdVec *stdvec)
 StdVec
 stdvec_map(StdVec *stdvec, void (*mapfunc)(void *))
 {
-  StdVec mapped = stdvec_new(stdvec->stride);
+  StdVec mapped = stdvec_new_alloc(stdvec->stride, stdvec->alloc);
   for (size_t i = 0; i < stdvec->len; i++) {
     mapfunc(stdvec_at(stdvec, i));
     stdvec_push(&mapped, stdvec_at(stdvec, i));
@@ -243,20 +1196,86 @@ stdvec_rev(StdVec *stdvec)
     end -= 1;
   }
 }
-#endif // STDVEC_IMPL
-
-//////////////////////////////
-// StdVec IMPLEMENTATION
-#ifdef STDSTR_IMPL
-
-// This implementation of a string
-// does not use a null byte. It entirely
-// depends on `len` and `cap`.
-struct StdStr
+// Writes the elements of the stdvec to `path` in the
+// snapshot format (see Snapshots). Returns 1 on success,
+// or 0 with errno set.
+int
+stdvec_save(const StdVec *stdvec, const char *path)
+{
+  __STD_CHECK_MEM(stdvec->data);
+  return __std_snap_save(path, __STD_SNAP_VEC, stdvec->stride, stdvec->len, stdvec->data);
+}
+
+// Loads a snapshot written by stdvec_save into a new
+// stdvec, checking its checksum. The element size is
+// taken from the file. Returns 1 on success, or 0 with
+// errno set, in which case `stdvec` is left untouched.
+int
+stdvec_load(StdVec *stdvec, const char *path)
+{
+  size_t size;
+  const struct __StdSnapHeader *header = __std_snap_map(path, __STD_SNAP_VEC, 1, &size);
+  if (!header) {
+    return 0;
+  }
+  size_t cap = header->len ? header->len : 1;
+  void *data = __STD_A_ALLOC(NULL, cap*header->stride);
+  (void)memcpy(data, header+1, header->len*header->stride);
+  *stdvec = (StdVec) {
+    .data = data,
+    .stride = header->stride,
+    .len = header->len,
+    .cap = cap,
+  };
+  (void)munmap((void *)header, size);
+  return 1;
+}
+
+// Maps a snapshot written by stdvec_save and points
+// `stdvec` straight at its elements, without reading or
+// copying them: pages are read in as they are touched.
+// The result is read-only: writing to it faults, and
+// pushing to it panics. stdvec_free unmaps it. The
+// checksum is only checked if `verify` is set, as that
+// reads the whole file. Returns 1 on success, or 0 with
+// errno set.
+// Example usage:
+//   StdVec v;
+//   if (!stdvec_map_snapshot(&v, "ids.snap", 0)) {
+//     v = rebuild_ids();
+//   }
+int
+stdvec_map_snapshot(StdVec *stdvec, const char *path, int verify)
+{
+  size_t size;
+  const struct __StdSnapHeader *header = __std_snap_map(path, __STD_SNAP_VEC, verify, &size);
+  if (!header) {
+    return 0;
+  }
+  *stdvec = (StdVec) {
+    .data = (void *)(header+1),
+    .stride = header->stride,
+    .len = header->len,
+    .cap = header->len,
+    .alloc = __std_snap_allocator(),
+  };
+  return 1;
+}
+#endif // STDVEC_IMPL
+
+//////////////////////////////
+// StdVec IMPLEMENTATION
+#ifdef STDSTR_IMPL
+
+// This implementation of a string
+// does not use a null byte. It entirely
+// depends on `len` and `cap`.
+struct StdStr
 {
   char *data;
   size_t len;
   size_t cap;
+  const StdAllocator *alloc;  // NULL for malloc()
 };
 typedef struct StdStr StdStr;
 
@@ -266,9 +1285,23 @@ StdStr
 stdstr_new(void)
 {
   StdStr str;
-  str.data = __STD_S_MALLOC(1);
+  str.data = __STD_A_ALLOC(NULL, 1);
+  str.len = 0;
+  str.cap = 1;
+  str.alloc = NULL;
+  return str;
+}
+
+// Same as stdstr_new, allocating
+// through `alloc` instead of malloc().
+StdStr
+stdstr_new_alloc(const StdAllocator *alloc)
+{
+  StdStr str;
+  str.data = __STD_A_ALLOC(alloc, 1);
   str.len = 0;
   str.cap = 1;
+  str.alloc = alloc;
   return str;
 }
 
@@ -281,8 +1314,10 @@ stdstr_push(StdStr *str, char c)
 {
   __STD_CHECK_MEM(str->data);
   if (str->len >= str->cap) {
+    str->data = __STD_A_REALLOC(str->alloc, str->data, str->cap, 2*str->cap);
+    __STD_CHECK_MEM(str->data);
     str->cap *= 2;
-    str->data = realloc(str->data, str->cap);
+    __STD_INSTR_WASTE(str->cap-str->len-1);
   }
   str->data[str->len++] = c;
 }
@@ -334,7 +1369,7 @@ void
 stdstr_free(StdStr *str)
 {
   __STD_CHECK_MEM(str->data);
-  free(str->data);
+  __STD_A_FREE(str->alloc, str->data, str->cap);
   str->data = NULL;
   str->len = str->cap = 0;
 }
@@ -368,7 +1403,7 @@ stdstr_from_file(const char *filepath)
     stdstr_push(&str, buf[i]);
   }
 
-  free(buf);
+  __STD_FREE(buf);
   fclose(fp);
 
   return str;
@@ -416,298 +1451,6840 @@ stdstr_rmchar(StdStr *str, char value)
   }
 }
 
-#endif // STDSTR_IMPL
-
-//////////////////////////////
-// Functions IMPLEMENTATION
-#ifdef STDFUNCS_IMPL
-
-// Returns an integer that increments whenever
-// the function gets called.
+// Writes the contents of `str` to `path` in the
+// snapshot format (see Snapshots). Returns 1 on success,
+// or 0 with errno set.
 int
-stdiota(void)
+stdstr_save(const StdStr *str, const char *path)
 {
-  static int __iota_incrementor = 0;
-  return __iota_incrementor++;
+  __STD_CHECK_MEM(str->data);
+  return __std_snap_save(path, __STD_SNAP_STR, 1, str->len, str->data);
 }
 
-// Fill an array with stdiota.
-void
-stdiota_fill(int *arr, size_t len)
+// Loads a snapshot written by stdstr_save into a new
+// stdstr, checking its checksum. Returns 1 on success,
+// or 0 with errno set, in which case `str` is left
+// untouched.
+int
+stdstr_load(StdStr *str, const char *path)
 {
-  for (size_t i = 0; i < len; ++i) {
-    arr[i] = stdiota();
+  size_t size;
+  const struct __StdSnapHeader *header = __std_snap_map(path, __STD_SNAP_STR, 1, &size);
+  if (!header) {
+    return 0;
   }
+  if (header->stride != 1) {
+    (void)munmap((void *)header, size);
+    errno = EINVAL;
+    return 0;
+  }
+  str->cap = header->len ? header->len : 1;
+  str->data = __STD_A_ALLOC(NULL, str->cap);
+  (void)memcpy(str->data, header+1, header->len);
+  str->len = header->len;
+  str->alloc = NULL;
+  (void)munmap((void *)header, size);
+  return 1;
 }
 
-// Returns 1 if all elements in `arr` satisfy
-// the function `boolfunc`. Otherwise it
-// returns 0.
-int
-stdall_of(void *arr, size_t stride, size_t len, int (boolfunc)(const void *))
+// Building with STD_STR_IO_URING defined reads through
+// an io_uring instead, if <linux/io_uring.h> is found at
+// build time. If the kernel will not set one up at run
+// time, e.g. under a seccomp filter, POSIX AIO is used.
+#ifdef STD_STR_IO_URING
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define __STDSTR_URING 1
+#endif
+#endif
+#endif // STD_STR_IO_URING
+
+// An asynchronous read of a whole file into a stdstr,
+// done with POSIX AIO. Start one with stdstr_read_async
+// or many at once with stdstr_read_async_batch, check on
+// it with stdstr_async_poll, and end it with either
+// stdstr_async_wait or stdstr_async_cancel, which both
+// free the handle. The caller can meanwhile do other
+// work, e.g. parse files that have already been read.
+// Example usage:
+//   StdStrAsync *h[n];
+//   stdstr_read_async_batch(paths, n, h);
+//   for (size_t i; (i = stdstr_async_wait_any(h, n)) < n; h[i] = NULL) {
+//     StdStr s;
+//     if (stdstr_async_wait(h[i], &s)) {
+//       parse(&s);
+//       stdstr_free(&s);
+//     }
+//   }
+struct StdStrAsync
 {
-  for (size_t i = 0; i < len; ++i) {
-    if (!boolfunc(arr+i*stride)) {
-      return 0;
-    }
+  struct aiocb cb;
+  StdStr str;   // filled up to str.len
+  size_t size;  // size of the file when it was opened
+  int done;     // 0 reading, 1 finished, -1 failed
+  int err;      // errno of a failed read
+#ifdef __STDSTR_URING
+  struct iovec iov;          // what the read in the ring reads into
+  struct StdStrAsync *next;  // next read waiting for room in the ring
+  int res;                   // result of the last read once `busy` is 0
+  int busy;                  // 1 in the ring, 2 waiting for room
+#endif
+};
+typedef struct StdStrAsync StdStrAsync;
+
+// Max requests given to a single lio_listio() call.
+#define __STDSTR_LISTIO_MAX 64
+
+// Private: opens `path` and sets up a read of the whole
+// file into a new handle, without starting it. An empty
+// file is done right away. Returns NULL with errno set
+// if the file could not be opened.
+StdStrAsync *
+__stdstr_async_new(const char *path)
+{
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
   }
-  return 1;
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    (void)close(fd);
+    errno = err;
+    return NULL;
+  }
+  StdStrAsync *h = __STD_S_MALLOC(sizeof(*h));
+  (void)memset(h, 0, sizeof(*h));
+  h->size = (size_t)st.st_size;
+  h->str.cap = h->size ? h->size : 1;
+  h->str.data = __STD_A_ALLOC(NULL, h->str.cap);
+  h->cb.aio_fildes = fd;
+  h->cb.aio_buf = h->str.data;
+  h->cb.aio_nbytes = h->size;
+  h->cb.aio_lio_opcode = LIO_READ;
+  h->cb.aio_sigevent.sigev_notify = SIGEV_NONE;
+  h->done = h->size == 0;
+  return h;
 }
 
-// Returns 1 if any elements in `arr` satisfy
-// the function `boolfunc`. Otherwise it
-// returns 0.
-int
-stdany_of(void *arr, size_t stride, size_t len, int (boolfunc)(const void *))
+// Private: frees a handle that has no read in flight.
+void
+__stdstr_async_drop(StdStrAsync *h)
 {
-  for (size_t i = 0; i < len; ++i) {
-    if (boolfunc(arr+i*stride)) {
-      return 1;
-    }
-  }
-  return 0;
+  (void)close(h->cb.aio_fildes);
+  stdstr_free(&h->str);
+  __STD_FREE(h);
 }
 
-// Returns 1 if none of the elements in `arr` satisfy
-// the function `boolfunc`. Otherwise it
-// returns 0.
+// Private: marks a read as failed with `err`.
+void
+__stdstr_async_fail(StdStrAsync *h, int err)
+{
+  h->done = -1;
+  h->err = err;
+}
+
+// Private: checks on a read in flight, and asks for the
+// rest of the file after a short read. A read of 0
+// bytes means the file shrank, and ends the read.
+// Returns 1 once the read has finished or failed.
 int
-stdnone_of(void *arr, size_t stride, size_t len, int (boolfunc)(const void *))
+__stdstr_async_step(StdStrAsync *h)
 {
-  for (size_t i = 0; i < len; ++i) {
-    if (boolfunc(arr+i*stride)) {
-      return 0;
-    }
+  if (h->done) {
+    return 1;
   }
-  return 1;
+  int err = aio_error(&h->cb);
+  if (err == EINPROGRESS) {
+    return 0;
+  }
+  ssize_t n = aio_return(&h->cb);
+  if (err != 0 || n < 0) {
+    __stdstr_async_fail(h, err ? err : EIO);
+    return 1;
+  }
+  h->str.len += (size_t)n;
+  if (n == 0 || h->str.len >= h->size) {
+    h->done = 1;
+    return 1;
+  }
+  h->cb.aio_buf = h->str.data+h->str.len;
+  h->cb.aio_offset = (off_t)h->str.len;
+  h->cb.aio_nbytes = h->size-h->str.len;
+  if (aio_read(&h->cb) != 0) {
+    __stdstr_async_fail(h, errno);
+    return 1;
+  }
+  return 0;
 }
 
-// Swaps element a with element b
-// complains if either is null for some reason
-#define __STDSWAP(type)                     \
-        void stdswap_##type(type* _val1, type* _val2) \
-        {                                             \
-          if (_val1 == NULL || _val2 == NULL)         \
-            __STD_PANIC("null pointer detected in stdswap_%s", #type); \
-          type tmp = *_val1;                          \
-          *_val1 = *_val2;                            \
-          *_val2 = tmp;                               \
-        }
+#ifdef __STDSTR_URING
 
+// Max reads in the io_uring at once.
+#define __STDSTR_RING_ENTRIES 64
 
-typedef int (*CompareFunction)(const void *, const void *);
+// Private: the io_uring shared by all reads, set up on
+// first use and kept until the process exits. `fd` is -1
+// if the kernel would not set it up. Reads that do not
+// fit in the ring wait in the `first` ... `last` list.
+// A thread that blocks for completions does so in
+// io_uring_enter() with the lock released and `waiting`
+// set. Meanwhile no other thread takes completions off
+// the ring, and they wait on `reaped` instead.
+struct __StdStrRing
+{
+  int fd;
+  unsigned entries;
+  unsigned inflight;  // entries added and not yet completed
+  unsigned queued;    // entries added and not yet submitted
+  int waiting;
+  _Atomic unsigned *sq_tail;
+  _Atomic unsigned *cq_head;
+  _Atomic unsigned *cq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  StdStrAsync *first;
+  StdStrAsync *last;
+  pthread_mutex_t lock;
+  pthread_cond_t reaped;
+};
 
-const void*
-std_is_sorted_until(const void *first, const void *last, size_t stride, CompareFunction compare)
+static struct __StdStrRing __stdstr_ring = {
+  .fd = -1,
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .reaped = PTHREAD_COND_INITIALIZER,
+};
+static pthread_once_t __stdstr_ring_once = PTHREAD_ONCE_INIT;
+
+// Private function to set up the ring.
+void
+__stdstr_ring_init(void)
 {
-  if (first != last) {
-    const void *next = first;
-    while ((next = (const char *)next + stride) != last) {
-      if (compare(next,first) < 0) {
-        return next;
-      }
-      first = next;
+  struct __StdStrRing *r = &__stdstr_ring;
+  struct io_uring_params p;
+  (void)memset(&p, 0, sizeof(p));
+  int fd = (int)syscall(__NR_io_uring_setup, __STDSTR_RING_ENTRIES, &p);
+  if (fd < 0) {
+    return;
+  }
+  size_t sq_size = p.sq_off.array+p.sq_entries*sizeof(unsigned);
+  size_t cq_size = p.cq_off.cqes+p.cq_entries*sizeof(struct io_uring_cqe);
+  size_t size = sq_size > cq_size ? sq_size : cq_size;
+  char *ring = MAP_FAILED;
+  void *sqes = MAP_FAILED;
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                fd, IORING_OFF_SQ_RING);
+  }
+  if (ring != MAP_FAILED) {
+    sqes = mmap(NULL, p.sq_entries*sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  }
+  if (sqes == MAP_FAILED) {
+    if (ring != MAP_FAILED) {
+      (void)munmap(ring, size);
     }
+    (void)close(fd);
+    return;
   }
-  return last;
+  r->entries = p.sq_entries;
+  r->sq_tail = (_Atomic unsigned *)(ring+p.sq_off.tail);
+  r->sq_mask = (unsigned *)(ring+p.sq_off.ring_mask);
+  r->sq_array = (unsigned *)(ring+p.sq_off.array);
+  r->cq_head = (_Atomic unsigned *)(ring+p.cq_off.head);
+  r->cq_tail = (_Atomic unsigned *)(ring+p.cq_off.tail);
+  r->cq_mask = (unsigned *)(ring+p.cq_off.ring_mask);
+  r->sqes = sqes;
+  r->cqes = (struct io_uring_cqe *)(ring+p.cq_off.cqes);
+  r->fd = fd;
 }
 
+// Private: 1 if reads go through the io_uring.
 int
-std_is_sorted(const void *first, const void *last, size_t stride, CompareFunction compare)
+__stdstr_ring_ok(void)
 {
-  return std_is_sorted_until(first, last, stride, compare) == last;
+  pthread_once(&__stdstr_ring_once, __stdstr_ring_init);
+  return __stdstr_ring.fd >= 0;
 }
 
-
-
-#endif // STDFUNCS_IMPL
-
-//////////////////////////////
-// StdStack IMPLEMENTATION
-#ifdef STDSTACK_IMPL
-
-struct StdStack
+// Private: adds `sqe` to the ring. The caller makes sure
+// there is room. Called with the lock held, as are all
+// of the __stdstr_ring_* functions below.
+void
+__stdstr_ring_add(const struct io_uring_sqe *sqe)
 {
-  void *data;
-  size_t stride;
-  size_t len;
-  size_t cap;
-};
-typedef struct StdStack StdStack;
+  struct __StdStrRing *r = &__stdstr_ring;
+  unsigned tail = atomic_load_explicit(r->sq_tail, memory_order_relaxed);
+  unsigned i = tail & *r->sq_mask;
+  r->sqes[i] = *sqe;
+  r->sq_array[i] = i;
+  atomic_store_explicit(r->sq_tail, tail+1, memory_order_release);
+  r->inflight += 1;
+  r->queued += 1;
+}
 
-// Create a new StdStack with element
-// size being `stride`.
-StdStack
-stdstack_new(size_t stride)
+// Private: hands the added entries to the kernel. The
+// ones it does not take are retried on the next call.
+void
+__stdstr_ring_submit(void)
 {
-  StdStack stack;
-  stack.data   = __STD_S_MALLOC(stride);
-  stack.cap    = 1;
-  stack.len    = 0;
-  stack.stride = stride;
-  return stack;
+  struct __StdStrRing *r = &__stdstr_ring;
+  while (r->queued > 0) {
+    int n = (int)syscall(__NR_io_uring_enter, r->fd, r->queued, 0, 0, NULL, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return;
+    }
+    r->queued -= (unsigned)n;
+  }
 }
 
-// Free the underlying memory of `stack`.
+// Private: adds a read of the rest of the file of `h`
+// to the ring, or to the end of the waiting list if the
+// ring is full.
 void
-stdstack_free(StdStack *stack)
+__stdstr_ring_push(StdStrAsync *h)
 {
-  __STD_CHECK_MEM(stack->data);
-  free(stack->data);
-  stack->data = NULL;
-  stack->len = stack->cap = stack->stride = 0;
+  struct __StdStrRing *r = &__stdstr_ring;
+  if (r->inflight == r->entries) {
+    h->busy = 2;
+    h->next = NULL;
+    if (r->last) {
+      r->last->next = h;
+    } else {
+      r->first = h;
+    }
+    r->last = h;
+    return;
+  }
+  h->busy = 1;
+  h->iov.iov_base = h->str.data+h->str.len;
+  h->iov.iov_len = h->size-h->str.len;
+  struct io_uring_sqe sqe = {
+    .opcode = IORING_OP_READV,
+    .fd = h->cb.aio_fildes,
+    .off = h->str.len,
+    .addr = (uintptr_t)&h->iov,
+    .len = 1,
+    .user_data = (uintptr_t)h,
+  };
+  __stdstr_ring_add(&sqe);
 }
 
-// Returns 1 if stack is empty, 0 otherwise.
-int
-stdstack_empty(StdStack *stack)
+// Private: takes the finished reads off the ring and
+// moves waiting reads into the room they leave. Does
+// nothing while another thread waits in io_uring_enter(),
+// which would then sleep through completions it is
+// waiting for.
+void
+__stdstr_ring_reap(void)
 {
-  return stack->len == 0;
+  struct __StdStrRing *r = &__stdstr_ring;
+  if (r->waiting) {
+    return;
+  }
+  unsigned head = atomic_load_explicit(r->cq_head, memory_order_relaxed);
+  unsigned tail = atomic_load_explicit(r->cq_tail, memory_order_acquire);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+    StdStrAsync *h = (StdStrAsync *)(uintptr_t)cqe->user_data;
+    if (h) {
+      h->res = cqe->res;
+      h->busy = 0;
+    }
+    r->inflight -= 1;
+  }
+  atomic_store_explicit(r->cq_head, head, memory_order_release);
+  while (r->first && r->inflight < r->entries) {
+    StdStrAsync *h = r->first;
+    r->first = h->next;
+    if (!r->first) {
+      r->last = NULL;
+    }
+    __stdstr_ring_push(h);
+  }
+  __stdstr_ring_submit();
 }
 
-// Get the element at the end of `stack`
-// i.e., stack->len-1.
-void *
-stdstack_peek(StdStack *stack)
+// Private: blocks until more reads have finished, with
+// the lock released meanwhile. Only call it with a read
+// in the ring or waiting for room.
+void
+__stdstr_ring_wait(void)
 {
-  return stack->len == 0
-    ? NULL
-    : stack->data+(stack->len-1)*stack->stride;
+  struct __StdStrRing *r = &__stdstr_ring;
+  if (r->waiting) {
+    pthread_cond_wait(&r->reaped, &r->lock);
+    return;
+  }
+  r->waiting = 1;
+  unsigned queued = r->queued;
+  pthread_mutex_unlock(&r->lock);
+  int n = (int)syscall(__NR_io_uring_enter, r->fd, queued, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+  pthread_mutex_lock(&r->lock);
+  if (n > 0) {
+    r->queued -= (unsigned)n;
+  }
+  r->waiting = 0;
+  __stdstr_ring_reap();
+  pthread_cond_broadcast(&r->reaped);
 }
 
-// Remove the value at the end of `stack`.
-// Panics if len = 0.
-void
-stdstack_pop(StdStack *stack)
+// Private: the io_uring version of __stdstr_async_step.
+int
+__stdstr_ring_step(StdStrAsync *h)
 {
-  if (stack->len == 0) {
-    __STD_PANIC("tried to pop element of a stack but its len = 0");
+  if (h->done) {
+    return 1;
   }
-  stack->len--;
+  __stdstr_ring_reap();
+  if (h->busy) {
+    return 0;
+  }
+  if (h->res < 0) {
+    __stdstr_async_fail(h, -h->res);
+    return 1;
+  }
+  h->str.len += (size_t)h->res;
+  if (h->res == 0 || h->str.len >= h->size) {
+    h->done = 1;
+    return 1;
+  }
+  __stdstr_ring_push(h);
+  __stdstr_ring_submit();
+  return 0;
 }
 
-// Push an element into `stack` at the end.
+// Private: starts the reads of the `n` handles, skipping
+// NULL ones and ones that are already done.
 void
-stdstack_push(StdStack *stack, void *value)
+__stdstr_ring_start(StdStrAsync **handles, size_t n)
 {
-  __STD_CHECK_MEM(stack->data);
-  __STD_DA_APPEND(stack, data, stride, len, cap, value);
+  pthread_mutex_lock(&__stdstr_ring.lock);
+  for (size_t i = 0; i < n; ++i) {
+    if (handles[i] && !handles[i]->done) {
+      __stdstr_ring_push(handles[i]);
+    }
+  }
+  __stdstr_ring_submit();
+  pthread_mutex_unlock(&__stdstr_ring.lock);
 }
 
-#endif // STDSTACK_IMPL
-
-//////////////////////////////
-// StdPair IMPLEMENTATION
-#ifdef STDPAIR_IMPL
-
-struct StdPair
+// Private: the io_uring version of stdstr_async_poll.
+int
+__stdstr_ring_poll(StdStrAsync *h)
 {
-  void *fst;
-  void *snd;
-};
-typedef struct StdPair StdPair;
+  pthread_mutex_lock(&__stdstr_ring.lock);
+  int done = __stdstr_ring_step(h);
+  pthread_mutex_unlock(&__stdstr_ring.lock);
+  return done;
+}
 
-// Create a new StdPair.
-StdPair
-stdpair_new(void *fst, void *snd)
+// Private: waits for the read of `h` to end.
+void
+__stdstr_ring_block(StdStrAsync *h)
 {
-  StdPair pair;
-  memcpy(&pair.fst, &fst, sizeof(fst));
-  memcpy(&pair.snd, &snd, sizeof(snd));
-  return pair;
+  pthread_mutex_lock(&__stdstr_ring.lock);
+  while (!__stdstr_ring_step(h)) {
+    __stdstr_ring_wait();
+  }
+  pthread_mutex_unlock(&__stdstr_ring.lock);
 }
 
-// Get the first element of `pair`.
-void *
-stdpair_fst(StdPair *pair)
+// Private: the io_uring version of stdstr_async_wait_any.
+size_t
+__stdstr_ring_wait_any(StdStrAsync **handles, size_t n)
 {
-  return pair->fst;
+  pthread_mutex_lock(&__stdstr_ring.lock);
+  size_t found = n;
+  for (;;) {
+    size_t live = 0;
+    for (size_t i = 0; i < n && found == n; ++i) {
+      if (handles[i]) {
+        live += 1;
+        if (__stdstr_ring_step(handles[i])) {
+          found = i;
+        }
+      }
+    }
+    if (found < n || live == 0) {
+      break;
+    }
+    __stdstr_ring_wait();
+  }
+  pthread_mutex_unlock(&__stdstr_ring.lock);
+  return found;
 }
 
-// Get the second element of `pair`.
-void *
-stdpair_snd(StdPair *pair)
+// Private: cancels the read of `h` and waits until the
+// ring no longer holds it. A read that has not finished
+// fails with ECANCELED.
+void
+__stdstr_ring_cancel(StdStrAsync *h)
 {
-  return pair->snd;
+  struct __StdStrRing *r = &__stdstr_ring;
+  pthread_mutex_lock(&r->lock);
+  if (h->busy == 2) {
+    StdStrAsync **link = &r->first, *prev = NULL;
+    while (*link != h) {
+      prev = *link;
+      link = &prev->next;
+    }
+    *link = h->next;
+    if (r->last == h) {
+      r->last = prev;
+    }
+    h->busy = 0;
+  } else if (h->busy == 1 && r->inflight < r->entries) {
+    struct io_uring_sqe sqe = {
+      .opcode = IORING_OP_ASYNC_CANCEL,
+      .addr = (uintptr_t)h,
+    };
+    __stdstr_ring_add(&sqe);
+    __stdstr_ring_submit();
+  }
+  __stdstr_ring_reap();
+  while (h->busy) {
+    __stdstr_ring_wait();
+    __stdstr_ring_reap();
+  }
+  if (!h->done) {
+    __stdstr_async_fail(h, ECANCELED);
+  }
+  pthread_mutex_unlock(&r->lock);
 }
 
-#endif // STDPAIR_IMPL
-
-////////////////////////////////
-// StdQueue IMPLEMENTATION
-#ifdef STDQUEUE_IMPL
+#endif // __STDSTR_URING
 
-struct StdQueue
+// Starts reading the file at `path` into a new stdstr.
+// Returns the handle of the read, or NULL with errno set
+// if it could not be started.
+StdStrAsync *
+stdstr_read_async(const char *path)
 {
-  void *data;
-  size_t stride;
+  StdStrAsync *h = __stdstr_async_new(path);
+#ifdef __STDSTR_URING
+  if (h && __stdstr_ring_ok()) {
+    __stdstr_ring_start(&h, 1);
+    return h;
+  }
+#endif
+  if (h && !h->done && aio_read(&h->cb) != 0) {
+    int err = errno;
+    __stdstr_async_drop(h);
+    errno = err;
+    return NULL;
+  }
+  return h;
+}
+
+// Private: submits `m` reads with one lio_listio(). If
+// it could not start some of them, each read is checked
+// on its own: reads in flight are left alone, reads that
+// failed fail with their own error, and the rest, which
+// either finished or were never queued, are read again
+// with aio_read(). Reading a finished read again is
+// harmless, and aio_error() cannot tell the two apart.
+void
+__stdstr_async_submit(StdStrAsync **owners, size_t m)
+{
+#ifdef __STDSTR_URING
+  if (__stdstr_ring_ok()) {
+    __stdstr_ring_start(owners, m);
+    return;
+  }
+#endif
+  struct aiocb *list[__STDSTR_LISTIO_MAX];
+  for (size_t i = 0; i < m; ++i) {
+    list[i] = &owners[i]->cb;
+  }
+  if (m > 0 && lio_listio(LIO_NOWAIT, list, (int)m, NULL) != 0) {
+    int err = errno;
+    for (size_t i = 0; i < m; ++i) {
+      int st = aio_error(list[i]);
+      if (st == EINPROGRESS) {
+        continue;
+      }
+      if (st == 0) {
+        if (aio_read(list[i]) == 0) {
+          continue;
+        }
+        st = errno;
+      } else if (st < 0) {
+        st = err;
+      }
+      __stdstr_async_fail(owners[i], st);
+    }
+  }
+}
+
+// Starts reading the `n` files in `paths`, submitting
+// them with lio_listio() in as few calls as possible.
+// `handles[i]` is set to the handle of `paths[i]`, or
+// to NULL if that file could not be opened. Returns the
+// number of handles set.
+size_t
+stdstr_read_async_batch(const char **paths, size_t n, StdStrAsync **handles)
+{
+  StdStrAsync *pending[__STDSTR_LISTIO_MAX];
+  size_t count = 0, m = 0;
+  for (size_t i = 0; i < n; ++i) {
+    handles[i] = __stdstr_async_new(paths[i]);
+    if (!handles[i]) {
+      continue;
+    }
+    count += 1;
+    if (!handles[i]->done) {
+      pending[m++] = handles[i];
+    }
+    if (m == __STDSTR_LISTIO_MAX) {
+      __stdstr_async_submit(pending, m);
+      m = 0;
+    }
+  }
+  __stdstr_async_submit(pending, m);
+  return count;
+}
+
+// Returns 1 if the read of `h` has finished or failed,
+// so stdstr_async_wait will not block, and 0 if it is
+// still going. Does not block.
+int
+stdstr_async_poll(StdStrAsync *h)
+{
+#ifdef __STDSTR_URING
+  if (__stdstr_ring_ok()) {
+    return __stdstr_ring_poll(h);
+  }
+#endif
+  return __stdstr_async_step(h);
+}
+
+// Waits for the read of `h` to end and frees `h`.
+// Returns 1 and sets `out` to the contents of the file,
+// or returns 0 with errno set if the read failed.
+int
+stdstr_async_wait(StdStrAsync *h, StdStr *out)
+{
+#ifdef __STDSTR_URING
+  if (__stdstr_ring_ok()) {
+    __stdstr_ring_block(h);
+  }
+#endif
+  while (!__stdstr_async_step(h)) {
+    const struct aiocb *list[1] = {&h->cb};
+    (void)aio_suspend(list, 1, NULL);
+  }
+  if (h->done < 0) {
+    int err = h->err;
+    __stdstr_async_drop(h);
+    errno = err;
+    return 0;
+  }
+  (void)close(h->cb.aio_fildes);
+  *out = h->str;
+  __STD_FREE(h);
+  return 1;
+}
+
+// Waits until one of the `n` reads in `handles` has
+// ended and returns its index, so files can be handled
+// in the order they arrive. NULL handles are skipped.
+// Returns `n` if all of them are NULL.
+size_t
+stdstr_async_wait_any(StdStrAsync **handles, size_t n)
+{
+#ifdef __STDSTR_URING
+  if (__stdstr_ring_ok()) {
+    return __stdstr_ring_wait_any(handles, n);
+  }
+#endif
+  const struct aiocb **list = __STD_S_MALLOC((n ? n : 1)*sizeof(*list));
+  size_t found = n;
+  while (found == n) {
+    size_t live = 0;
+    for (size_t i = 0; i < n && found == n; ++i) {
+      list[i] = NULL;
+      if (handles[i]) {
+        live += 1;
+        if (__stdstr_async_step(handles[i])) {
+          found = i;
+        } else {
+          list[i] = &handles[i]->cb;
+        }
+      }
+    }
+    if (found < n || live == 0) {
+      break;
+    }
+    (void)aio_suspend(list, (int)n, NULL);
+  }
+  __STD_FREE(list);
+  return found;
+}
+
+// Cancels the read of `h` and frees `h`. If the read
+// cannot be cancelled, waits for it to end, as it
+// writes into memory owned by `h`.
+void
+stdstr_async_cancel(StdStrAsync *h)
+{
+#ifdef __STDSTR_URING
+  if (__stdstr_ring_ok()) {
+    __stdstr_ring_cancel(h);
+  }
+#endif
+  if (!h->done) {
+    (void)aio_cancel(h->cb.aio_fildes, &h->cb);
+    const struct aiocb *list[1] = {&h->cb};
+    while (aio_error(&h->cb) == EINPROGRESS) {
+      (void)aio_suspend(list, 1, NULL);
+    }
+    (void)aio_return(&h->cb);
+  }
+  __stdstr_async_drop(h);
+}
+
+// Errors of the stdstr_parse_* functions.
+enum StdParseError
+{
+  STD_PARSE_OK = 0,
+  STD_PARSE_INVALID,  // no number at the start of the input
+  STD_PARSE_RANGE,    // the number does not fit the type
+};
+
+// What a stdstr_parse_* function read: `len` is the
+// number of bytes that make up the number, like the end
+// pointer of strtod(), and `err` is why it failed.
+struct StdParseResult
+{
+  size_t len;
+  enum StdParseError err;
+};
+typedef struct StdParseResult StdParseResult;
+
+// Private: 1 if the 8 bytes in `v` are all digits.
+static inline int
+__std_parse_is8digits(uint64_t v)
+{
+  return ((v & 0xf0f0f0f0f0f0f0f0ull)
+          | (((v+0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4))
+    == 0x3333333333333333ull;
+}
+
+// Private: the value of the 8 digits in `v`, combining
+// neighbouring digits, then pairs, then quads, with one
+// multiply each instead of one per digit.
+static inline uint64_t
+__std_parse_8digits(uint64_t v)
+{
+  v -= 0x3030303030303030ull;
+  v = v*10+(v >> 8);
+  return (((v & 0x000000ff000000ffull)*(100+(1000000ull << 32)))
+          + (((v >> 16) & 0x000000ff000000ffull)*(1+(10000ull << 32)))) >> 32;
+}
+
+// Private: reads the digits of `ptr` from `*i` into
+// `*acc`, 8 at a time while there are 8 of them, and
+// advances `*i` past them. `*acc` wraps around when
+// there are more than 19 digits. SWAR needs little
+// endian loads, so other machines go one at a time.
+static inline void
+__std_parse_digits(const char *ptr, size_t len, size_t *i, uint64_t *acc)
+{
+  uint64_t r = *acc;
+  size_t at = *i;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  uint64_t v;
+  while (len-at >= 8 && ((void)memcpy(&v, ptr+at, 8), __std_parse_is8digits(v))) {
+    r = r*100000000+__std_parse_8digits(v);
+    at += 8;
+  }
+#endif
+  while (at < len && (unsigned char)(ptr[at]-'0') < 10) {
+    r = r*10+(uint64_t)(ptr[at]-'0');
+    at += 1;
+  }
+  *acc = r;
+  *i = at;
+}
+
+// Private: the unsigned part of stdstr_parse_u64 and
+// stdstr_parse_i64, from `ptr[start]` on.
+static inline StdParseResult
+__std_parse_u64(const char *ptr, size_t len, size_t start, uint64_t *out)
+{
+  size_t i = start;
+  uint64_t r = 0;
+  while (i < len && ptr[i] == '0') {
+    i += 1;
+  }
+  size_t first = i;
+  // 19 digits always fit.
+  __std_parse_digits(ptr, len < first+19 ? len : first+19, &i, &r);
+  int over = 0;
+  while (i < len && (unsigned char)(ptr[i]-'0') < 10) {
+    over |= __builtin_mul_overflow(r, 10, &r);
+    over |= __builtin_add_overflow(r, (uint64_t)(ptr[i]-'0'), &r);
+    i += 1;
+  }
+  if (i == start) {
+    return (StdParseResult) {0, STD_PARSE_INVALID};
+  }
+  *out = over ? UINT64_MAX : r;
+  return (StdParseResult) {i, over ? STD_PARSE_RANGE : STD_PARSE_OK};
+}
+
+// Parses an unsigned integer from the start of the `len`
+// bytes at `ptr`, which need no null byte, into `out`:
+// an optional `+` and decimal digits. There is no
+// skipping of whitespace, and neither errno nor the
+// locale is used. Parsing stops at the first byte that
+// is not a digit, see StdParseResult. On STD_PARSE_RANGE
+// `out` is UINT64_MAX, on STD_PARSE_INVALID it is left
+// alone.
+// Example usage:
+//   uint64_t n;
+//   StdParseResult r = stdstr_parse_u64(str.data, str.len, &n);
+//   if (r.err == STD_PARSE_OK && r.len == str.len) ...
+StdParseResult
+stdstr_parse_u64(const char *ptr, size_t len, uint64_t *out)
+{
+  size_t start = len > 0 && ptr[0] == '+';
+  StdParseResult r = __std_parse_u64(ptr, len, start, out);
+  if (r.err == STD_PARSE_INVALID) {
+    r.len = 0;
+  }
+  return r;
+}
+
+// Same as stdstr_parse_u64 for a signed integer, which
+// may start with `-`. On STD_PARSE_RANGE `out` is
+// INT64_MAX or INT64_MIN.
+StdParseResult
+stdstr_parse_i64(const char *ptr, size_t len, int64_t *out)
+{
+  int neg = len > 0 && ptr[0] == '-';
+  size_t start = len > 0 && (ptr[0] == '-' || ptr[0] == '+');
+  uint64_t mag;
+  StdParseResult r = __std_parse_u64(ptr, len, start, &mag);
+  if (r.err == STD_PARSE_INVALID) {
+    r.len = 0;
+    return r;
+  }
+  uint64_t limit = (uint64_t)INT64_MAX+neg;
+  if (r.err == STD_PARSE_RANGE || mag > limit) {
+    r.err = STD_PARSE_RANGE;
+    *out = neg ? INT64_MIN : INT64_MAX;
+  } else {
+    *out = neg ? (int64_t)(0-mag) : (int64_t)mag;
+  }
+  return r;
+}
+
+// 128-bit truncations of the powers of five from 5^-342
+// to 5^308, normalized so the top bit is set, two words
+// per power, high word first. Generated with the script
+// of the fast_float library:
+//   for q < 0:  2^b // 5^-q + 1 with b = z+127 for q >= -27
+//               and b = 2z+128 then cut to 128 bits below,
+//               z being the bit length of 5^-q
+//   for q >= 0: 5^q shifted to 128 bits
+static const uint64_t __std_pow5_128[651*2] = {
+  0xeef453d6923bd65aull, 0x113faa2906a13b3full, 0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull,
+  0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull, 0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull,
+  0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull, 0xb64ec836a47146f9ull, 0x9748e2826cdee284ull,
+  0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull, 0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull,
+  0xb208ef855c969f4full, 0xbdbd2d335e51a935ull, 0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull,
+  0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull, 0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull,
+  0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull, 0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull,
+  0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull, 0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull,
+  0x84a57695fe98746dull, 0x014bb630f7604b57ull, 0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull,
+  0xcf42894a5dce35eaull, 0x52064cac828675b9ull, 0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull,
+  0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull, 0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull,
+  0xfd00b897478238d0ull, 0x8920b098955522b4ull, 0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull,
+  0xc5a890362fddbc62ull, 0xeb2189f734aa831dull, 0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull,
+  0x9a6bb0aa55653b2dull, 0x47b233c92125366eull, 0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull,
+  0xf148440a256e2c76ull, 0xc00670ea43ca250dull, 0x96cd2a865764dbcaull, 0x380406926a5e5728ull,
+  0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull, 0xeba09271e88d976bull, 0xf7864a44c633682eull,
+  0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull, 0xb8157268fdae9e4cull, 0x5960ea05bad82964ull,
+  0xe61acf033d1a45dfull, 0x6fb92487298e33bdull, 0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull,
+  0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull, 0xe0b62e2929aba83cull, 0x331acdabfe94de87ull,
+  0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull, 0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull,
+  0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull, 0x892731ac9faf056eull, 0xbe311c083a225cd2ull,
+  0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull, 0xd64d3d9db981787dull, 0x092cbbccdad5b108ull,
+  0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull, 0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull,
+  0xd1476e2c07286faaull, 0x1af5af660db4aee1ull, 0x82cca4db847945caull, 0x50d98d9fc890ed4dull,
+  0xa37fce126597973cull, 0xe50ff107bab528a0ull, 0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull,
+  0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull, 0x9faacf3df73609b1ull, 0x77b191618c54e9acull,
+  0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull, 0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull,
+  0x9becce62836ac577ull, 0x4ee367f9430aec32ull, 0xc2e801fb244576d5ull, 0x229c41f793cda73full,
+  0xf3a20279ed56d48aull, 0x6b43527578c1110full, 0x9845418c345644d6ull, 0x830a13896b78aaa9ull,
+  0xbe5691ef416bd60cull, 0x23cc986bc656d553ull, 0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull,
+  0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull, 0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull,
+  0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull, 0x91376c36d99995beull, 0x23100809b9c21fa1ull,
+  0xb58547448ffffb2dull, 0xabd40a0c2832a78aull, 0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull,
+  0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull, 0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull,
+  0xdd95317f31c7fa1dull, 0x40405643d711d583ull, 0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull,
+  0xad1c8eab5ee43b66ull, 0xda3243650005eecfull, 0xd863b256369d4a40ull, 0x90bed43e40076a82ull,
+  0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull, 0xa90de3535aaae202ull, 0x711515d0a205cb36ull,
+  0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull, 0x8412d9991ed58091ull, 0xe858790afe9486c2ull,
+  0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull, 0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full,
+  0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull, 0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull,
+  0xc987434744ac874eull, 0xa327ffb266b56220ull, 0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull,
+  0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull, 0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull,
+  0xf6019da07f549b2bull, 0x7e2a53a146606a48ull, 0x99c102844f94e0fbull, 0x2eda7444cbfc426dull,
+  0xc0314325637a1939ull, 0xfa911155fefb5308ull, 0xf03d93eebc589f88ull, 0x793555ab7eba27caull,
+  0x96267c7535b763b5ull, 0x4bc1558b2f3458deull, 0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull,
+  0xea9c227723ee8bcbull, 0x465e15a979c1cadcull, 0x92a1958a7675175full, 0x0bfacd89ec191ec9ull,
+  0xb749faed14125d36ull, 0xcef980ec671f667bull, 0xe51c79a85916f484ull, 0x82b7e12780e7401aull,
+  0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull, 0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull,
+  0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull, 0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull,
+  0xaecc49914078536dull, 0x58fae9f773886e18ull, 0xda7f5bf590966848ull, 0xaf39a475506a899eull,
+  0x888f99797a5e012dull, 0x6d8406c952429603ull, 0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull,
+  0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull, 0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full,
+  0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull, 0xd0601d8efc57b08bull, 0xf13b94daf124da26ull,
+  0x823c12795db6ce57ull, 0x76c53d08d6b70858ull, 0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull,
+  0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull, 0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull,
+  0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull, 0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull,
+  0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull, 0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull,
+  0xc21094364dfb5636ull, 0x985915fc12f542e4ull, 0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull,
+  0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull, 0xbd8430bd08277231ull, 0x50c6ff782a838353ull,
+  0xece53cec4a314ebdull, 0xa4f8bf5635246428ull, 0x940f4613ae5ed136ull, 0x871b7795e136be99ull,
+  0xb913179899f68584ull, 0x28e2557b59846e3full, 0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull,
+  0x9096ea6f3848984full, 0x3ff0d2c85def7621ull, 0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull,
+  0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull, 0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull,
+  0xb080392cc4349decull, 0xbd8d794d96aacfb3ull, 0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull,
+  0x89e42caaf9491b60ull, 0xf41686c49db57244ull, 0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull,
+  0xd77485cb25823ac7ull, 0x7d633293366b828bull, 0x86a8d39ef77164bcull, 0xae5dff9c02033197ull,
+  0xa8530886b54dbdebull, 0xd9f57f830283fdfcull, 0xd267caa862a12d66ull, 0xd072df63c324fd7bull,
+  0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull, 0xa46116538d0deb78ull, 0x52d9be85f074e608ull,
+  0xcd795be870516656ull, 0x67902e276c921f8bull, 0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull,
+  0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull, 0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull,
+  0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull, 0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull,
+  0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull, 0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull,
+  0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull, 0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull,
+  0xef340a98172aace4ull, 0x86fb897116c87c34ull, 0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull,
+  0xbae0a846d2195712ull, 0x8974836059cca109ull, 0xe998d258869facd7ull, 0x2bd1a438703fc94bull,
+  0x91ff83775423cc06ull, 0x7b6306a34627ddcfull, 0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull,
+  0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull, 0x8e938662882af53eull, 0x547eb47b7282ee9cull,
+  0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull, 0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull,
+  0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull, 0xae0b158b4738705eull, 0x9624ab50b148d445ull,
+  0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull, 0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull,
+  0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull, 0xd47487cc8470652bull, 0x7647c3200069671full,
+  0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull, 0xa5fb0a17c777cf09ull, 0xf468107100525890ull,
+  0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull, 0x81ac1fe293d599bfull, 0xc6f14cd848405530ull,
+  0xa21727db38cb002full, 0xb8ada00e5a506a7cull, 0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull,
+  0xfd442e4688bd304aull, 0x908f4a166d1da663ull, 0x9e4a9cec15763e2eull, 0x9a598e4e043287feull,
+  0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull, 0xf7549530e188c128ull, 0xd12bee59e68ef47cull,
+  0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull, 0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull,
+  0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull, 0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull,
+  0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull, 0xebdf661791d60f56ull, 0x111b495b3464ad21ull,
+  0x936b9fcebb25c995ull, 0xcab10dd900beec34ull, 0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull,
+  0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull, 0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull,
+  0xb3f4e093db73a093ull, 0x59ed216765690f56ull, 0xe0f218b8d25088b8ull, 0x306869c13ec3532cull,
+  0x8c974f7383725573ull, 0x1e414218c73a13fbull, 0xafbd2350644eeacfull, 0xe5d1929ef90898faull,
+  0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull, 0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull,
+  0xab9eb47c81f5114full, 0x066ea92f3f326564ull, 0xd686619ba27255a2ull, 0xc80a537b0efefebdull,
+  0x8613fd0145877585ull, 0xbd06742ce95f5f36ull, 0xa798fc4196e952e7ull, 0x2c48113823b73704ull,
+  0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull, 0x82ef85133de648c4ull, 0x9a984d73dbe722fbull,
+  0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull, 0xcc963fee10b7d1b3ull, 0x318df905079926a8ull,
+  0xffbbcfe994e5c61full, 0xfdf17746497f7052ull, 0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull,
+  0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull, 0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull,
+  0x9c1661a651213e2dull, 0x06bea10ca65c084eull, 0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull,
+  0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull, 0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull,
+  0xbe89523386091465ull, 0xf6bbb397f1135823ull, 0xee2ba6c0678b597full, 0x746aa07ded582e2cull,
+  0x94db483840b717efull, 0xa8c2a44eb4571cdcull, 0xba121a4650e4ddebull, 0x92f34d62616ce413ull,
+  0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull, 0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull,
+  0xb5b5ada8aaff80b8ull, 0x0d819992132456baull, 0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull,
+  0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull, 0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull,
+  0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull, 0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull,
+  0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull, 0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull,
+  0x87625f056c7c4a8bull, 0x11471cd764ad4972ull, 0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull,
+  0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull, 0x843610cb4bf160cbull, 0xcedf722a585139baull,
+  0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull, 0xce947a3da6a9273eull, 0x733d226229feea32ull,
+  0x811ccc668829b887ull, 0x0806357d5a3f525full, 0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull,
+  0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull, 0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull,
+  0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull, 0xc5029163f384a931ull, 0x0a9e795e65d4df11ull,
+  0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull, 0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull,
+  0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull, 0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull,
+  0x964e858c91ba2655ull, 0x3a6a07f8d510f86full, 0xbbe226efb628afeaull, 0x890489f70a55368bull,
+  0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull, 0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull,
+  0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull, 0xe55990879ddcaabdull, 0xcc420a6a101d0515ull,
+  0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull, 0xb32df8e9f3546564ull, 0x47939822dc96abf9ull,
+  0xdff9772470297ebdull, 0x59787e2b93bc56f7ull, 0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull,
+  0xaefae51477a06b03ull, 0xede622920b6b23f1ull, 0xdab99e59958885c4ull, 0xe95fab368e45ecedull,
+  0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull, 0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull,
+  0xd59944a37c0752a2ull, 0x4be76d3346f0495full, 0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull,
+  0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull, 0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull,
+  0x825ecc24c873782full, 0x8ed400668c0c28c8ull, 0xa2f67f2dfa90563bull, 0x728900802f0f32faull,
+  0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull, 0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull,
+  0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull, 0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull,
+  0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull, 0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull,
+  0xc24452da229b021bull, 0xfbe85badce996168ull, 0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull,
+  0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull, 0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull,
+  0xed246723473e3813ull, 0x290123e9aab23b68ull, 0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull,
+  0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull, 0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull,
+  0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull, 0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull,
+  0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull, 0x8d590723948a535full, 0x579c487e5a38ad0eull,
+  0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull, 0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull,
+  0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull, 0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full,
+  0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full, 0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull,
+  0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull, 0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull,
+  0x83a3eeeef9153e89ull, 0x1953cf68300424acull, 0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull,
+  0xcdb02555653131b6ull, 0x3792f412cb06794dull, 0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull,
+  0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull, 0xc8de047564d20a8bull, 0xf245825a5a445275ull,
+  0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull, 0x9ced737bb6c4183dull, 0x55464dd69685606bull,
+  0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull, 0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull,
+  0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull, 0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull,
+  0xef73d256a5c0f77cull, 0x963e66858f6d4440ull, 0x95a8637627989aadull, 0xdde7001379a44aa8ull,
+  0xbb127c53b17ec159ull, 0x5560c018580d5d52ull, 0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull,
+  0x9226712162ab070dull, 0xcab3961304ca70e8ull, 0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull,
+  0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull, 0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull,
+  0xb267ed1940f1c61cull, 0x55f038b237591ed3ull, 0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull,
+  0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull, 0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull,
+  0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull, 0x881cea14545c7575ull, 0x7e50d64177da2e54ull,
+  0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull, 0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull,
+  0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull, 0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull,
+  0xcfb11ead453994baull, 0x67de18eda5814af2ull, 0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull,
+  0xa2425ff75e14fc31ull, 0xa1258379a94d028dull, 0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull,
+  0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull, 0x9e74d1b791e07e48ull, 0x775ea264cf55347eull,
+  0xc612062576589ddaull, 0x95364afe032a819eull, 0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull,
+  0x9abe14cd44753b52ull, 0xc4926a9672793543ull, 0xc16d9a0095928a27ull, 0x75b7053c0f178294ull,
+  0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull, 0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull,
+  0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull, 0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull,
+  0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull, 0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull,
+  0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull, 0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull,
+  0xb424dc35095cd80full, 0x538484c19ef38c95ull, 0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull,
+  0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull, 0xafebff0bcb24aafeull, 0xf78f69a51539d749ull,
+  0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull, 0x89705f4136b4a597ull, 0x31680a88f8953031ull,
+  0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull, 0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull,
+  0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull, 0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull,
+  0xd1b71758e219652bull, 0xd3c36113404ea4a9ull, 0x83126e978d4fdf3bull, 0x645a1cac083126eaull,
+  0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull, 0xccccccccccccccccull, 0xcccccccccccccccdull,
+  0x8000000000000000ull, 0x0000000000000000ull, 0xa000000000000000ull, 0x0000000000000000ull,
+  0xc800000000000000ull, 0x0000000000000000ull, 0xfa00000000000000ull, 0x0000000000000000ull,
+  0x9c40000000000000ull, 0x0000000000000000ull, 0xc350000000000000ull, 0x0000000000000000ull,
+  0xf424000000000000ull, 0x0000000000000000ull, 0x9896800000000000ull, 0x0000000000000000ull,
+  0xbebc200000000000ull, 0x0000000000000000ull, 0xee6b280000000000ull, 0x0000000000000000ull,
+  0x9502f90000000000ull, 0x0000000000000000ull, 0xba43b74000000000ull, 0x0000000000000000ull,
+  0xe8d4a51000000000ull, 0x0000000000000000ull, 0x9184e72a00000000ull, 0x0000000000000000ull,
+  0xb5e620f480000000ull, 0x0000000000000000ull, 0xe35fa931a0000000ull, 0x0000000000000000ull,
+  0x8e1bc9bf04000000ull, 0x0000000000000000ull, 0xb1a2bc2ec5000000ull, 0x0000000000000000ull,
+  0xde0b6b3a76400000ull, 0x0000000000000000ull, 0x8ac7230489e80000ull, 0x0000000000000000ull,
+  0xad78ebc5ac620000ull, 0x0000000000000000ull, 0xd8d726b7177a8000ull, 0x0000000000000000ull,
+  0x878678326eac9000ull, 0x0000000000000000ull, 0xa968163f0a57b400ull, 0x0000000000000000ull,
+  0xd3c21bcecceda100ull, 0x0000000000000000ull, 0x84595161401484a0ull, 0x0000000000000000ull,
+  0xa56fa5b99019a5c8ull, 0x0000000000000000ull, 0xcecb8f27f4200f3aull, 0x0000000000000000ull,
+  0x813f3978f8940984ull, 0x4000000000000000ull, 0xa18f07d736b90be5ull, 0x5000000000000000ull,
+  0xc9f2c9cd04674edeull, 0xa400000000000000ull, 0xfc6f7c4045812296ull, 0x4d00000000000000ull,
+  0x9dc5ada82b70b59dull, 0xf020000000000000ull, 0xc5371912364ce305ull, 0x6c28000000000000ull,
+  0xf684df56c3e01bc6ull, 0xc732000000000000ull, 0x9a130b963a6c115cull, 0x3c7f400000000000ull,
+  0xc097ce7bc90715b3ull, 0x4b9f100000000000ull, 0xf0bdc21abb48db20ull, 0x1e86d40000000000ull,
+  0x96769950b50d88f4ull, 0x1314448000000000ull, 0xbc143fa4e250eb31ull, 0x17d955a000000000ull,
+  0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull, 0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull,
+  0xb7abc627050305adull, 0xf14a3d9e40000000ull, 0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull,
+  0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull, 0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull,
+  0xe0352f62a19e306eull, 0xd50b2037ad200000ull, 0x8c213d9da502de45ull, 0x4526f422cc340000ull,
+  0xaf298d050e4395d6ull, 0x9670b12b7f410000ull, 0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull,
+  0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull, 0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull,
+  0xd5d238a4abe98068ull, 0x72a4904598d6d880ull, 0x85a36366eb71f041ull, 0x47a6da2b7f864750ull,
+  0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull, 0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull,
+  0x82818f1281ed449full, 0xbff8f10e7a8921a4ull, 0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull,
+  0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull, 0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull,
+  0x9f4f2726179a2245ull, 0x01d762422c946590ull, 0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull,
+  0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull, 0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full,
+  0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull, 0xf316271c7fc3908aull, 0x8bef464e3945ef7aull,
+  0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull, 0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull,
+  0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull, 0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull,
+  0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull, 0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull,
+  0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull, 0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull,
+  0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull, 0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull,
+  0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull, 0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull,
+  0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull, 0xacb92ed9397bf996ull, 0x49c2c37f07965404ull,
+  0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull, 0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull,
+  0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull, 0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull,
+  0x83c7088e1aab65dbull, 0x792667c6da79e0faull, 0xa4b8cab1a1563f52ull, 0x577001b891185938ull,
+  0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull, 0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull,
+  0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull, 0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull,
+  0xfb5878494ace3a5full, 0x04ab48a04065c723ull, 0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull,
+  0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull, 0xf5746577930d6500ull, 0xca8f44ec7ee36479ull,
+  0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull, 0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull,
+  0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull, 0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull,
+  0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull, 0xea1575143cf97226ull, 0xf52d09d71a3293bdull,
+  0x924d692ca61be758ull, 0x593c2626705f9c56ull, 0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull,
+  0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull, 0x8edf98b59a373fecull, 0x4724bd4189bd5eacull,
+  0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull, 0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull,
+  0x8b865b215899f46cull, 0xbd79e0d20082ee74ull, 0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull,
+  0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull, 0x884134fe908658b2ull, 0x3109058d147fdcddull,
+  0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull, 0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull,
+  0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull, 0xa6539930bf6bff45ull, 0x84db8346b786151cull,
+  0xcfe87f7cef46ff16ull, 0xe612641865679a63ull, 0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull,
+  0xa26da3999aef7749ull, 0xe3be5e330f38f09dull, 0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull,
+  0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull, 0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull,
+  0xc646d63501a1511dull, 0xb281e1fd541501b8ull, 0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull,
+  0x9ae757596946075full, 0x3375788de9b06958ull, 0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull,
+  0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull, 0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull,
+  0xbd176620a501fbffull, 0xb650e5a93bc3d898ull, 0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull,
+  0x93ba47c980e98cdfull, 0xc66f336c36b10137ull, 0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull,
+  0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull, 0x9043ea1ac7e41392ull, 0x87c89837ad68db2full,
+  0xb454e4a179dd1877ull, 0x29babe4598c311fbull, 0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull,
+  0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull, 0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full,
+  0xdc21a1171d42645dull, 0x76707543f4fa1f73ull, 0x899504ae72497ebaull, 0x6a06494a791c53a8ull,
+  0xabfa45da0edbde69ull, 0x0487db9d17636892ull, 0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull,
+  0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull, 0xa7f26836f282b732ull, 0x8e6cac7768d7141eull,
+  0xd1ef0244af2364ffull, 0x3207d795430cd926ull, 0x8335616aed761f1full, 0x7f44e6bd49e807b8ull,
+  0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull, 0xcd036837130890a1ull, 0x36dba887c37a8c0full,
+  0x802221226be55a64ull, 0xc2494954da2c9789ull, 0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull,
+  0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull, 0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull,
+  0x9c69a97284b578d7ull, 0xff2a760414536efbull, 0xc38413cf25e2d70dull, 0xfef5138519684abaull,
+  0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull, 0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull,
+  0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull, 0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull,
+  0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull, 0xba756174393d88dfull, 0x94f971119aeef9e4ull,
+  0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull, 0x91abb422ccb812eeull, 0xac62e055c10ab33aull,
+  0xb616a12b7fe617aaull, 0x577b986b314d6009ull, 0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull,
+  0x8e41ade9fbebc27dull, 0x14588f13be847307ull, 0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull,
+  0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull, 0x8aec23d680043beeull, 0x25de7bb9480d5854ull,
+  0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull, 0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull,
+  0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull, 0xa99541bf57452b28ull, 0x353a1607ac744a53ull,
+  0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull, 0x847c9b5d7c2e09b7ull, 0x69956135febada11ull,
+  0xa59bc234db398c25ull, 0x43fab9837e699095ull, 0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull,
+  0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull, 0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull,
+  0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull, 0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull,
+  0x9defbf01b061adabull, 0x3a0888136afa64a7ull, 0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull,
+  0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull, 0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull,
+  0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull, 0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull,
+  0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull, 0xbc4665b596706114ull, 0x873d5d9f0dde1feeull,
+  0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull, 0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull,
+  0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full, 0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull,
+  0x8fa475791a569d10ull, 0xf96e017d694487bcull, 0xb38d92d760ec4455ull, 0x37c981dcc395a9acull,
+  0xe070f78d3927556aull, 0x85bbe253f47b1417ull, 0x8c469ab843b89562ull, 0x93956d7478ccec8eull,
+  0xaf58416654a6babbull, 0x387ac8d1970027b2ull, 0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull,
+  0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull, 0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull,
+  0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull, 0x85c7056562757456ull, 0xf6872d5667844e49ull,
+  0xa738c6bebb12d16cull, 0xb428f8ac016561dbull, 0xd106f86e69d785c7ull, 0xe13336d701beba52ull,
+  0x82a45b450226b39cull, 0xecc0024661173473ull, 0xa34d721642b06084ull, 0x27f002d7f95d0190ull,
+  0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull, 0xff290242c83396ceull, 0x7e67047175a15271ull,
+  0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull, 0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull,
+  0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull, 0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull,
+  0xc2abf989935ddbfeull, 0x6acff893d00ea435ull, 0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull,
+  0x98165af37b2153deull, 0xc3727a337a8b704aull, 0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull,
+  0xeda2ee1c7064130cull, 0x1162def06f79df73ull, 0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull,
+  0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull, 0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull,
+  0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull, 0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull,
+  0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull, 0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull,
+  0xb10d8e1456105dadull, 0x7425a83e872c5f47ull, 0xdd50f1996b947518ull, 0xd12f124e28f77719ull,
+  0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full, 0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull,
+  0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull, 0x8714a775e3e95c78ull, 0x65acfaec34810a71ull,
+  0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull, 0xd31045a8341ca07cull, 0x1ede48111209a050ull,
+  0x83ea2b892091e44dull, 0x934aed0aab460432ull, 0xa4e4b66b68b65d60ull, 0xf81da84d5617853full,
+  0xce1de40642e3f4b9ull, 0x36251260ab9d668eull, 0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull,
+  0xa1075a24e4421730ull, 0xb24cf65b8612f81full, 0xc94930ae1d529cfcull, 0xdee033f26797b627ull,
+  0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull, 0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull,
+  0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull, 0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull,
+  0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull, 0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull,
+  0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull, 0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull,
+  0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull, 0xea53df5fd18d5513ull, 0x84c86189216dc5edull,
+  0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull, 0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull,
+  0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull, 0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull,
+  0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull, 0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull,
+  0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull, 0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull,
+  0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull, 0x8865899617fb1871ull, 0x7e2fa67c7a658892ull,
+  0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull, 0xd51ea6fa85785631ull, 0x552a74227f3ea565ull,
+  0x8533285c936b35deull, 0xd53a88958f87275full, 0xa67ff273b8460356ull, 0x8a892abaf368f137ull,
+  0xd01fef10a657842cull, 0x2d2b7569b0432d85ull, 0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull,
+  0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full, 0xcb3f2f7642717713ull, 0x241c70a936219a73ull,
+  0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull, 0x9ec95d1463e8a506ull, 0xf4363804324a40aaull,
+  0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull, 0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull,
+  0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull, 0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull,
+  0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull, 0x976e41088617ca01ull, 0xd5be0503e085d813ull,
+  0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull, 0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull,
+  0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull, 0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull,
+  0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull, 0x906a617d450187e2ull, 0x27fb2b80668b24c5ull,
+  0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull, 0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull,
+  0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull, 0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull,
+  0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull, 0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull,
+  0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull, 0xd732290fbacaf133ull, 0xa97c177947ad4095ull,
+  0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull, 0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull,
+  0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull, 0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull,
+  0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull, 0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull,
+  0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull, 0xa0555e361951c366ull, 0xd7e105bcc332621full,
+  0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull, 0xfa856334878fc150ull, 0xb14f98f6f0feb951ull,
+  0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull, 0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull,
+  0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull, 0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull,
+  0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull, 0xeeea5d5004981478ull, 0x1858ccfce06cac74ull,
+  0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull, 0xbaa718e68396cffdull, 0xd30560258f54e6baull,
+  0xe950df20247c83fdull, 0x47c6b82ef32a2069ull, 0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull,
+  0xb6472e511c81471dull, 0xe0133fe4adf8e952ull, 0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull,
+  0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull,
+};
+
+// Private: the bits of the double closest to `w`*10^`q`,
+// for a `w` other than 0, following Eisel and Lemire's
+// "Number Parsing at a Gigabyte per Second" and Mushtak
+// and Lemire's proof that 128 bits of 5^q always do.
+// This is exact when `w` holds every digit of the input.
+static inline uint64_t
+__std_parse_eisel_lemire(uint64_t w, int64_t q)
+{
+  if (q < -342) {
+    return 0;
+  }
+  if (q > 308) {
+    return (uint64_t)0x7ff << 52;
+  }
+  int lz = __builtin_clzll(w);
+  w <<= lz;
+  const uint64_t *pow5 = __std_pow5_128+2*(q+342);
+  unsigned __int128 product = (unsigned __int128)w*pow5[0];
+  uint64_t hi = (uint64_t)(product >> 64), lo = (uint64_t)product;
+  // Only when the low bits past the mantissa are all
+  // ones can the second word of 5^q carry into them.
+  if ((hi & 0x1ff) == 0x1ff) {
+    uint64_t carry = (uint64_t)(((unsigned __int128)w*pow5[1]) >> 64);
+    lo += carry;
+    hi += lo < carry;
+  }
+  int upperbit = (int)(hi >> 63);
+  int shift = upperbit+9;
+  uint64_t mantissa = hi >> shift;
+  int64_t power2 = ((217706*q) >> 16)+63+upperbit-lz+1023;
+  if (power2 <= 0) {
+    // Subnormal, or zero.
+    if (-power2+1 >= 64) {
+      return 0;
+    }
+    mantissa >>= -power2+1;
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    power2 = mantissa < ((uint64_t)1 << 52) ? 0 : 1;
+    return (uint64_t)power2 << 52 | (mantissa & (((uint64_t)1 << 52)-1));
+  }
+  // Exactly halfway between two doubles: round to even.
+  if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1
+      && (mantissa << shift) == hi) {
+    mantissa &= ~(uint64_t)1;
+  }
+  mantissa += mantissa & 1;
+  mantissa >>= 1;
+  if (mantissa >= ((uint64_t)2 << 52)) {
+    mantissa = (uint64_t)1 << 52;
+    power2 += 1;
+  }
+  if (power2 >= 0x7ff) {
+    return (uint64_t)0x7ff << 52;
+  }
+  return (uint64_t)power2 << 52 | (mantissa & (((uint64_t)1 << 52)-1));
+}
+
+// Private: 1 if `ptr` starts with `word`, ignoring case.
+static inline int
+__std_parse_word(const char *ptr, size_t len, const char *word)
+{
+  size_t n = strlen(word);
+  if (len < n) {
+    return 0;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    if ((ptr[i] | 0x20) != word[i]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Private: the slow path of stdstr_parse_f64, for inputs
+// with so many digits that the closest double depends on
+// digits past the 19th. Hands strtod() the digits of the
+// number as an integer with an exponent, which has no
+// decimal point for the locale to change, keeping errno
+// as it was. Past 768 digits only whether any digit is
+// non-zero matters, so the rest is cut to a single one.
+static inline double
+__std_parse_f64_slow(const char *ptr, size_t int_at, size_t int_len,
+                     size_t frac_at, size_t frac_len, int64_t exp)
+{
+  char buf[768+32];
+  size_t n = 0, dropped = 0;
+  int sticky = 0;
+  for (size_t k = 0; k < int_len+frac_len; ++k) {
+    char c = k < int_len ? ptr[int_at+k] : ptr[frac_at+k-int_len];
+    if (n == 0 && c == '0') {
+      continue;
+    }
+    if (n < 768) {
+      buf[n++] = c;
+    } else {
+      dropped += 1;
+      sticky |= c != '0';
+    }
+  }
+  if (sticky) {
+    buf[n++] = '1';
+    dropped -= 1;
+  }
+  exp += (int64_t)dropped-(int64_t)frac_len;
+  (void)snprintf(buf+n, sizeof(buf)-n, "e%lld", (long long)exp);
+  int saved = errno;
+  double d = strtod(buf, NULL);
+  errno = saved;
+  return d;
+}
+
+// Parses a floating point number from the start of the
+// `len` bytes at `ptr`, which need no null byte, into
+// `out`: an optional sign, digits with an optional `.`,
+// and an optional exponent, or "inf", "infinity" or
+// "nan" in any case. There is no skipping of whitespace
+// and no hexadecimal floats. The decimal point is always
+// `.`, as the locale is not used, and errno is left
+// alone. The result is the double closest to the input,
+// as with strtod(). Numbers too large for a double give
+// STD_PARSE_RANGE with an infinity, and numbers too
+// small give STD_PARSE_RANGE with a zero.
+// Example usage:
+//   double d;
+//   StdParseResult r = stdstr_parse_f64(field, field_len, &d);
+StdParseResult
+stdstr_parse_f64(const char *ptr, size_t len, double *out)
+{
+  static const double exact[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+  };
+  size_t i = 0;
+  int neg = len > 0 && ptr[0] == '-';
+  i += len > 0 && (ptr[0] == '-' || ptr[0] == '+');
+
+  if (__std_parse_word(ptr+i, len-i, "inf")) {
+    i += __std_parse_word(ptr+i, len-i, "infinity") ? 8 : 3;
+    *out = neg ? -__builtin_inf() : __builtin_inf();
+    return (StdParseResult) {i, STD_PARSE_OK};
+  }
+  if (__std_parse_word(ptr+i, len-i, "nan")) {
+    *out = neg ? -__builtin_nan("") : __builtin_nan("");
+    return (StdParseResult) {i+3, STD_PARSE_OK};
+  }
+
+  uint64_t w = 0;
+  size_t int_at = i;
+  __std_parse_digits(ptr, len, &i, &w);
+  size_t int_len = i-int_at, frac_at = i, frac_len = 0;
+  if (i < len && ptr[i] == '.') {
+    i += 1;
+    frac_at = i;
+    __std_parse_digits(ptr, len, &i, &w);
+    frac_len = i-frac_at;
+  }
+  if (int_len+frac_len == 0) {
+    return (StdParseResult) {0, STD_PARSE_INVALID};
+  }
+
+  int64_t exp = 0;
+  if (i < len && (ptr[i] | 0x20) == 'e') {
+    size_t e = i+1;
+    int eneg = e < len && ptr[e] == '-';
+    e += e < len && (ptr[e] == '-' || ptr[e] == '+');
+    if (e < len && (unsigned char)(ptr[e]-'0') < 10) {
+      for (; e < len && (unsigned char)(ptr[e]-'0') < 10; ++e) {
+        if (exp < 0x10000000) {
+          exp = exp*10+(ptr[e]-'0');
+        }
+      }
+      exp = eneg ? -exp : exp;
+      i = e;
+    }
+  }
+
+  // More than 19 digits do not fit `w`: keep the
+  // first 19 that are not leading zeros.
+  size_t digits = int_len+frac_len, lead = 0;
+  while (lead < digits && (lead < int_len ? ptr[int_at+lead] : ptr[frac_at+lead-int_len]) == '0') {
+    lead += 1;
+  }
+  int many = digits-lead > 19;
+  int64_t q = exp-(int64_t)frac_len;
+  if (many) {
+    w = 0;
+    size_t k = lead;
+    for (; k < lead+19; ++k) {
+      w = w*10+(uint64_t)((k < int_len ? ptr[int_at+k] : ptr[frac_at+k-int_len])-'0');
+    }
+    q = exp+(int64_t)int_len-(int64_t)k;
+  }
+
+  double d = 0;
+  if (w == 0) {
+    *out = neg ? -d : d;
+    return (StdParseResult) {i, STD_PARSE_OK};
+  }
+  if (!many && q >= -22 && q <= 22 && w <= (uint64_t)1 << 53) {
+    // Both `w` and 10^|q| are exact doubles, so a single
+    // rounding gives the closest double (Clinger).
+    d = q < 0 ? (double)w/exact[-q] : (double)w*exact[q];
+  } else {
+    uint64_t bits = __std_parse_eisel_lemire(w, q);
+    if (many && bits != __std_parse_eisel_lemire(w+1, q)) {
+      d = __std_parse_f64_slow(ptr, int_at, int_len, frac_at, frac_len, exp);
+    } else {
+      (void)memcpy(&d, &bits, sizeof(d));
+    }
+  }
+  *out = neg ? -d : d;
+  int range = d == 0 || d == __builtin_inf();
+  return (StdParseResult) {i, range ? STD_PARSE_RANGE : STD_PARSE_OK};
+}
+
+#ifdef STDVEC_IMPL
+// Private: defines stdstr_parse_column_<sfx>.
+#define __STDSTR_PARSE_COLUMN_DECL(sfx, type)                           \
+  StdParseResult                                                        \
+  stdstr_parse_column_##sfx(const char *ptr, size_t len, char sep, StdVec *out) \
+  {                                                                     \
+    if (out->stride != sizeof(type)) {                                  \
+      __STD_PANIC("stride %zu is not sizeof(" #type ")", out->stride);  \
+    }                                                                   \
+    size_t i = 0;                                                       \
+    while (i < len) {                                                   \
+      type v;                                                           \
+      StdParseResult r = stdstr_parse_##sfx(ptr+i, len-i, &v);          \
+      if (r.err == STD_PARSE_OK && i+r.len < len && ptr[i+r.len] != sep) { \
+        r.err = STD_PARSE_INVALID;                                      \
+      }                                                                 \
+      if (r.err != STD_PARSE_OK) {                                      \
+        return (StdParseResult) {i+r.len, r.err};                       \
+      }                                                                 \
+      stdvec_push(out, &v);                                             \
+      i += r.len+1;                                                     \
+    }                                                                   \
+    return (StdParseResult) {len, STD_PARSE_OK};                        \
+  }
+
+// Parses the `len` bytes at `ptr` as numbers separated
+// by `sep`, e.g. a column of a CSV file with `sep` '\n',
+// and pushes them to `out`, whose stride must match. A
+// trailing `sep` is allowed. Stops at the first field
+// that is not a whole number, returning its error and
+// where it is, in `len`. Otherwise `len` is all of them.
+// Example usage:
+//   StdVec prices = stdvec_new(sizeof(double));
+//   StdParseResult r = stdstr_parse_column_f64(col.data, col.len, '\n', &prices);
+__STDSTR_PARSE_COLUMN_DECL(i64, int64_t)
+__STDSTR_PARSE_COLUMN_DECL(u64, uint64_t)
+__STDSTR_PARSE_COLUMN_DECL(f64, double)
+#endif // STDVEC_IMPL
+
+// A view of `len` bytes at `data` that it does not own,
+// e.g. a field of a StdStr. Views are never freed, and
+// must not outlive what they point into.
+struct StdStrView
+{
+  const char *data;
+  size_t len;
+};
+typedef struct StdStrView StdStrView;
+
+// Creates a view of `len` bytes at `data`.
+StdStrView
+stdstrview_new(const char *data, size_t len)
+{
+  return (StdStrView) {.data = data, .len = len};
+}
+
+// Creates a view of the whole of `str`.
+StdStrView
+stdstrview_from(const StdStr *str)
+{
+  return (StdStrView) {.data = str->data, .len = str->len};
+}
+
+// Compares `a` and `b` byte by byte as unsigned chars,
+// a prefix coming before the longer string. Returns
+// <0, 0 or >0 like memcmp().
+int
+stdstrview_cmp(StdStrView a, StdStrView b)
+{
+  int c = memcmp(a.data, b.data, a.len < b.len ? a.len : b.len);
+  return c ? c : (a.len > b.len)-(a.len < b.len);
+}
+
+// Same as stdstrview_cmp for two StdStr *, so it can be
+// given to qsort() and stdvec_qsort.
+int
+stdstr_cmp(const void *a, const void *b)
+{
+  return stdstrview_cmp(stdstrview_from(a), stdstrview_from(b));
+}
+
+// Private: a string being radix sorted. `prefix` caches
+// the 8 bytes of the string from the current depth
+// rounded down to 8, first byte highest and zero past
+// the end, so most steps read no string memory. `idx`
+// is where the string was before sorting.
+struct __StdStrKey
+{
+  uint64_t prefix;
+  const char *data;
+  size_t len;
+  size_t idx;
+};
+
+// Private: a range of keys still to be sorted, all
+// equal in their first `depth` bytes.
+struct __StdStrSortRange
+{
+  size_t lo;
+  size_t n;
+  size_t depth;
+};
+
+// Below this many keys a range is insertion sorted.
+#define __STDSTR_SORT_SMALL 32
+
+// Private: loads the prefix of `key` at `depth`.
+static inline void
+__stdstr_key_load(struct __StdStrKey *key, size_t depth)
+{
+  uint64_t p = 0;
+  if (key->len >= depth+8) {
+    (void)memcpy(&p, key->data+depth, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    p = __builtin_bswap64(p);
+#endif
+  } else {
+    for (size_t i = depth; i < key->len; ++i) {
+      p |= (uint64_t)(unsigned char)key->data[i] << (56-8*(i-depth));
+    }
+  }
+  key->prefix = p;
+}
+
+// Private: the bucket of `key` at `depth`: 0 if it
+// ends there, or its byte there plus 1.
+static inline unsigned
+__stdstr_key_bucket(const struct __StdStrKey *key, size_t depth)
+{
+  if (key->len <= depth) {
+    return 0;
+  }
+  return (unsigned)(key->prefix >> (56-8*(depth & 7)) & 0xff)+1;
+}
+
+// Private: compares two keys that are equal in their
+// first `depth` bytes. As the padding is the smallest
+// byte, prefixes that differ are in the right order,
+// but equal ones may still differ in length.
+static inline int
+__stdstr_key_cmp(const struct __StdStrKey *a, const struct __StdStrKey *b, size_t depth)
+{
+  if (a->prefix != b->prefix) {
+    return a->prefix < b->prefix ? -1 : 1;
+  }
+  size_t from = (depth & ~(size_t)7)+8;
+  size_t la = a->len > from ? a->len-from : 0;
+  size_t lb = b->len > from ? b->len-from : 0;
+  int c = memcmp(a->data+from, b->data+from, la < lb ? la : lb);
+  return c ? c : (a->len > b->len)-(a->len < b->len);
+}
+
+// Private: insertion sorts `n` keys equal in their
+// first `depth` bytes.
+static inline void
+__stdstr_key_isort(struct __StdStrKey *keys, size_t n, size_t depth)
+{
+  for (size_t i = 1; i < n; ++i) {
+    struct __StdStrKey key = keys[i];
+    size_t j = i;
+    while (j > 0 && __stdstr_key_cmp(&key, &keys[j-1], depth) < 0) {
+      keys[j] = keys[j-1];
+      j -= 1;
+    }
+    keys[j] = key;
+  }
+}
+
+// Private: MSD radix sorts `n` keys in place, one byte
+// per pass, with American flag sort: count the keys of
+// every bucket, then swap each key straight into its
+// bucket. Ranges left to sort are kept on a stack, not
+// recursed into, so long shared prefixes cannot run
+// out of stack.
+void
+__stdstr_radix_sort_keys(struct __StdStrKey *keys, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    __stdstr_key_load(&keys[i], 0);
+  }
+  struct __StdStrSortRange *todo = __STD_S_MALLOC(16*sizeof(*todo));
+  size_t ntodo = 1, captodo = 16;
+  todo[0] = (struct __StdStrSortRange) {0, n, 0};
+  size_t count[257], next[257], end[257];
+
+  while (ntodo > 0) {
+    struct __StdStrSortRange r = todo[--ntodo];
+    struct __StdStrKey *k = keys+r.lo;
+    if (r.depth > 0 && (r.depth & 7) == 0) {
+      for (size_t i = 0; i < r.n; ++i) {
+        __stdstr_key_load(&k[i], r.depth);
+      }
+    }
+    if (r.n < __STDSTR_SORT_SMALL) {
+      __stdstr_key_isort(k, r.n, r.depth);
+      continue;
+    }
+
+    // Skip the rest of the cached prefix in one go if
+    // every key has all of it and it is the same.
+    size_t window = (r.depth & ~(size_t)7)+8;
+    int shared = 1;
+    for (size_t i = 0; i < r.n && shared; ++i) {
+      shared = k[i].prefix == k[0].prefix && k[i].len >= window;
+    }
+    if (shared) {
+      todo[ntodo++] = (struct __StdStrSortRange) {r.lo, r.n, window};
+      continue;
+    }
+
+    (void)memset(count, 0, sizeof(count));
+    for (size_t i = 0; i < r.n; ++i) {
+      count[__stdstr_key_bucket(&k[i], r.depth)] += 1;
+    }
+    size_t at = 0;
+    for (unsigned b = 0; b < 257; ++b) {
+      next[b] = at;
+      at += count[b];
+      end[b] = at;
+    }
+    for (unsigned b = 0; b < 257; ++b) {
+      while (next[b] < end[b]) {
+        struct __StdStrKey key = k[next[b]];
+        unsigned kb = __stdstr_key_bucket(&key, r.depth);
+        while (kb != b) {
+          struct __StdStrKey tmp = k[next[kb]];
+          k[next[kb]++] = key;
+          key = tmp;
+          kb = __stdstr_key_bucket(&key, r.depth);
+        }
+        k[next[b]++] = key;
+      }
+    }
+
+    // Bucket 0 ended at this depth, so it is all
+    // equal strings. The others go one byte deeper.
+    for (unsigned b = 1; b < 257; ++b) {
+      if (count[b] < 2) {
+        continue;
+      }
+      if (ntodo == captodo) {
+        captodo *= 2;
+        todo = __STD_REALLOC(todo, captodo*sizeof(*todo));
+        __STD_CHECK_MEM(todo);
+      }
+      todo[ntodo++] = (struct __StdStrSortRange) {r.lo+end[b]-count[b], count[b], r.depth+1};
+    }
+  }
+  __STD_FREE(todo);
+}
+
+// Private: sorts the `n` strings of `stride` bytes at
+// `base`, which start with a `data` and a `len` like a
+// StdStrView, by sorting keys and then moving every
+// string once along the cycles of the permutation.
+void
+__stdstr_radix_sort(void *base, size_t n, size_t stride)
+{
+  if (n < 2) {
+    return;
+  }
+  struct __StdStrKey *keys = __STD_S_MALLOC(n*sizeof(*keys));
+  char *elems = base;
+  for (size_t i = 0; i < n; ++i) {
+    StdStrView v;
+    (void)memcpy(&v, elems+i*stride, sizeof(v));
+    keys[i] = (struct __StdStrKey) {.data = v.data, .len = v.len, .idx = i};
+  }
+  __stdstr_radix_sort_keys(keys, n);
+
+  char tmp[stride];
+  for (size_t i = 0; i < n; ++i) {
+    if (keys[i].idx == i) {
+      continue;
+    }
+    (void)memcpy(tmp, elems+i*stride, stride);
+    size_t j = i;
+    while (keys[j].idx != i) {
+      size_t from = keys[j].idx;
+      (void)memcpy(elems+j*stride, elems+from*stride, stride);
+      keys[j].idx = j;
+      j = from;
+    }
+    (void)memcpy(elems+j*stride, tmp, stride);
+    keys[j].idx = j;
+  }
+  __STD_FREE(keys);
+}
+
+_Static_assert(offsetof(StdStr, data) == offsetof(StdStrView, data)
+               && offsetof(StdStr, len) == offsetof(StdStrView, len),
+               "StdStr must start like StdStrView");
+
+// Sorts `n` strings in byte order, as stdstr_cmp does,
+// with an MSD radix sort. It is not stable. Each step
+// looks at one byte of every string, read from a cached
+// 8-byte prefix instead of through its pointer, and
+// small ranges are insertion sorted. Uses 32 bytes of
+// memory per string.
+void
+stdstr_radix_sort(StdStr *strs, size_t n)
+{
+  __stdstr_radix_sort(strs, n, sizeof(*strs));
+}
+
+// Same as stdstr_radix_sort for views.
+void
+stdstrview_radix_sort(StdStrView *views, size_t n)
+{
+  __stdstr_radix_sort(views, n, sizeof(*views));
+}
+
+#ifdef STDVEC_IMPL
+// Same as stdstr_radix_sort for a stdvec of StdStr.
+void
+stdvec_radix_sort_str(StdVec *stdvec)
+{
+  if (stdvec->stride != sizeof(StdStr)) {
+    __STD_PANIC("stride %zu is not sizeof(StdStr)", stdvec->stride);
+  }
+  stdstr_radix_sort(stdvec->data, stdvec->len);
+}
+#endif // STDVEC_IMPL
+
+#endif // STDSTR_IMPL
+
+//////////////////////////////
+// Functions IMPLEMENTATION
+#ifdef STDFUNCS_IMPL
+
+// Returns an integer that increments whenever
+// the function gets called.
+int
+stdiota(void)
+{
+  static int __iota_incrementor = 0;
+  return __iota_incrementor++;
+}
+
+// Fill an array with stdiota.
+void
+stdiota_fill(int *arr, size_t len)
+{
+  for (size_t i = 0; i < len; ++i) {
+    arr[i] = stdiota();
+  }
+}
+
+// Returns 1 if all elements in `arr` satisfy
+// the function `boolfunc`. Otherwise it
+// returns 0.
+int
+stdall_of(void *arr, size_t stride, size_t len, int (boolfunc)(const void *))
+{
+  for (size_t i = 0; i < len; ++i) {
+    if (!boolfunc(arr+i*stride)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Returns 1 if any elements in `arr` satisfy
+// the function `boolfunc`. Otherwise it
+// returns 0.
+int
+stdany_of(void *arr, size_t stride, size_t len, int (boolfunc)(const void *))
+{
+  for (size_t i = 0; i < len; ++i) {
+    if (boolfunc(arr+i*stride)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Returns 1 if none of the elements in `arr` satisfy
+// the function `boolfunc`. Otherwise it
+// returns 0.
+int
+stdnone_of(void *arr, size_t stride, size_t len, int (boolfunc)(const void *))
+{
+  for (size_t i = 0; i < len; ++i) {
+    if (boolfunc(arr+i*stride)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+// Swaps element a with element b
+// complains if either is null for some reason
+#define __STDSWAP(type)                     \
+        void stdswap_##type(type* _val1, type* _val2) \
+        {                                             \
+          if (_val1 == NULL || _val2 == NULL)         \
+            __STD_PANIC("null pointer detected in stdswap_%s", #type); \
+          type tmp = *_val1;                          \
+          *_val1 = *_val2;                            \
+          *_val2 = tmp;                               \
+        }
+
+
+typedef int (*CompareFunction)(const void *, const void *);
+
+const void*
+std_is_sorted_until(const void *first, const void *last, size_t stride, CompareFunction compare)
+{
+  if (first != last) {
+    const void *next = first;
+    while ((next = (const char *)next + stride) != last) {
+      if (compare(next,first) < 0) {
+        return next;
+      }
+      first = next;
+    }
+  }
+  return last;
+}
+
+int
+std_is_sorted(const void *first, const void *last, size_t stride, CompareFunction compare)
+{
+  return std_is_sorted_until(first, last, stride, compare) == last;
+}
+
+// Same as std_is_sorted_until, but equal neighbours
+// also count as unsorted.
+const void*
+std_is_sorted_strict_until(const void *first, const void *last, size_t stride,
+                           CompareFunction compare)
+{
+  if (first != last) {
+    const void *next = first;
+    while ((next = (const char *)next + stride) != last) {
+      if (compare(next,first) <= 0) {
+        return next;
+      }
+      first = next;
+    }
+  }
+  return last;
+}
+
+// Returns 1 if every element is strictly
+// greater than the one before it.
+int
+std_is_sorted_strict(const void *first, const void *last, size_t stride, CompareFunction compare)
+{
+  return std_is_sorted_strict_until(first, last, stride, compare) == last;
+}
+
+// Returns the first element in [first, last) that is
+// not less than `key`, or `last` if there is none.
+// The range must be sorted by `compare`, which gets an
+// element first and `key` second. The loop narrows the
+// range by moving its start, not by branching on the
+// comparison, so it does not mispredict, and prefetches
+// both places the next step may look at.
+const void*
+std_lower_bound(const void *first, const void *last, size_t stride, const void *key,
+                CompareFunction compare)
+{
+  size_t n = (size_t)((const char *)last-(const char *)first)/stride;
+  if (n == 0) {
+    return last;
+  }
+  const char *base = first;
+  while (n > 1) {
+    size_t half = n/2;
+    __builtin_prefetch(base+half/2*stride);
+    __builtin_prefetch(base+(half+half/2)*stride);
+    base += (compare(base+half*stride, key) < 0)*half*stride;
+    n -= half;
+  }
+  return base+(compare(base, key) < 0)*stride;
+}
+
+// Same as std_lower_bound, but returns the first
+// element that is greater than `key`.
+const void*
+std_upper_bound(const void *first, const void *last, size_t stride, const void *key,
+                CompareFunction compare)
+{
+  size_t n = (size_t)((const char *)last-(const char *)first)/stride;
+  if (n == 0) {
+    return last;
+  }
+  const char *base = first;
+  while (n > 1) {
+    size_t half = n/2;
+    __builtin_prefetch(base+half/2*stride);
+    __builtin_prefetch(base+(half+half/2)*stride);
+    base += (compare(base+half*stride, key) <= 0)*half*stride;
+    n -= half;
+  }
+  return base+(compare(base, key) <= 0)*stride;
+}
+
+// Sets [lo, hi) to the elements of [first, last) that
+// are equal to `key`. If there are none, both are where
+// `key` would go.
+void
+std_equal_range(const void *first, const void *last, size_t stride, const void *key,
+                CompareFunction compare, const void **lo, const void **hi)
+{
+  *lo = std_lower_bound(first, last, stride, key, compare);
+  *hi = std_upper_bound(*lo, last, stride, key, compare);
+}
+
+// The orders the typed is_sorted functions can check for.
+// The strict ones do not allow equal neighbours.
+enum StdSortOrder
+{
+  STD_SORT_ASC,
+  STD_SORT_DESC,
+  STD_SORT_ASC_STRICT,
+  STD_SORT_DESC_STRICT,
+};
+typedef enum StdSortOrder StdSortOrder;
+
+// Private: one loop over `arr` for each order. `FAIL`
+// is how a neighbour pair breaks the order, written on
+// `cur` and `prev`. Each block of __STD_SORTED_BLOCK
+// pairs is checked without branching, which the compiler
+// may vectorize, and the scalar loop then finds the
+// exact index, starting at the block that failed.
+#define __STD_SORTED_LOOPS                                              \
+  switch (order) {                                                      \
+  case STD_SORT_ASC:                                                    \
+    __STD_SORTED_LOOP(cur < prev);                                      \
+    break;                                                              \
+  case STD_SORT_DESC:                                                   \
+    __STD_SORTED_LOOP(cur > prev);                                      \
+    break;                                                              \
+  case STD_SORT_ASC_STRICT:                                             \
+    __STD_SORTED_LOOP(!(prev < cur));                                   \
+    break;                                                              \
+  case STD_SORT_DESC_STRICT:                                            \
+    __STD_SORTED_LOOP(!(prev > cur));                                   \
+    break;                                                              \
+  }
+
+#define __STD_SORTED_BLOCK 64
+
+#define __STD_SORTED_LOOP(FAIL)                                         \
+  for (; i+__STD_SORTED_BLOCK <= len; i += __STD_SORTED_BLOCK) {        \
+    int bad = 0;                                                        \
+    for (size_t j = i; j < i+__STD_SORTED_BLOCK; ++j) {                 \
+      __typeof__(*arr) cur = arr[j], prev = arr[j-1];                   \
+      bad |= FAIL;                                                      \
+    }                                                                   \
+    if (bad) {                                                          \
+      break;                                                            \
+    }                                                                   \
+  }
+
+#define __STD_SORTED_ANY128(m) (!_mm_testz_si128((__m128i)(m), (__m128i)(m)))
+#define __STD_SORTED_ANY256(m) (!_mm256_testz_si256((__m256i)(m), (__m256i)(m)))
+
+#ifdef __STD_X86
+// Private: the vector loops of the SSE and AVX2
+// kernels. `cur` holds arr[i..i+lanes) and `prev` the
+// same lanes shifted back by one element, so each lane
+// compares a neighbour pair. `FAIL` is a lane-wise mask
+// written on them, and `ANY` tests it. The first loop
+// ORs the masks of 4 vectors before testing them. The
+// scalar loop then finds the exact index, starting at
+// the vectors that failed.
+#define __STD_SORTED_VLOOP(FAIL, ANY)                                   \
+  for (; i+4*lanes <= len; i += 4*lanes) {                              \
+    __m bad = {0};                                                      \
+    for (size_t k = i; k < i+4*lanes; k += lanes) {                     \
+      (void)memcpy(&cur, arr+k, sizeof(__v));                           \
+      (void)memcpy(&prev, arr+k-1, sizeof(__v));                        \
+      bad |= (__m)(FAIL);                                               \
+    }                                                                   \
+    if (ANY(bad)) {                                                     \
+      break;                                                            \
+    }                                                                   \
+  }                                                                     \
+  for (; i+lanes <= len; i += lanes) {                                  \
+    (void)memcpy(&cur, arr+i, sizeof(__v));                             \
+    (void)memcpy(&prev, arr+i-1, sizeof(__v));                          \
+    if (ANY(FAIL)) {                                                    \
+      break;                                                            \
+    }                                                                   \
+  }
+
+#define __STD_SORTED_KERNEL(sfx, type, itype, kern, isa, vbytes, ANY)   \
+  __attribute__((target(isa))) size_t                                   \
+  __std_is_sorted_until_##sfx##_##kern(const type *arr, size_t len, StdSortOrder order) \
+  {                                                                     \
+    typedef type __v __attribute__((vector_size(vbytes)));              \
+    typedef itype __m __attribute__((vector_size(vbytes)));             \
+    const size_t lanes = (vbytes)/sizeof(type);                         \
+    __v cur, prev;                                                      \
+    size_t i = 1;                                                       \
+    switch (order) {                                                    \
+    case STD_SORT_ASC:                                                  \
+      __STD_SORTED_VLOOP(cur < prev, ANY);                              \
+      break;                                                            \
+    case STD_SORT_DESC:                                                 \
+      __STD_SORTED_VLOOP(cur > prev, ANY);                              \
+      break;                                                            \
+    case STD_SORT_ASC_STRICT:                                           \
+      __STD_SORTED_VLOOP(~(prev < cur), ANY);                           \
+      break;                                                            \
+    case STD_SORT_DESC_STRICT:                                          \
+      __STD_SORTED_VLOOP(~(prev > cur), ANY);                           \
+      break;                                                            \
+    }                                                                   \
+    return __std_is_sorted_until_##sfx##_scalar(arr, len, order, i);    \
+  }
+
+#define __STD_SORTED_SIMD(sfx, type, itype)                             \
+  __STD_SORTED_KERNEL(sfx, type, itype, sse, "sse4.2", 16, __STD_SORTED_ANY128) \
+  __STD_SORTED_KERNEL(sfx, type, itype, avx2, "avx2", 32, __STD_SORTED_ANY256)
+#define __STD_SORTED_DISPATCH(sfx)                                      \
+  if (__builtin_cpu_supports("avx2")) {                                 \
+    return __std_is_sorted_until_##sfx##_avx2(arr, len, order);         \
+  }                                                                     \
+  if (__builtin_cpu_supports("sse4.2")) {                               \
+    return __std_is_sorted_until_##sfx##_sse(arr, len, order);          \
+  }
+#else
+#define __STD_SORTED_SIMD(sfx, type, itype)
+#define __STD_SORTED_DISPATCH(sfx)
+#endif // __STD_X86
+
+// Private: generates the scalar, SSE and AVX2
+// kernels and the public functions for one type.
+// `itype` is the signed integer of the same size, for
+// masks.
+#define __STD_SORTED_DECL(sfx, type, itype)                             \
+  size_t                                                                \
+  __std_is_sorted_until_##sfx##_scalar(const type *arr, size_t len,     \
+                                        StdSortOrder order, size_t i)   \
+  {                                                                     \
+    for (; i < len; ++i) {                                              \
+      type cur = arr[i], prev = arr[i-1];                               \
+      if ((order == STD_SORT_ASC && cur < prev)                         \
+          || (order == STD_SORT_DESC && cur > prev)                     \
+          || (order == STD_SORT_ASC_STRICT && !(prev < cur))            \
+          || (order == STD_SORT_DESC_STRICT && !(prev > cur))) {        \
+        return i;                                                       \
+      }                                                                 \
+    }                                                                   \
+    return len;                                                         \
+  }                                                                     \
+                                                                        \
+  __STD_SORTED_SIMD(sfx, type, itype)                                   \
+                                                                        \
+  size_t                                                                \
+  std_is_sorted_until_##sfx(const type *arr, size_t len, StdSortOrder order) \
+  {                                                                     \
+    if (len < 2) {                                                      \
+      return len;                                                       \
+    }                                                                   \
+    __STD_SORTED_DISPATCH(sfx);                                         \
+    size_t i = 1;                                                       \
+    __STD_SORTED_LOOPS;                                                 \
+    return __std_is_sorted_until_##sfx##_scalar(arr, len, order, i);    \
+  }                                                                     \
+                                                                        \
+  int                                                                   \
+  std_is_sorted_##sfx(const type *arr, size_t len, StdSortOrder order)  \
+  {                                                                     \
+    return std_is_sorted_until_##sfx(arr, len, order) == len;           \
+  }
+
+// Typed is_sorted checks, picking AVX2 or SSE4.2 kernels at
+// runtime when the CPU has them. std_is_sorted_until_<type>
+// returns the index of the first element that breaks
+// `order` with the one before it, or `len` if none does,
+// which matches std_is_sorted_until. For floating point,
+// a NaN breaks the strict orders but not the others,
+// since every comparison with it is false.
+// Example usage:
+//   size_t i = std_is_sorted_until_i32(arr, len, STD_SORT_ASC);
+//   int ok = std_is_sorted_f64(arr, len, STD_SORT_DESC_STRICT);
+__STD_SORTED_DECL(i32, int32_t, int32_t)
+__STD_SORTED_DECL(u32, uint32_t, int32_t)
+__STD_SORTED_DECL(i64, int64_t, int64_t)
+__STD_SORTED_DECL(u64, uint64_t, int64_t)
+__STD_SORTED_DECL(f32, float, int32_t)
+__STD_SORTED_DECL(f64, double, int64_t)
+
+// A function that folds `x` into `acc`, e.g. acc += x.
+typedef void (*StdReduceFunc)(void *acc, const void *x);
+
+// Folds every element of `arr` into `acc`, in order.
+// `acc` holds the initial value and gets the result.
+// Example usage:
+//   double total = 0;
+//   std_reduce(arr, sizeof(double), len, &total, add_double);
+void
+std_reduce(const void *arr, size_t stride, size_t len, void *acc, StdReduceFunc op)
+{
+  for (size_t i = 0; i < len; ++i) {
+    op(acc, (const char *)arr+i*stride);
+  }
+}
+
+// Sets out[i] to in[0] folded with in[1] up to in[i].
+// `in` and `out` may be the same array.
+void
+std_inclusive_scan(const void *in, void *out, size_t stride, size_t len, StdReduceFunc op)
+{
+  if (len == 0) {
+    return;
+  }
+  char x[stride];
+  (void)memmove(out, in, stride);
+  for (size_t i = 1; i < len; ++i) {
+    char *cur = (char *)out+i*stride;
+    (void)memcpy(x, (const char *)in+i*stride, stride);
+    (void)memcpy(cur, cur-stride, stride);
+    op(cur, x);
+  }
+}
+
+// Sets out[i] to `init` folded with in[0] up to in[i-1],
+// so out[0] is `init`. `in` and `out` may be the same
+// array.
+void
+std_exclusive_scan(const void *in, void *out, size_t stride, size_t len, const void *init,
+                   StdReduceFunc op)
+{
+  char acc[stride], x[stride];
+  (void)memcpy(acc, init, stride);
+  for (size_t i = 0; i < len; ++i) {
+    (void)memcpy(x, (const char *)in+i*stride, stride);
+    (void)memcpy((char *)out+i*stride, acc, stride);
+    op(acc, x);
+  }
+}
+
+// Sets `min` and `max` to the indices of the first
+// smallest and the first largest element of `arr`.
+// Returns 0 if `arr` is empty, 1 otherwise.
+int
+std_minmax(const void *arr, size_t stride, size_t len, CompareFunction compare,
+           size_t *min, size_t *max)
+{
+  if (len == 0) {
+    return 0;
+  }
+  const char *a = arr;
+  size_t lo = 0, hi = 0;
+  for (size_t i = 1; i < len; ++i) {
+    if (compare(a+i*stride, a+lo*stride) < 0) {
+      lo = i;
+    }
+    if (compare(a+i*stride, a+hi*stride) > 0) {
+      hi = i;
+    }
+  }
+  *min = lo;
+  *max = hi;
+  return 1;
+}
+
+// Private: the vector loops of the typed reductions and
+// scans, for vectors of `vbytes` bytes. Sums are done in
+// `atype`, which is unsigned for integers so they wrap
+// around instead of overflowing. `itype` is the signed
+// integer of the same size, for masks. A scan adds up
+// each vector in log2(lanes) shifted adds and then adds
+// the carry from the vectors before it.
+#define __STD_NUMERIC_SIMD(sfx, type, atype, itype, kern, isa, vbytes, ANY) \
+  __attribute__((target(isa))) atype                                    \
+  __std_sum_##sfx##_##kern(const type *arr, size_t len)                 \
+  {                                                                     \
+    typedef atype __v __attribute__((vector_size(vbytes)));             \
+    const size_t lanes = (vbytes)/sizeof(type);                         \
+    __v a0 = {0}, a1 = {0}, a2 = {0}, a3 = {0}, x0, x1, x2, x3;         \
+    size_t i = 0;                                                       \
+    for (; i+4*lanes <= len; i += 4*lanes) {                            \
+      (void)memcpy(&x0, arr+i, sizeof(__v));                            \
+      (void)memcpy(&x1, arr+i+lanes, sizeof(__v));                      \
+      (void)memcpy(&x2, arr+i+2*lanes, sizeof(__v));                    \
+      (void)memcpy(&x3, arr+i+3*lanes, sizeof(__v));                    \
+      a0 += x0;                                                         \
+      a1 += x1;                                                         \
+      a2 += x2;                                                         \
+      a3 += x3;                                                         \
+    }                                                                   \
+    a0 = (a0+a1)+(a2+a3);                                               \
+    atype acc = 0;                                                      \
+    for (size_t k = 0; k < lanes; ++k) {                                \
+      acc += a0[k];                                                     \
+    }                                                                   \
+    return __std_sum_##sfx##_scalar(arr+i, len-i, acc);                 \
+  }                                                                     \
+                                                                        \
+  __attribute__((target(isa))) type                                     \
+  __std_minmax_##sfx##_##kern(const type *arr, size_t len, type lo, type *hi) \
+  {                                                                     \
+    typedef type __v __attribute__((vector_size(vbytes)));              \
+    typedef itype __m __attribute__((vector_size(vbytes)));             \
+    const size_t lanes = (vbytes)/sizeof(type);                         \
+    __v mn = (__v){0}+lo, mx = (__v){0}+*hi, x;                         \
+    size_t i = 0;                                                       \
+    for (; i+lanes <= len; i += lanes) {                                \
+      (void)memcpy(&x, arr+i, sizeof(__v));                             \
+      __m lt = (__m)(x < mn), gt = (__m)(x > mx);                       \
+      mn = (__v)(((__m)x & lt) | ((__m)mn & ~lt));                      \
+      mx = (__v)(((__m)x & gt) | ((__m)mx & ~gt));                      \
+    }                                                                   \
+    for (size_t k = 0; k < lanes; ++k) {                                \
+      lo = mn[k] < lo ? mn[k] : lo;                                     \
+      *hi = mx[k] > *hi ? mx[k] : *hi;                                  \
+    }                                                                   \
+    return __std_minmax_##sfx##_scalar(arr+i, len-i, lo, hi);           \
+  }                                                                     \
+                                                                        \
+  __attribute__((target(isa))) size_t                                   \
+  __std_find_##sfx##_##kern(const type *arr, size_t len, type value)    \
+  {                                                                     \
+    typedef type __v __attribute__((vector_size(vbytes)));              \
+    const size_t lanes = (vbytes)/sizeof(type);                         \
+    __v x;                                                              \
+    size_t i = 0;                                                       \
+    for (; i+lanes <= len; i += lanes) {                                \
+      (void)memcpy(&x, arr+i, sizeof(__v));                             \
+      if (ANY(x == value)) {                                            \
+        break;                                                          \
+      }                                                                 \
+    }                                                                   \
+    return i+__std_find_##sfx##_scalar(arr+i, len-i, value);            \
+  }                                                                     \
+                                                                        \
+  __attribute__((target(isa))) atype                                    \
+  __std_scan_##sfx##_##kern(const type *in, type *out, size_t len, atype carry, int exclusive) \
+  {                                                                     \
+    typedef atype __v __attribute__((vector_size(vbytes)));             \
+    typedef itype __m __attribute__((vector_size(vbytes)));             \
+    const size_t lanes = (vbytes)/sizeof(type);                         \
+    const __v zero = {0};                                               \
+    __m shift[3], last;                                                 \
+    for (size_t s = 0; (1u << s) < lanes; ++s) {                        \
+      for (size_t k = 0; k < lanes; ++k) {                              \
+        shift[s][k] = k >= (1u << s) ? (itype)(k-(1u << s)) : (itype)lanes; \
+      }                                                                 \
+    }                                                                   \
+    for (size_t k = 0; k < lanes; ++k) {                                \
+      last[k] = (itype)lanes-1;                                         \
+    }                                                                   \
+    __v c = zero+carry, x, o;                                           \
+    size_t i = 0;                                                       \
+    for (; i+lanes <= len; i += lanes) {                                \
+      (void)memcpy(&x, in+i, sizeof(__v));                              \
+      for (size_t s = 0; (1u << s) < lanes; ++s) {                      \
+        x += __builtin_shuffle(x, zero, shift[s]);                      \
+      }                                                                 \
+      if (exclusive) {                                                  \
+        o = __builtin_shuffle(x, zero, shift[0])+c;                     \
+      } else {                                                          \
+        o = x+c;                                                        \
+      }                                                                 \
+      (void)memcpy(out+i, &o, sizeof(__v));                             \
+      c = __builtin_shuffle(x+c, last);                                 \
+    }                                                                   \
+    return __std_scan_##sfx##_scalar(in+i, out+i, len-i, c[0], exclusive); \
+  }
+
+#ifdef __STD_X86
+#define __STD_NUMERIC_KERNELS(sfx, type, atype, itype)                  \
+  __STD_NUMERIC_SIMD(sfx, type, atype, itype, sse, "sse4.2", 16, __STD_SORTED_ANY128) \
+  __STD_NUMERIC_SIMD(sfx, type, atype, itype, avx2, "avx2", 32, __STD_SORTED_ANY256)
+#define __STD_NUMERIC_DISPATCH(fn, ...)                                 \
+  if (__builtin_cpu_supports("avx2")) {                                 \
+    return fn##_avx2(__VA_ARGS__);                                      \
+  }                                                                     \
+  if (__builtin_cpu_supports("sse4.2")) {                               \
+    return fn##_sse(__VA_ARGS__);                                       \
+  }
+#else
+#define __STD_NUMERIC_KERNELS(sfx, type, atype, itype)
+#define __STD_NUMERIC_DISPATCH(fn, ...)
+#endif // __STD_X86
+
+// Private: generates the scalar kernels, the SIMD ones,
+// the private dispatchers and the public functions of
+// the typed reductions and scans for one type.
+#define __STD_NUMERIC_DECL(sfx, type, atype, itype, tmin, tmax)         \
+  atype                                                                 \
+  __std_sum_##sfx##_scalar(const type *arr, size_t len, atype acc)      \
+  {                                                                     \
+    for (size_t i = 0; i < len; ++i) {                                  \
+      acc += (atype)arr[i];                                             \
+    }                                                                   \
+    return acc;                                                         \
+  }                                                                     \
+                                                                        \
+  type                                                                  \
+  __std_minmax_##sfx##_scalar(const type *arr, size_t len, type lo, type *hi) \
+  {                                                                     \
+    for (size_t i = 0; i < len; ++i) {                                  \
+      lo = arr[i] < lo ? arr[i] : lo;                                   \
+      *hi = arr[i] > *hi ? arr[i] : *hi;                                \
+    }                                                                   \
+    return lo;                                                          \
+  }                                                                     \
+                                                                        \
+  size_t                                                                \
+  __std_find_##sfx##_scalar(const type *arr, size_t len, type value)    \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    while (i < len && arr[i] != value) {                                \
+      i += 1;                                                           \
+    }                                                                   \
+    return i;                                                           \
+  }                                                                     \
+                                                                        \
+  atype                                                                 \
+  __std_scan_##sfx##_scalar(const type *in, type *out, size_t len, atype carry, \
+                            int exclusive)                              \
+  {                                                                     \
+    for (size_t i = 0; i < len; ++i) {                                  \
+      atype x = (atype)in[i];                                           \
+      if (exclusive) {                                                  \
+        out[i] = (type)carry;                                           \
+        carry += x;                                                     \
+      } else {                                                          \
+        carry += x;                                                     \
+        out[i] = (type)carry;                                           \
+      }                                                                 \
+    }                                                                   \
+    return carry;                                                       \
+  }                                                                     \
+                                                                        \
+  __STD_NUMERIC_KERNELS(sfx, type, atype, itype)                        \
+                                                                        \
+  atype                                                                 \
+  __std_sum_##sfx(const type *arr, size_t len)                          \
+  {                                                                     \
+    __STD_NUMERIC_DISPATCH(__std_sum_##sfx, arr, len);                  \
+    return __std_sum_##sfx##_scalar(arr, len, 0);                       \
+  }                                                                     \
+                                                                        \
+  type                                                                  \
+  __std_minmax_##sfx(const type *arr, size_t len, type *hi)             \
+  {                                                                     \
+    *hi = tmin;                                                         \
+    __STD_NUMERIC_DISPATCH(__std_minmax_##sfx, arr, len, tmax, hi);     \
+    return __std_minmax_##sfx##_scalar(arr, len, tmax, hi);             \
+  }                                                                     \
+                                                                        \
+  size_t                                                                \
+  __std_find_##sfx(const type *arr, size_t len, type value)             \
+  {                                                                     \
+    __STD_NUMERIC_DISPATCH(__std_find_##sfx, arr, len, value);          \
+    return __std_find_##sfx##_scalar(arr, len, value);                  \
+  }                                                                     \
+                                                                        \
+  atype                                                                 \
+  __std_scan_##sfx(const type *in, type *out, size_t len, atype carry, int exclusive) \
+  {                                                                     \
+    __STD_NUMERIC_DISPATCH(__std_scan_##sfx, in, out, len, carry, exclusive); \
+    return __std_scan_##sfx##_scalar(in, out, len, carry, exclusive);   \
+  }                                                                     \
+                                                                        \
+  type                                                                  \
+  std_reduce_sum_##sfx(const type *arr, size_t len)                     \
+  {                                                                     \
+    return (type)__std_sum_##sfx(arr, len);                             \
+  }                                                                     \
+                                                                        \
+  int                                                                   \
+  std_minmax_##sfx(const type *arr, size_t len, size_t *min, size_t *max) \
+  {                                                                     \
+    type hi, lo = __std_minmax_##sfx(arr, len, &hi);                    \
+    size_t at = __std_find_##sfx(arr, len, lo);                         \
+    if (at == len) {                                                    \
+      return 0;                                                         \
+    }                                                                   \
+    *min = at;                                                          \
+    *max = __std_find_##sfx(arr, len, hi);                              \
+    return 1;                                                           \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  std_inclusive_scan_##sfx(const type *in, type *out, size_t len)       \
+  {                                                                     \
+    (void)__std_scan_##sfx(in, out, len, 0, 0);                         \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  std_exclusive_scan_##sfx(const type *in, type *out, size_t len, type init) \
+  {                                                                     \
+    (void)__std_scan_##sfx(in, out, len, (atype)init, 1);               \
+  }
+
+// Typed sums, minmax and prefix sums, with AVX2 or SSE4.2
+// kernels picked at runtime when the CPU has them:
+//   std_reduce_sum_<type>(arr, len)          the sum of `arr`
+//   std_minmax_<type>(arr, len, &min, &max)  indices of the first
+//                                            smallest and largest,
+//                                            0 if there are none
+//   std_inclusive_scan_<type>(in, out, len)  out[i] = in[0]+...+in[i]
+//   std_exclusive_scan_<type>(in, out, len, init)
+//                                            out[i] = init+in[0]+...+in[i-1]
+// `in` and `out` may be the same array. Integer sums wrap
+// around. Floating point sums are added in a different
+// order than a plain loop, a lane at a time, so they may
+// differ in the last bits. std_minmax skips NaNs. For
+// other types, STD_ORD_ALGO_DECL generates
+// stdminmax_element_<type> with the same results.
+// Example usage:
+//   double total = std_reduce_sum_f64(prices, n);
+//   std_exclusive_scan_i64(counts, offsets, n, 0);
+__STD_NUMERIC_DECL(i32, int32_t, uint32_t, int32_t, INT32_MIN, INT32_MAX)
+__STD_NUMERIC_DECL(i64, int64_t, uint64_t, int64_t, INT64_MIN, INT64_MAX)
+__STD_NUMERIC_DECL(f32, float, float, int32_t, -__builtin_inff(), __builtin_inff())
+__STD_NUMERIC_DECL(f64, double, double, int64_t, -__builtin_inf(), __builtin_inf())
+
+// Private: generates the typed binary searches for one
+// type. Each step adds 0 or `half` to the start of the
+// range, which compiles to a conditional move, and
+// prefetches the middle of both halves it may go to
+// next, so the load of the next step is already on its
+// way whichever way the comparison goes.
+#define __STD_BOUND_DECL(sfx, type)                                     \
+  size_t                                                                \
+  std_lower_bound_##sfx(const type *arr, size_t len, type key)          \
+  {                                                                     \
+    if (len == 0) {                                                     \
+      return 0;                                                         \
+    }                                                                   \
+    const type *base = arr;                                             \
+    while (len > 1) {                                                   \
+      size_t half = len/2;                                              \
+      __builtin_prefetch(base+half/2);                                  \
+      __builtin_prefetch(base+half+half/2);                             \
+      base += (base[half] < key)*half;                                  \
+      len -= half;                                                      \
+    }                                                                   \
+    return (size_t)(base-arr)+(*base < key);                            \
+  }                                                                     \
+                                                                        \
+  size_t                                                                \
+  std_upper_bound_##sfx(const type *arr, size_t len, type key)          \
+  {                                                                     \
+    if (len == 0) {                                                     \
+      return 0;                                                         \
+    }                                                                   \
+    const type *base = arr;                                             \
+    while (len > 1) {                                                   \
+      size_t half = len/2;                                              \
+      __builtin_prefetch(base+half/2);                                  \
+      __builtin_prefetch(base+half+half/2);                             \
+      base += !(key < base[half])*half;                                 \
+      len -= half;                                                      \
+    }                                                                   \
+    return (size_t)(base-arr)+!(key < *base);                           \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  std_equal_range_##sfx(const type *arr, size_t len, type key, size_t *lo, size_t *hi) \
+  {                                                                     \
+    *lo = std_lower_bound_##sfx(arr, len, key);                         \
+    *hi = *lo+std_upper_bound_##sfx(arr+*lo, len-*lo, key);             \
+  }
+
+// Branchless binary searches over sorted arrays, which
+// return indices instead of pointers:
+//   std_lower_bound_<type>(arr, len, key)  first index not less than `key`
+//   std_upper_bound_<type>(arr, len, key)  first index greater than `key`
+//   std_equal_range_<type>(arr, len, key, &lo, &hi)
+// `len` if there is no such element. Float arrays must
+// not hold NaNs.
+// Example usage:
+//   size_t i = std_upper_bound_u64(starts, n, addr)-1;
+__STD_BOUND_DECL(i32, int32_t)
+__STD_BOUND_DECL(u32, uint32_t)
+__STD_BOUND_DECL(i64, int64_t)
+__STD_BOUND_DECL(u64, uint64_t)
+__STD_BOUND_DECL(f32, float)
+__STD_BOUND_DECL(f64, double)
+
+// How many elements the generated algorithms check
+// before they look at whether they can stop early.
+// Checking a whole block without branching lets the
+// compiler vectorize the loop.
+#define __STD_ALGO_BLOCK 64
+
+// Generates typed versions of stdall_of, stdany_of and
+// stdnone_of, plus count_if and find_if, for arrays of
+// `type` and the predicate `pred`, which must take a
+// `type` by value and return int. Since `pred` is called
+// directly it can be inlined, and the loops vectorized.
+// Both `type` and `pred` must be plain identifiers.
+// Example usage:
+//   static inline int is_positive(int x) { return x > 0; }
+//   STD_ALGO_DECL(int, is_positive);
+//   stdall_of_is_positive(arr, len);
+//   stdcount_if_is_positive(arr, len);
+#define STD_ALGO_DECL(type, pred)                                       \
+  static inline size_t                                                  \
+  stdfind_if_##pred(const type *arr, size_t len)                        \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i+__STD_ALGO_BLOCK <= len; i += __STD_ALGO_BLOCK) {          \
+      int any = 0;                                                      \
+      for (size_t j = i; j < i+__STD_ALGO_BLOCK; ++j) {                 \
+        any |= !!pred(arr[j]);                                          \
+      }                                                                 \
+      if (any) {                                                        \
+        break;                                                          \
+      }                                                                 \
+    }                                                                   \
+    for (; i < len; ++i) {                                              \
+      if (pred(arr[i])) {                                               \
+        return i;                                                       \
+      }                                                                 \
+    }                                                                   \
+    return len;                                                         \
+  }                                                                     \
+                                                                        \
+  static inline size_t                                                  \
+  stdcount_if_##pred(const type *arr, size_t len)                       \
+  {                                                                     \
+    size_t count = 0;                                                   \
+    for (size_t i = 0; i < len; ++i) {                                  \
+      count += !!pred(arr[i]);                                          \
+    }                                                                   \
+    return count;                                                       \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  stdall_of_##pred(const type *arr, size_t len)                         \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i+__STD_ALGO_BLOCK <= len; i += __STD_ALGO_BLOCK) {          \
+      int all = 1;                                                      \
+      for (size_t j = i; j < i+__STD_ALGO_BLOCK; ++j) {                 \
+        all &= !!pred(arr[j]);                                          \
+      }                                                                 \
+      if (!all) {                                                       \
+        return 0;                                                       \
+      }                                                                 \
+    }                                                                   \
+    for (; i < len; ++i) {                                              \
+      if (!pred(arr[i])) {                                              \
+        return 0;                                                       \
+      }                                                                 \
+    }                                                                   \
+    return 1;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  stdany_of_##pred(const type *arr, size_t len)                         \
+  {                                                                     \
+    return stdfind_if_##pred(arr, len) != len;                          \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  stdnone_of_##pred(const type *arr, size_t len)                        \
+  {                                                                     \
+    return stdfind_if_##pred(arr, len) == len;                          \
+  }
+
+// Generates typed versions of the algorithms that only
+// need `<` on `type`: min/max element (as an index),
+// minmax element (as the indices of the first min and
+// max, returning 0 if `len` is 0, like std_minmax) and
+// is_sorted_until (as the index of the first element that
+// is less than the one before it, or `len`, like
+// std_is_sorted_until). min/max element find the value
+// first and then its first index, which both vectorize.
+// `type` must be a plain identifier.
+// Example usage:
+//   STD_ORD_ALGO_DECL(int);
+//   size_t i = stdmin_element_int(arr, len);
+//   int sorted = stdis_sorted_until_int(arr, len) == len;
+#define STD_ORD_ALGO_DECL(type)                                         \
+  static inline size_t                                                  \
+  __stdfind_eq_##type(const type *arr, size_t len, type value)          \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i+__STD_ALGO_BLOCK <= len; i += __STD_ALGO_BLOCK) {          \
+      int any = 0;                                                      \
+      for (size_t j = i; j < i+__STD_ALGO_BLOCK; ++j) {                 \
+        any |= arr[j] == value;                                         \
+      }                                                                 \
+      if (any) {                                                        \
+        break;                                                          \
+      }                                                                 \
+    }                                                                   \
+    for (; i < len; ++i) {                                              \
+      if (arr[i] == value) {                                            \
+        return i;                                                       \
+      }                                                                 \
+    }                                                                   \
+    return len;                                                         \
+  }                                                                     \
+                                                                        \
+  static inline void                                                    \
+  __stdminmax_##type(const type *arr, size_t len, type *min, type *max) \
+  {                                                                     \
+    type lo = arr[0], hi = arr[0];                                      \
+    for (size_t i = 1; i < len; ++i) {                                  \
+      lo = arr[i] < lo ? arr[i] : lo;                                   \
+      hi = hi < arr[i] ? arr[i] : hi;                                   \
+    }                                                                   \
+    *min = lo;                                                          \
+    *max = hi;                                                          \
+  }                                                                     \
+                                                                        \
+  static inline size_t                                                  \
+  stdmin_element_##type(const type *arr, size_t len)                    \
+  {                                                                     \
+    if (len == 0) {                                                     \
+      return 0;                                                         \
+    }                                                                   \
+    type lo, hi;                                                        \
+    __stdminmax_##type(arr, len, &lo, &hi);                             \
+    size_t i = __stdfind_eq_##type(arr, len, lo);                       \
+    return i == len ? 0 : i;                                            \
+  }                                                                     \
+                                                                        \
+  static inline size_t                                                  \
+  stdmax_element_##type(const type *arr, size_t len)                    \
+  {                                                                     \
+    if (len == 0) {                                                     \
+      return 0;                                                         \
+    }                                                                   \
+    type lo, hi;                                                        \
+    __stdminmax_##type(arr, len, &lo, &hi);                             \
+    size_t i = __stdfind_eq_##type(arr, len, hi);                       \
+    return i == len ? 0 : i;                                            \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  stdminmax_element_##type(const type *arr, size_t len, size_t *min, size_t *max) \
+  {                                                                     \
+    if (len == 0) {                                                     \
+      return 0;                                                         \
+    }                                                                   \
+    type lo, hi;                                                        \
+    __stdminmax_##type(arr, len, &lo, &hi);                             \
+    size_t i = __stdfind_eq_##type(arr, len, lo);                       \
+    *min = i == len ? 0 : i;                                            \
+    i = __stdfind_eq_##type(arr, len, hi);                              \
+    *max = i == len ? 0 : i;                                            \
+    return 1;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline size_t                                                  \
+  stdis_sorted_until_##type(const type *arr, size_t len)                \
+  {                                                                     \
+    size_t i = 1;                                                       \
+    for (; i+__STD_ALGO_BLOCK <= len; i += __STD_ALGO_BLOCK) {          \
+      int bad = 0;                                                      \
+      for (size_t j = i; j < i+__STD_ALGO_BLOCK; ++j) {                 \
+        bad |= arr[j] < arr[j-1];                                       \
+      }                                                                 \
+      if (bad) {                                                        \
+        break;                                                          \
+      }                                                                 \
+    }                                                                   \
+    for (; i < len; ++i) {                                              \
+      if (arr[i] < arr[i-1]) {                                          \
+        return i;                                                       \
+      }                                                                 \
+    }                                                                   \
+    return len;                                                         \
+  }
+
+
+
+#endif // STDFUNCS_IMPL
+
+//////////////////////////////
+// StdStack IMPLEMENTATION
+#ifdef STDSTACK_IMPL
+
+// Elements per chunk for segmented stacks
+// created with chunk_len = 0.
+#define __STDSTACK_CHUNK_BYTES (64*1024)
+
+// Private: a chunk of a segmented stack.
+struct __StdStackChunk
+{
+  struct __StdStackChunk *prev;
+  size_t len;
+  _Alignas(max_align_t) char data[];
+};
+
+// A stack is contiguous when created with stdstack_new
+// and grows with realloc(). When created with
+// stdstack_new_segmented, it is a chain of fixed-size
+// chunks instead, so pointers from stdstack_peek stay
+// valid until that element is popped and growing never
+// copies. `chunk` is the top chunk and `spare` is an
+// emptied chunk kept to be reused by the next push so
+// push/pop at a chunk boundary does not hit malloc().
+struct StdStack
+{
+  void *data;
+  size_t stride;
+  size_t len;
+  size_t cap;
+  struct __StdStackChunk *chunk;
+  struct __StdStackChunk *spare;
+  size_t chunk_len;
+  const StdAllocator *alloc;  // NULL for malloc()
+};
+typedef struct StdStack StdStack;
+
+// Create a new StdStack with element
+// size being `stride`.
+StdStack
+stdstack_new(size_t stride)
+{
+  StdStack stack;
+  stack.data      = __STD_A_ALLOC(NULL, stride);
+  stack.cap       = 1;
+  stack.len       = 0;
+  stack.stride    = stride;
+  stack.chunk     = NULL;
+  stack.spare     = NULL;
+  stack.chunk_len = 0;
+  stack.alloc     = NULL;
+  return stack;
+}
+
+// Same as stdstack_new, allocating
+// through `alloc` instead of malloc().
+StdStack
+stdstack_new_alloc(size_t stride, const StdAllocator *alloc)
+{
+  StdStack stack = {0};
+  stack.data      = __STD_A_ALLOC(alloc, stride);
+  stack.cap       = 1;
+  stack.stride    = stride;
+  stack.alloc     = alloc;
+  return stack;
+}
+
+// Private: bytes of one chunk of `stack`.
+size_t
+__stdstack_chunk_bytes(StdStack *stack)
+{
+  return sizeof(struct __StdStackChunk)+stack->chunk_len*stack->stride;
+}
+
+// Private: allocates an empty chunk.
+struct __StdStackChunk *
+__stdstack_chunk_new(StdStack *stack)
+{
+  struct __StdStackChunk *chunk = __STD_A_ALLOC(stack->alloc, __stdstack_chunk_bytes(stack));
+  chunk->prev = NULL;
+  chunk->len = 0;
+  return chunk;
+}
+
+// Same as stdstack_new_segmented, allocating
+// chunks through `alloc` instead of malloc().
+StdStack
+stdstack_new_segmented_alloc(size_t stride, size_t chunk_len, const StdAllocator *alloc)
+{
+  StdStack stack;
+  if (chunk_len == 0) {
+    chunk_len = stride >= __STDSTACK_CHUNK_BYTES ? 1 : __STDSTACK_CHUNK_BYTES/stride;
+  }
+  stack.data      = NULL;
+  stack.len       = 0;
+  stack.stride    = stride;
+  stack.chunk_len = chunk_len;
+  stack.spare     = NULL;
+  stack.alloc     = alloc;
+  stack.chunk     = __stdstack_chunk_new(&stack);
+  stack.cap       = chunk_len;
+  return stack;
+}
+
+// Create a new segmented StdStack with element size
+// being `stride`, `chunk_len` elements per chunk.
+// If `chunk_len` is 0, chunks are about 64KiB.
+// Example usage:
+//   StdStack s = stdstack_new_segmented(sizeof(Node), 0);
+//   stdstack_push(&s, &root);
+//   Node *top = stdstack_peek(&s); // stays valid across pushes.
+StdStack
+stdstack_new_segmented(size_t stride, size_t chunk_len)
+{
+  return stdstack_new_segmented_alloc(stride, chunk_len, NULL);
+}
+
+// Free the underlying memory of `stack`.
+void
+stdstack_free(StdStack *stack)
+{
+  if (stack->chunk_len != 0) {
+    __STD_CHECK_MEM(stack->chunk);
+    while (stack->chunk) {
+      struct __StdStackChunk *prev = stack->chunk->prev;
+      __STD_A_FREE(stack->alloc, stack->chunk, __stdstack_chunk_bytes(stack));
+      stack->chunk = prev;
+    }
+    if (stack->spare) {
+      __STD_A_FREE(stack->alloc, stack->spare, __stdstack_chunk_bytes(stack));
+    }
+    stack->spare = NULL;
+    stack->len = stack->cap = stack->stride = stack->chunk_len = 0;
+    return;
+  }
+  __STD_CHECK_MEM(stack->data);
+  __STD_A_FREE(stack->alloc, stack->data, stack->cap*stack->stride);
+  stack->data = NULL;
+  stack->len = stack->cap = stack->stride = 0;
+}
+
+// Returns 1 if stack is empty, 0 otherwise.
+int
+stdstack_empty(StdStack *stack)
+{
+  return stack->len == 0;
+}
+
+// Get the element at the end of `stack`
+// i.e., stack->len-1.
+void *
+stdstack_peek(StdStack *stack)
+{
+  if (stack->len == 0) {
+    return NULL;
+  }
+  if (stack->chunk_len != 0) {
+    return stack->chunk->data+(stack->chunk->len-1)*stack->stride;
+  }
+  return stack->data+(stack->len-1)*stack->stride;
+}
+
+// Private: drops the top chunk once it is emptied,
+// keeping it as the spare if there is none.
+void
+__stdstack_chunk_drop(StdStack *stack)
+{
+  struct __StdStackChunk *top = stack->chunk;
+  if (top->len != 0 || top->prev == NULL) {
+    return;
+  }
+  stack->chunk = top->prev;
+  if (stack->spare == NULL) {
+    stack->spare = top;
+  } else {
+    __STD_A_FREE(stack->alloc, top, __stdstack_chunk_bytes(stack));
+    stack->cap -= stack->chunk_len;
+  }
+}
+
+// Private: makes room for at least one element
+// in the top chunk.
+void
+__stdstack_chunk_reserve(StdStack *stack)
+{
+  if (stack->chunk->len < stack->chunk_len) {
+    return;
+  }
+  struct __StdStackChunk *chunk = stack->spare;
+  if (chunk) {
+    stack->spare = NULL;
+  } else {
+    chunk = __stdstack_chunk_new(stack);
+    stack->cap += stack->chunk_len;
+  }
+  chunk->len = 0;
+  chunk->prev = stack->chunk;
+  stack->chunk = chunk;
+}
+
+// Remove the value at the end of `stack`.
+// Panics if len = 0.
+void
+stdstack_pop(StdStack *stack)
+{
+  if (stack->len == 0) {
+    __STD_PANIC("tried to pop element of a stack but its len = 0");
+  }
+  stack->len--;
+  if (stack->chunk_len != 0) {
+    stack->chunk->len--;
+    __stdstack_chunk_drop(stack);
+  }
+}
+
+// Copy the value at the end of `stack` into
+// `out` and remove it. Returns 0 if `stack`
+// is empty, 1 otherwise.
+// Example usage:
+//   Node n;
+//   while (stdstack_pop_into(&s, &n)) { ... }
+int
+stdstack_pop_into(StdStack *stack, void *out)
+{
+  if (stack->len == 0) {
+    return 0;
+  }
+  (void)memcpy(out, stdstack_peek(stack), stack->stride);
+  stdstack_pop(stack);
+  return 1;
+}
+
+// Push an element into `stack` at the end.
+void
+stdstack_push(StdStack *stack, void *value)
+{
+  if (stack->chunk_len != 0) {
+    __stdstack_chunk_reserve(stack);
+    struct __StdStackChunk *top = stack->chunk;
+    (void)memcpy(top->data+top->len*stack->stride, value, stack->stride);
+    top->len++;
+    stack->len++;
+    return;
+  }
+  __STD_CHECK_MEM(stack->data);
+  __STD_DA_APPEND_A(stack, data, stride, len, cap, alloc, value);
+}
+
+// Push the `n` elements of the array `values`
+// into `stack`, values[n-1] ending up on top.
+void
+stdstack_push_n(StdStack *stack, const void *values, size_t n)
+{
+  const char *src = values;
+  if (stack->chunk_len != 0) {
+    while (n > 0) {
+      __stdstack_chunk_reserve(stack);
+      struct __StdStackChunk *top = stack->chunk;
+      size_t k = stack->chunk_len-top->len;
+      k = k < n ? k : n;
+      (void)memcpy(top->data+top->len*stack->stride, src, k*stack->stride);
+      top->len += k;
+      stack->len += k;
+      src += k*stack->stride;
+      n -= k;
+    }
+    return;
+  }
+  __STD_CHECK_MEM(stack->data);
+  if (stack->len+n > stack->cap) {
+    size_t cap = stack->cap;
+    while (stack->len+n > cap) {
+      cap *= 2;
+    }
+    stack->data = __STD_A_REALLOC(stack->alloc, stack->data,
+                                  stack->cap*stack->stride, cap*stack->stride);
+    __STD_CHECK_MEM(stack->data);
+    stack->cap = cap;
+    __STD_INSTR_WASTE((stack->cap-stack->len-n)*stack->stride);
+  }
+  (void)memcpy(stack->data+stack->len*stack->stride, src, n*stack->stride);
+  stack->len += n;
+}
+
+// Remove up to `n` elements from the end of `stack`
+// and return how many were removed. If `out` is not
+// NULL they are copied into it in the order they were
+// pushed, so a push_n followed by a pop_n of the same
+// count gives back the same array.
+size_t
+stdstack_pop_n(StdStack *stack, void *out, size_t n)
+{
+  n = n < stack->len ? n : stack->len;
+  size_t left = n;
+  if (stack->chunk_len != 0) {
+    while (left > 0) {
+      struct __StdStackChunk *top = stack->chunk;
+      size_t k = top->len < left ? top->len : left;
+      top->len -= k;
+      stack->len -= k;
+      left -= k;
+      if (out) {
+        (void)memcpy((char *)out+left*stack->stride,
+                     top->data+top->len*stack->stride, k*stack->stride);
+      }
+      __stdstack_chunk_drop(stack);
+    }
+    return n;
+  }
+  stack->len -= n;
+  if (out) {
+    (void)memcpy(out, stack->data+stack->len*stack->stride, n*stack->stride);
+  }
+  return n;
+}
+
+#endif // STDSTACK_IMPL
+
+//////////////////////////////
+// StdPair IMPLEMENTATION
+#ifdef STDPAIR_IMPL
+
+struct StdPair
+{
+  void *fst;
+  void *snd;
+};
+typedef struct StdPair StdPair;
+
+// Create a new StdPair.
+StdPair
+stdpair_new(void *fst, void *snd)
+{
+  StdPair pair;
+  memcpy(&pair.fst, &fst, sizeof(fst));
+  memcpy(&pair.snd, &snd, sizeof(snd));
+  return pair;
+}
+
+// Get the first element of `pair`.
+void *
+stdpair_fst(StdPair *pair)
+{
+  return pair->fst;
+}
+
+// Get the second element of `pair`.
+void *
+stdpair_snd(StdPair *pair)
+{
+  return pair->snd;
+}
+
+// Private: hash one member. Floats are hashed by value
+// with -0.0 turned into 0.0, since the two compare equal
+// with `==`. Long doubles go through double, which keeps
+// equal values equal and skips their padding bytes.
+static inline uint64_t
+__std_hash_member_f32(const void *p, size_t len, uint64_t seed)
+{
+  float x;
+  (void)memcpy(&x, p, sizeof(x));
+  x += 0.0f;
+  (void)len;
+  return __std_hash_bytes(&x, sizeof(x), seed);
+}
+
+static inline uint64_t
+__std_hash_member_f64(const void *p, size_t len, uint64_t seed)
+{
+  double x;
+  (void)memcpy(&x, p, sizeof(x));
+  x += 0.0;
+  (void)len;
+  return __std_hash_bytes(&x, sizeof(x), seed);
+}
+
+static inline uint64_t
+__std_hash_member_lf64(const void *p, size_t len, uint64_t seed)
+{
+  long double x;
+  (void)memcpy(&x, p, sizeof(x));
+  double d = (double)x+0.0;
+  (void)len;
+  return __std_hash_bytes(&d, sizeof(d), seed);
+}
+
+#define __STD_HASH_MEMBER(m, seed)                                      \
+  _Generic((m),                                                         \
+           float: __std_hash_member_f32,                                \
+           double: __std_hash_member_f64,                               \
+           long double: __std_hash_member_lf64,                         \
+           default: __std_hash_bytes)(&(m), sizeof(m), (seed))
+
+// Generates `StdPair_K_V`, a pair holding a `K` and a `V`
+// inline, so arrays of it stay contiguous. Along with it:
+//   stdpair_K_V_new(fst, snd)
+//   stdpair_K_V_cmp(a, b)     lexicographic, a CompareFunction
+//   stdpair_K_V_eq(a, b)
+//   stdpair_K_V_hash(pair, seed)
+// `K` and `V` must be single token type names (use a typedef
+// for `unsigned long` or `char *`) that compare with `<`
+// and `==`. Hashing goes member by member, so padding
+// between them is never read, and float members hash by
+// value, so pairs that are _eq hash the same.
+// Example usage:
+//   STDPAIR_DECL(int, double);
+//   StdPair_int_double arr[2] = {stdpair_int_double_new(2, 1.), {1, 5.}};
+//   qsort(arr, 2, sizeof(*arr), stdpair_int_double_cmp);
+#define STDPAIR_DECL(K, V)                                              \
+  typedef struct                                                        \
+  {                                                                     \
+    K fst;                                                              \
+    V snd;                                                              \
+  } StdPair_##K##_##V;                                                  \
+                                                                        \
+  static inline StdPair_##K##_##V                                       \
+  stdpair_##K##_##V##_new(K fst, V snd)                                 \
+  {                                                                     \
+    StdPair_##K##_##V pair = {fst, snd};                                \
+    return pair;                                                        \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  stdpair_##K##_##V##_cmp(const void *a, const void *b)                 \
+  {                                                                     \
+    const StdPair_##K##_##V *x = a, *y = b;                             \
+    if (x->fst < y->fst) {                                              \
+      return -1;                                                        \
+    }                                                                   \
+    if (y->fst < x->fst) {                                              \
+      return 1;                                                         \
+    }                                                                   \
+    if (x->snd < y->snd) {                                              \
+      return -1;                                                        \
+    }                                                                   \
+    if (y->snd < x->snd) {                                              \
+      return 1;                                                         \
+    }                                                                   \
+    return 0;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  stdpair_##K##_##V##_eq(const StdPair_##K##_##V *x, const StdPair_##K##_##V *y) \
+  {                                                                     \
+    return x->fst == y->fst && x->snd == y->snd;                        \
+  }                                                                     \
+                                                                        \
+  static inline uint64_t                                                \
+  stdpair_##K##_##V##_hash(const StdPair_##K##_##V *pair, uint64_t seed) \
+  {                                                                     \
+    seed = __STD_HASH_MEMBER(pair->fst, seed);                          \
+    return __STD_HASH_MEMBER(pair->snd, seed);                          \
+  }
+
+// Private: the pieces STDTUPLE_DECL is made of.
+#define __STD_TUPLE_COMMA_0
+#define __STD_TUPLE_COMMA_1 ,
+#define __STD_TUPLE_COMMA_2 ,
+#define __STD_TUPLE_COMMA_3 ,
+#define __STD_TUPLE_COMMA_4 ,
+#define __STD_TUPLE_COMMA_5 ,
+#define __STD_TUPLE_COMMA_6 ,
+#define __STD_TUPLE_COMMA_7 ,
+#define __STD_TUPLE_FIELD(c, i, T) T _##i;
+#define __STD_TUPLE_PARAM(c, i, T) __STD_TUPLE_COMMA_##i T _##i
+#define __STD_TUPLE_SET(c, i, T) c._##i = _##i;
+#define __STD_TUPLE_CMP(c, i, T)                \
+  if (x->_##i < y->_##i) {                      \
+    return -1;                                  \
+  }                                             \
+  if (y->_##i < x->_##i) {                      \
+    return 1;                                   \
+  }
+#define __STD_TUPLE_EQ(c, i, T)                 \
+  if (!(x->_##i == y->_##i)) {                  \
+    return 0;                                   \
+  }
+#define __STD_TUPLE_HASH(c, i, T)                               \
+  c = __STD_HASH_MEMBER(tuple->_##i, c);
+
+// Generates the struct `name` holding the given types
+// inline as members `_0`, `_1`, ... (up to 8), plus
+// name_new, name_cmp, name_eq and name_hash that work
+// like the STDPAIR_DECL ones. Members must compare
+// with `<` and `==`.
+// Example usage:
+//   STDTUPLE_DECL(Edge, int, int, float);
+//   Edge e = Edge_new(1, 2, .5f);
+//   qsort(edges, n, sizeof(Edge), Edge_cmp);
+#define STDTUPLE_DECL(name, ...)                                        \
+  typedef struct                                                        \
+  {                                                                     \
+    __STD_FOREACH(__STD_TUPLE_FIELD, _, __VA_ARGS__)                    \
+  } name;                                                               \
+                                                                        \
+  static inline name                                                    \
+  name##_new(__STD_FOREACH(__STD_TUPLE_PARAM, _, __VA_ARGS__))          \
+  {                                                                     \
+    name tuple;                                                         \
+    __STD_FOREACH(__STD_TUPLE_SET, tuple, __VA_ARGS__)                  \
+    return tuple;                                                       \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  name##_cmp(const void *a, const void *b)                              \
+  {                                                                     \
+    const name *x = a, *y = b;                                          \
+    __STD_FOREACH(__STD_TUPLE_CMP, _, __VA_ARGS__)                      \
+    return 0;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline int                                                     \
+  name##_eq(const name *x, const name *y)                               \
+  {                                                                     \
+    __STD_FOREACH(__STD_TUPLE_EQ, _, __VA_ARGS__)                       \
+    return 1;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline uint64_t                                                \
+  name##_hash(const name *tuple, uint64_t seed)                         \
+  {                                                                     \
+    __STD_FOREACH(__STD_TUPLE_HASH, seed, __VA_ARGS__)                  \
+    return seed;                                                        \
+  }
+
+#endif // STDPAIR_IMPL
+
+//////////////////////////////
+// StdVariant IMPLEMENTATION
+#ifdef STDVARIANT_IMPL
+
+// Private: pieces STDVARIANT_DECL is made of. Every
+// member comes in as a `(type, field)` pair.
+#define __STD_VARIANT_TYPE(type, field) type
+#define __STD_VARIANT_NAME(type, field) field
+#define __STD_VARIANT_TAG(name, i, m)                                   \
+  __STD_CAT(name##_TAG_, __STD_VARIANT_NAME m) = i,
+#define __STD_VARIANT_FIELD(name, i, m)                                 \
+  __STD_VARIANT_TYPE m __STD_VARIANT_NAME m;
+#define __STD_VARIANT_FN(name, i, m)                                    \
+  void (*__STD_VARIANT_NAME m)(__STD_VARIANT_TYPE m *value, void *ctx);
+#define __STD_VARIANT_CASE(name, i, m)                                  \
+  case i:                                                               \
+    if (visitor->__STD_VARIANT_NAME m) {                                \
+      visitor->__STD_VARIANT_NAME m(&v->as.__STD_VARIANT_NAME m, ctx);  \
+    }                                                                   \
+    break;
+#define __STD_VARIANT_FUNCS(name, i, m)                                 \
+  static inline name                                                    \
+  __STD_CAT(name##_, __STD_VARIANT_NAME m)(__STD_VARIANT_TYPE m value)  \
+  {                                                                     \
+    name v;                                                             \
+    v.tag = i;                                                          \
+    v.as.__STD_VARIANT_NAME m = value;                                  \
+    return v;                                                           \
+  }                                                                     \
+                                                                        \
+  static inline __STD_VARIANT_TYPE m *                                  \
+  __STD_CAT(name##_get_, __STD_VARIANT_NAME m)(name *v)                 \
+  {                                                                     \
+    return v->tag == i ? &v->as.__STD_VARIANT_NAME m : NULL;            \
+  }
+
+// Generates `name`, a tagged union of up to 8 members
+// given as `(type, field)` pairs. It is a one byte tag
+// next to a union sized to the largest member, so it
+// can be stored by value in a StdVec or array with no
+// allocation per element. Along with it:
+//   name_TAG_field       tag value of each member, name_TAG_COUNT
+//   name_field(value)    constructor for each member
+//   name_get_field(v)    pointer to the member, NULL if `v` holds another
+//   nameVisitor          one callback per member, NULL ones are skipped
+//   name_visit(v, visitor, ctx)
+// name_visit is a switch over the dense tag values, so it
+// compiles to a jump table instead of a chain of ifs. Use
+// STDVARIANT_VISIT to pass the visitor inline.
+// Example usage:
+//   STDVARIANT_DECL(Event, (int, click), (double, scroll));
+//   Event e = Event_scroll(1.5);
+//   if (e.tag == Event_TAG_scroll) { e.as.scroll *= 2; }
+#define STDVARIANT_DECL(name, ...)                                      \
+  enum                                                                  \
+  {                                                                     \
+    __STD_FOREACH(__STD_VARIANT_TAG, name, __VA_ARGS__)                 \
+    name##_TAG_COUNT                                                    \
+  };                                                                    \
+                                                                        \
+  typedef struct                                                        \
+  {                                                                     \
+    uint8_t tag;                                                        \
+    union                                                               \
+    {                                                                   \
+      __STD_FOREACH(__STD_VARIANT_FIELD, name, __VA_ARGS__)             \
+    } as;                                                               \
+  } name;                                                               \
+                                                                        \
+  typedef struct                                                        \
+  {                                                                     \
+    __STD_FOREACH(__STD_VARIANT_FN, name, __VA_ARGS__)                  \
+  } name##Visitor;                                                      \
+                                                                        \
+  __STD_FOREACH(__STD_VARIANT_FUNCS, name, __VA_ARGS__)                 \
+                                                                        \
+  static inline void                                                    \
+  name##_visit(name *v, const name##Visitor *visitor, void *ctx)        \
+  {                                                                     \
+    switch (v->tag) {                                                   \
+      __STD_FOREACH(__STD_VARIANT_CASE, name, __VA_ARGS__)              \
+    default:                                                            \
+      __STD_PANIC("invalid variant tag %d", (int)v->tag);               \
+    }                                                                   \
+  }
+
+// Call the callback of `v`'s member, with the
+// callbacks given as designated initializers.
+// Example usage:
+//   STDVARIANT_VISIT(Event, &e, &total, .click = on_click, .scroll = on_scroll);
+#define STDVARIANT_VISIT(name, v, ctx, ...)                             \
+  name##_visit((v), &(name##Visitor){__VA_ARGS__}, (ctx))
+
+#endif // STDVARIANT_IMPL
+
+////////////////////////////////
+// StdQueue IMPLEMENTATION
+#ifdef STDQUEUE_IMPL
+
+// A ring buffer. `cap` is always a power of two
+// so positions can be wrapped with `& (cap-1)`
+// instead of `% cap`.
+struct StdQueue
+{
+  void *data;
+  size_t stride;
+  size_t len;
+  size_t cap;
+  size_t head;  // Index of the front of the queue
+  int fixed;    // If set, the queue never grows
+  const StdAllocator *alloc;  // NULL for malloc()
+};
+typedef struct StdQueue StdQueue;
+
+// Private function to round `n` up
+// to the next power of two.
+size_t
+__stdqueue_pow2(size_t n)
+{
+  size_t p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+// Create a new StdQueue with element
+// size being `stride`.
+StdQueue
+stdqueue_new(size_t stride)
+{
+  StdQueue queue;
+  queue.data   = __STD_A_ALLOC(NULL, stride);
+  queue.cap    = 1;
+  queue.len    = 0;
+  queue.head   = 0;
+  queue.stride = stride;
+  queue.fixed  = 0;
+  queue.alloc  = NULL;
+  return queue;
+}
+
+// Create a new StdQueue with room for at least
+// `cap` elements. `cap` is rounded up to a power of two.
+StdQueue
+stdqueue_wcap(size_t stride, size_t cap)
+{
+  StdQueue queue;
+  queue.cap    = __stdqueue_pow2(cap);
+  queue.data   = __STD_A_ALLOC(NULL, queue.cap*stride);
+  queue.len    = 0;
+  queue.head   = 0;
+  queue.stride = stride;
+  queue.fixed  = 0;
+  queue.alloc  = NULL;
+  return queue;
+}
+
+// Same as stdqueue_wcap, allocating
+// through `alloc` instead of malloc().
+StdQueue
+stdqueue_wcap_alloc(size_t stride, size_t cap, const StdAllocator *alloc)
+{
+  StdQueue queue;
+  queue.cap    = __stdqueue_pow2(cap);
+  queue.data   = __STD_A_ALLOC(alloc, queue.cap*stride);
+  queue.len    = 0;
+  queue.head   = 0;
+  queue.stride = stride;
+  queue.fixed  = 0;
+  queue.alloc  = alloc;
+  return queue;
+}
+
+// Same as stdqueue_new, allocating
+// through `alloc` instead of malloc().
+StdQueue
+stdqueue_new_alloc(size_t stride, const StdAllocator *alloc)
+{
+  return stdqueue_wcap_alloc(stride, 1, alloc);
+}
+
+// Create a bounded StdQueue that never grows.
+// `cap` is rounded up to a power of two, and
+// enqueueing into a full queue fails instead
+// of reallocating.
+StdQueue
+stdqueue_fixed(size_t stride, size_t cap)
+{
+  StdQueue queue = stdqueue_wcap(stride, cap);
+  queue.fixed = 1;
+  return queue;
+}
+
+// Free the underlying memory of `queue`.
+void
+stdqueue_free(StdQueue *queue)
+{
+  __STD_CHECK_MEM(queue->data);
+  __STD_A_FREE(queue->alloc, queue->data, queue->cap*queue->stride);
+  queue->data = NULL;
+  queue->len = queue->cap = queue->stride = queue->head = 0;
+  queue->fixed = 0;
+}
+
+// Returns 1 if queue is empty, 0 otherwise.
+int
+stdqueue_empty(StdQueue *queue)
+{
+  return queue->len == 0;
+}
+
+// Returns 1 if queue has no free slots, 0 otherwise.
+// A growable queue that is full will grow on
+// the next enqueue.
+int
+stdqueue_full(StdQueue *queue)
+{
+  return queue->len == queue->cap;
+}
+
+// Get the element at the front of `queue`.
+// Returns NULL if the queue is empty.
+void *
+stdqueue_peek(StdQueue *queue)
+{
+  return queue->len == 0
+    ? NULL
+    : queue->data + queue->head * queue->stride;
+}
+
+// Private function to grow `queue` so it can hold at
+// least `mincap` elements. If the contents wrap around
+// the end of the buffer, the wrapped part is moved to
+// sit right after the old end so the elements stay
+// contiguous from `head`.
+void
+__stdqueue_grow(StdQueue *queue, size_t mincap)
+{
+  size_t oldcap = queue->cap;
+  size_t newcap = __stdqueue_pow2(mincap);
+  if (newcap <= oldcap) {
+    return;
+  }
+  queue->data = __STD_A_REALLOC(queue->alloc, queue->data,
+                                oldcap*queue->stride, newcap*queue->stride);
+  __STD_INSTR_WASTE((newcap-mincap)*queue->stride);
+  __STD_CHECK_MEM(queue->data);
+  if (queue->head+queue->len > oldcap) {
+    size_t wrapped = queue->head+queue->len-oldcap;
+    (void)memcpy(queue->data+oldcap*queue->stride, queue->data, wrapped*queue->stride);
+  }
+  queue->cap = newcap;
+}
+
+// Remove the value at the front of `queue`.
+// Panics if len = 0.
+void
+stdqueue_dequeue(StdQueue *queue)
+{
+  if (queue->len == 0) {
+    __STD_PANIC("tried to dequeue from an empty queue");
+  }
+  queue->head = (queue->head+1) & (queue->cap-1);
+  queue->len--;
+}
+
+// Enqueue an element into `queue` at the end.
+// Returns 1 on success. Returns 0 if `queue`
+// is fixed and full.
+int
+stdqueue_enqueue(StdQueue *queue, void *value)
+{
+  __STD_CHECK_MEM(queue->data);
+  if (queue->len == queue->cap) {
+    if (queue->fixed) {
+      return 0;
+    }
+    __stdqueue_grow(queue, queue->cap*2);
+  }
+  size_t tail = (queue->head+queue->len) & (queue->cap-1);
+  (void)memcpy(queue->data+tail*queue->stride, value, queue->stride);
+  queue->len++;
+  return 1;
+}
+
+// Enqueue `n` contiguous elements from `values` at
+// the end of `queue` using at most two copies.
+// Returns the number of elements enqueued, which is
+// less than `n` only if `queue` is fixed.
+size_t
+stdqueue_enqueue_n(StdQueue *queue, void *values, size_t n)
+{
+  __STD_CHECK_MEM(queue->data);
+  if (queue->len+n > queue->cap) {
+    if (queue->fixed) {
+      n = queue->cap-queue->len;
+    } else {
+      __stdqueue_grow(queue, queue->len+n);
+    }
+  }
+  size_t tail = (queue->head+queue->len) & (queue->cap-1);
+  size_t first = queue->cap-tail < n ? queue->cap-tail : n;
+  (void)memcpy(queue->data+tail*queue->stride, values, first*queue->stride);
+  (void)memcpy(queue->data, values+first*queue->stride, (n-first)*queue->stride);
+  queue->len += n;
+  return n;
+}
+
+// Dequeue up to `n` elements from the front of `queue`
+// into `out` using at most two copies. `out` may be
+// NULL to just drop them. Returns the number of
+// elements dequeued.
+size_t
+stdqueue_dequeue_n(StdQueue *queue, void *out, size_t n)
+{
+  if (n > queue->len) {
+    n = queue->len;
+  }
+  if (out) {
+    size_t first = queue->cap-queue->head < n ? queue->cap-queue->head : n;
+    (void)memcpy(out, queue->data+queue->head*queue->stride, first*queue->stride);
+    (void)memcpy(out+first*queue->stride, queue->data, (n-first)*queue->stride);
+  }
+  queue->head = (queue->head+n) & (queue->cap-1);
+  queue->len -= n;
+  return n;
+}
+
+#endif // STDQUEUE_IMPL
+
+////////////////////////////////
+// StdSpscQueue IMPLEMENTATION
+#ifdef STDSPSCQUEUE_IMPL
+
+// A bounded lock-free queue for exactly one producer
+// thread and one consumer thread. `head` and `tail`
+// are free-running counters that each live on their
+// own cache line. Each side also keeps a cached copy
+// of the other side's counter so it only has to touch
+// the shared line when the queue looks full/empty.
+struct StdSpscQueue
+{
+  // Consumer side.
+  _Alignas(__STD_CACHE_LINE) _Atomic size_t head;
+  size_t tail_cache;
+
+  // Producer side.
+  _Alignas(__STD_CACHE_LINE) _Atomic size_t tail;
+  size_t head_cache;
+
+  // Read-only after creation.
+  _Alignas(__STD_CACHE_LINE) void *data;
+  size_t stride;
+  size_t cap;  // Always a power of two
+};
+typedef struct StdSpscQueue StdSpscQueue;
+
+// Create a new StdSpscQueue with element size `stride`
+// and room for at least `cap` elements. `cap` is rounded
+// up to a power of two.
+StdSpscQueue
+stdspscqueue_new(size_t stride, size_t cap)
+{
+  StdSpscQueue queue;
+  size_t pow2 = 1;
+  while (pow2 < cap) {
+    pow2 <<= 1;
+  }
+  queue.data   = __STD_S_MALLOC(pow2*stride);
+  queue.stride = stride;
+  queue.cap    = pow2;
+  queue.tail_cache = queue.head_cache = 0;
+  atomic_init(&queue.head, 0);
+  atomic_init(&queue.tail, 0);
+  return queue;
+}
+
+// Free the underlying memory of `queue`. Neither
+// thread may be using it anymore.
+void
+stdspscqueue_free(StdSpscQueue *queue)
+{
+  __STD_CHECK_MEM(queue->data);
+  __STD_FREE(queue->data);
+  queue->data = NULL;
+  queue->cap = queue->stride = 0;
+}
+
+// Get the number of elements currently in `queue`.
+// This is only a snapshot when both threads are running.
+size_t
+stdspscqueue_len(StdSpscQueue *queue)
+{
+  // `head` first: it never passes `tail`, so a `tail`
+  // read after it is never behind it.
+  size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+  size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+  return tail-head;
+}
+
+// Push up to `n` elements from `values`. Only the
+// producer may call this. Returns the number of
+// elements pushed, which may be 0 if `queue` is full.
+size_t
+stdspscqueue_push_n(StdSpscQueue *queue, const void *values, size_t n)
+{
+  size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  size_t space = queue->cap-(tail-queue->head_cache);
+  if (space < n) {
+    queue->head_cache = atomic_load_explicit(&queue->head, memory_order_acquire);
+    space = queue->cap-(tail-queue->head_cache);
+    if (space < n) {
+      n = space;
+    }
+  }
+  if (n == 0) {
+    return 0;
+  }
+  size_t pos = tail & (queue->cap-1);
+  size_t first = queue->cap-pos < n ? queue->cap-pos : n;
+  (void)memcpy(queue->data+pos*queue->stride, values, first*queue->stride);
+  (void)memcpy(queue->data, values+first*queue->stride, (n-first)*queue->stride);
+  atomic_store_explicit(&queue->tail, tail+n, memory_order_release);
+  return n;
+}
+
+// Pop up to `n` elements into `out`. Only the
+// consumer may call this. Returns the number of
+// elements popped, which may be 0 if `queue` is empty.
+size_t
+stdspscqueue_pop_n(StdSpscQueue *queue, void *out, size_t n)
+{
+  size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  size_t avail = queue->tail_cache-head;
+  if (avail < n) {
+    queue->tail_cache = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    avail = queue->tail_cache-head;
+    if (avail < n) {
+      n = avail;
+    }
+  }
+  if (n == 0) {
+    return 0;
+  }
+  size_t pos = head & (queue->cap-1);
+  size_t first = queue->cap-pos < n ? queue->cap-pos : n;
+  (void)memcpy(out, queue->data+pos*queue->stride, first*queue->stride);
+  (void)memcpy(out+first*queue->stride, queue->data, (n-first)*queue->stride);
+  atomic_store_explicit(&queue->head, head+n, memory_order_release);
+  return n;
+}
+
+// Try to push one element. Returns 1 on
+// success, 0 if `queue` is full.
+int
+stdspscqueue_try_push(StdSpscQueue *queue, const void *value)
+{
+  return stdspscqueue_push_n(queue, value, 1) == 1;
+}
+
+// Try to pop one element into `out`. Returns
+// 1 on success, 0 if `queue` is empty.
+int
+stdspscqueue_try_pop(StdSpscQueue *queue, void *out)
+{
+  return stdspscqueue_pop_n(queue, out, 1) == 1;
+}
+
+// Push one element, waiting while `queue` is full.
+void
+stdspscqueue_push(StdSpscQueue *queue, const void *value)
+{
+  unsigned spins = 0;
+  while (!stdspscqueue_try_push(queue, value)) {
+    __std_backoff(&spins);
+  }
+}
+
+// Pop one element into `out`, waiting
+// while `queue` is empty.
+void
+stdspscqueue_pop(StdSpscQueue *queue, void *out)
+{
+  unsigned spins = 0;
+  while (!stdspscqueue_try_pop(queue, out)) {
+    __std_backoff(&spins);
+  }
+}
+
+#endif // STDSPSCQUEUE_IMPL
+
+////////////////////////////////
+// StdMpmcQueue IMPLEMENTATION
+#ifdef STDMPMCQUEUE_IMPL
+
+// A bounded lock-free queue for any number of producer
+// and consumer threads (Dmitry Vyukov's design). Every
+// slot carries a sequence number that says whose turn
+// it is: the slot for position `pos` is free for a
+// producer when seq == pos, and holds a value for a
+// consumer when seq == pos+1. Producers and consumers
+// only contend on their own counter.
+struct StdMpmcQueue
+{
+  _Alignas(__STD_CACHE_LINE) _Atomic size_t enqueue_pos;
+  _Alignas(__STD_CACHE_LINE) _Atomic size_t dequeue_pos;
+
+  // Read-only after creation.
+  _Alignas(__STD_CACHE_LINE) void *slots;
+  size_t stride;
+  size_t slot_size;  // Sequence number + element, padded
+  size_t cap;        // Always a power of two
+};
+typedef struct StdMpmcQueue StdMpmcQueue;
+
+// Private function to get the sequence number of slot `i`.
+_Atomic size_t *
+__stdmpmcqueue_seq(StdMpmcQueue *queue, size_t i)
+{
+  return (_Atomic size_t *)(queue->slots+(i & (queue->cap-1))*queue->slot_size);
+}
+
+// Private function to get the element of slot `i`.
+void *
+__stdmpmcqueue_elem(StdMpmcQueue *queue, size_t i)
+{
+  return queue->slots+(i & (queue->cap-1))*queue->slot_size+sizeof(_Atomic size_t);
+}
+
+// Create a new StdMpmcQueue with element size `stride`
+// and room for at least `cap` elements. `cap` is rounded
+// up to a power of two (and is at least 2).
+StdMpmcQueue
+stdmpmcqueue_new(size_t stride, size_t cap)
+{
+  StdMpmcQueue queue;
+  size_t pow2 = 2;
+  while (pow2 < cap) {
+    pow2 <<= 1;
+  }
+  size_t align = sizeof(_Atomic size_t);
+  queue.stride    = stride;
+  queue.cap       = pow2;
+  queue.slot_size = (sizeof(_Atomic size_t)+stride+align-1)/align*align;
+  queue.slots     = __STD_S_MALLOC(pow2*queue.slot_size);
+  for (size_t i = 0; i < pow2; ++i) {
+    atomic_init(__stdmpmcqueue_seq(&queue, i), i);
+  }
+  atomic_init(&queue.enqueue_pos, 0);
+  atomic_init(&queue.dequeue_pos, 0);
+  return queue;
+}
+
+// Free the underlying memory of `queue`. No
+// thread may be using it anymore.
+void
+stdmpmcqueue_free(StdMpmcQueue *queue)
+{
+  __STD_CHECK_MEM(queue->slots);
+  __STD_FREE(queue->slots);
+  queue->slots = NULL;
+  queue->cap = queue->stride = queue->slot_size = 0;
+}
+
+// Get the number of elements currently in `queue`.
+// This is only a snapshot when other threads are running.
+size_t
+stdmpmcqueue_len(StdMpmcQueue *queue)
+{
+  size_t head = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  size_t tail = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  return tail > head ? tail-head : 0;
+}
+
+// Try to enqueue one element. Returns 1
+// on success, 0 if `queue` is full.
+int
+stdmpmcqueue_try_enqueue(StdMpmcQueue *queue, const void *value)
+{
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  for (;;) {
+    size_t seq = atomic_load_explicit(__stdmpmcqueue_seq(queue, pos), memory_order_acquire);
+    intptr_t diff = (intptr_t)seq-(intptr_t)pos;
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos+1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return 0;
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+  (void)memcpy(__stdmpmcqueue_elem(queue, pos), value, queue->stride);
+  atomic_store_explicit(__stdmpmcqueue_seq(queue, pos), pos+1, memory_order_release);
+  return 1;
+}
+
+// Try to dequeue up to `n` elements into `out`. Claims
+// a run of consecutive ready slots with a single CAS.
+// Returns the number of elements dequeued, which is
+// 0 if `queue` is empty.
+size_t
+stdmpmcqueue_try_dequeue_n(StdMpmcQueue *queue, void *out, size_t n)
+{
+  if (n == 0) {
+    return 0;
+  }
+  size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  size_t k;
+  for (;;) {
+    size_t seq = atomic_load_explicit(__stdmpmcqueue_seq(queue, pos), memory_order_acquire);
+    intptr_t diff = (intptr_t)seq-(intptr_t)(pos+1);
+    if (diff < 0) {
+      return 0;
+    }
+    if (diff > 0) {
+      pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+      continue;
+    }
+    // The first slot is ready, see how many
+    // after it are ready too.
+    k = 1;
+    while (k < n && k < queue->cap) {
+      seq = atomic_load_explicit(__stdmpmcqueue_seq(queue, pos+k), memory_order_acquire);
+      if (seq != pos+k+1) {
+        break;
+      }
+      ++k;
+    }
+    if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos+k,
+                                              memory_order_relaxed, memory_order_relaxed)) {
+      break;
+    }
+  }
+  for (size_t i = 0; i < k; ++i) {
+    (void)memcpy(out+i*queue->stride, __stdmpmcqueue_elem(queue, pos+i), queue->stride);
+    atomic_store_explicit(__stdmpmcqueue_seq(queue, pos+i), pos+i+queue->cap,
+                          memory_order_release);
+  }
+  return k;
+}
+
+// Try to dequeue one element into `out`. Returns
+// 1 on success, 0 if `queue` is empty.
+int
+stdmpmcqueue_try_dequeue(StdMpmcQueue *queue, void *out)
+{
+  return stdmpmcqueue_try_dequeue_n(queue, out, 1) == 1;
+}
+
+// Enqueue one element, waiting while `queue` is full.
+void
+stdmpmcqueue_enqueue(StdMpmcQueue *queue, const void *value)
+{
+  unsigned spins = 0;
+  while (!stdmpmcqueue_try_enqueue(queue, value)) {
+    __std_backoff(&spins);
+  }
+}
+
+// Dequeue one element into `out`, waiting
+// while `queue` is empty.
+void
+stdmpmcqueue_dequeue(StdMpmcQueue *queue, void *out)
+{
+  unsigned spins = 0;
+  while (!stdmpmcqueue_try_dequeue(queue, out)) {
+    __std_backoff(&spins);
+  }
+}
+
+// Dequeue between 1 and `n` elements into `out`, waiting
+// while `queue` is empty. Returns the number dequeued.
+size_t
+stdmpmcqueue_dequeue_n(StdMpmcQueue *queue, void *out, size_t n)
+{
+  unsigned spins = 0;
+  size_t got;
+  while ((got = stdmpmcqueue_try_dequeue_n(queue, out, n)) == 0 && n > 0) {
+    __std_backoff(&spins);
+  }
+  return got;
+}
+
+#endif // STDMPMCQUEUE_IMPL
+
+////////////////////////////////
+// StdConcurrentMap IMPLEMENTATION
+#ifdef STDCONCURRENTMAP_IMPL
+
+// Every shard is its own open-addressing (linear probing)
+// table behind its own reader/writer lock, so threads
+// working on different shards never touch the same lock.
+// Slots are laid out as [hash][key][value]. A stored hash
+// always has its top bit set, so 0 marks an empty slot.
+struct __StdConcurrentMapShard
+{
+  _Alignas(__STD_CACHE_LINE) pthread_rwlock_t lock;
+  void *slots;
+  size_t len;
+  size_t cap;      // Always a power of two
+  size_t resizes;
+};
+
+// Keys are hashed and compared bytewise, so any
+// padding inside struct keys must be zeroed.
+struct StdConcurrentMap
+{
+  struct __StdConcurrentMapShard *shards;
+  size_t nshards;  // Always a power of two
+  size_t keysz;
+  size_t valsz;
+  size_t slot_size;
+  uint64_t seed;
+};
+typedef struct StdConcurrentMap StdConcurrentMap;
+
+// Aggregate statistics over all shards.
+struct StdConcurrentMapStats
+{
+  size_t len;
+  size_t cap;
+  size_t resizes;
+  size_t min_shard_len;
+  size_t max_shard_len;
+  double load_factor;
+};
+typedef struct StdConcurrentMapStats StdConcurrentMapStats;
+
+#define __STDCONCURRENTMAP_USED (1ull << 63)
+
+// Private function to get slot `i` of `shard`.
+void *
+__stdconcurrentmap_slot(StdConcurrentMap *map, struct __StdConcurrentMapShard *shard, size_t i)
+{
+  return shard->slots+(i & (shard->cap-1))*map->slot_size;
+}
+
+// Private function to get the shard that owns hash `h`.
+struct __StdConcurrentMapShard *
+__stdconcurrentmap_shard(StdConcurrentMap *map, uint64_t h)
+{
+  return &map->shards[(h >> 40) & (map->nshards-1)];
+}
+
+// Private function to find `key` in `shard`. Returns
+// the slot index, or the index of the empty slot that
+// ends the probe if it is not present. `*found` is set
+// accordingly. The shard must be locked.
+size_t
+__stdconcurrentmap_probe(StdConcurrentMap *map, struct __StdConcurrentMapShard *shard,
+                         uint64_t h, const void *key, int *found)
+{
+  size_t i = h & (shard->cap-1);
+  for (;;) {
+    void *slot = __stdconcurrentmap_slot(map, shard, i);
+    uint64_t sh;
+    (void)memcpy(&sh, slot, sizeof(sh));
+    if (sh == 0) {
+      *found = 0;
+      return i;
+    }
+    if (sh == h && memcmp(slot+sizeof(uint64_t), key, map->keysz) == 0) {
+      *found = 1;
+      return i;
+    }
+    i = (i+1) & (shard->cap-1);
+  }
+}
+
+// Private function to double the capacity of `shard`
+// and rehash its entries. The shard must be write locked.
+void
+__stdconcurrentmap_grow(StdConcurrentMap *map, struct __StdConcurrentMapShard *shard)
+{
+  void *old = shard->slots;
+  size_t oldcap = shard->cap;
+  shard->cap *= 2;
+  shard->slots = __STD_CALLOC(shard->cap, map->slot_size);
+  __STD_CHECK_MEM(shard->slots);
+  for (size_t i = 0; i < oldcap; ++i) {
+    void *slot = old+i*map->slot_size;
+    uint64_t h;
+    (void)memcpy(&h, slot, sizeof(h));
+    if (h == 0) {
+      continue;
+    }
+    size_t j = h & (shard->cap-1);
+    for (;;) {
+      void *dst = __stdconcurrentmap_slot(map, shard, j);
+      uint64_t dh;
+      (void)memcpy(&dh, dst, sizeof(dh));
+      if (dh == 0) {
+        (void)memcpy(dst, slot, map->slot_size);
+        break;
+      }
+      j = (j+1) & (shard->cap-1);
+    }
+  }
+  __STD_FREE(old);
+  shard->resizes++;
+}
+
+// Create a new StdConcurrentMap with key size `keysz`,
+// value size `valsz`, and `nshards` shards. `nshards`
+// is rounded up to a power of two. A few shards per
+// core is a good starting point.
+StdConcurrentMap
+stdconcurrentmap_new(size_t keysz, size_t valsz, size_t nshards)
+{
+  StdConcurrentMap map;
+  size_t pow2 = 1;
+  while (pow2 < nshards) {
+    pow2 <<= 1;
+  }
+  map.nshards   = pow2;
+  map.keysz     = keysz;
+  map.valsz     = valsz;
+  map.slot_size = (sizeof(uint64_t)+keysz+valsz+7)/8*8;
+  map.seed      = 0x2545f4914f6cdd1dull;
+  map.shards    = __STD_ALIGNED_ALLOC(__STD_CACHE_LINE, pow2*sizeof(struct __StdConcurrentMapShard));
+  __STD_CHECK_MEM(map.shards);
+  for (size_t i = 0; i < pow2; ++i) {
+    struct __StdConcurrentMapShard *shard = &map.shards[i];
+    pthread_rwlock_init(&shard->lock, NULL);
+    shard->cap     = 8;
+    shard->len     = 0;
+    shard->resizes = 0;
+    shard->slots   = __STD_CALLOC(shard->cap, map.slot_size);
+    __STD_CHECK_MEM(shard->slots);
+  }
+  return map;
+}
+
+// Free the underlying memory of `map`. No
+// thread may be using it anymore.
+void
+stdconcurrentmap_free(StdConcurrentMap *map)
+{
+  __STD_CHECK_MEM(map->shards);
+  for (size_t i = 0; i < map->nshards; ++i) {
+    pthread_rwlock_destroy(&map->shards[i].lock);
+    __STD_FREE(map->shards[i].slots);
+  }
+  __STD_FREE(map->shards);
+  map->shards = NULL;
+  map->nshards = map->keysz = map->valsz = map->slot_size = 0;
+}
+
+// Insert `key` with `value`, or overwrite the value if
+// `key` is already present. Returns 1 if `key` was
+// newly inserted, 0 if it was overwritten.
+int
+stdconcurrentmap_put(StdConcurrentMap *map, const void *key, const void *value)
+{
+  uint64_t h = __std_hash_bytes(key, map->keysz, map->seed) | __STDCONCURRENTMAP_USED;
+  struct __StdConcurrentMapShard *shard = __stdconcurrentmap_shard(map, h);
+  int found;
+
+  pthread_rwlock_wrlock(&shard->lock);
+  size_t i = __stdconcurrentmap_probe(map, shard, h, key, &found);
+  // Keep the load factor at or below 3/4. Overwrites
+  // do not add an entry, so they never grow the shard.
+  if (!found && (shard->len+1)*4 > shard->cap*3) {
+    __stdconcurrentmap_grow(map, shard);
+    i = __stdconcurrentmap_probe(map, shard, h, key, &found);
+  }
+  void *slot = __stdconcurrentmap_slot(map, shard, i);
+  if (!found) {
+    (void)memcpy(slot, &h, sizeof(h));
+    (void)memcpy(slot+sizeof(uint64_t), key, map->keysz);
+    shard->len++;
+  }
+  (void)memcpy(slot+sizeof(uint64_t)+map->keysz, value, map->valsz);
+  pthread_rwlock_unlock(&shard->lock);
+  return !found;
+}
+
+// Look up `key` and copy its value into `out`. `out`
+// may be NULL to only check for presence. Only takes a
+// read lock, so lookups on the same shard run in
+// parallel. Returns 1 if `key` is present, 0 otherwise.
+int
+stdconcurrentmap_get(StdConcurrentMap *map, const void *key, void *out)
+{
+  uint64_t h = __std_hash_bytes(key, map->keysz, map->seed) | __STDCONCURRENTMAP_USED;
+  struct __StdConcurrentMapShard *shard = __stdconcurrentmap_shard(map, h);
+  int found;
+
+  pthread_rwlock_rdlock(&shard->lock);
+  size_t i = __stdconcurrentmap_probe(map, shard, h, key, &found);
+  if (found && out) {
+    void *slot = __stdconcurrentmap_slot(map, shard, i);
+    (void)memcpy(out, slot+sizeof(uint64_t)+map->keysz, map->valsz);
+  }
+  pthread_rwlock_unlock(&shard->lock);
+  return found;
+}
+
+// Remove `key` from `map`. Entries after it in the same
+// probe run are shifted back, so no tombstones are left.
+// Returns 1 if `key` was present, 0 otherwise.
+int
+stdconcurrentmap_remove(StdConcurrentMap *map, const void *key)
+{
+  uint64_t h = __std_hash_bytes(key, map->keysz, map->seed) | __STDCONCURRENTMAP_USED;
+  struct __StdConcurrentMapShard *shard = __stdconcurrentmap_shard(map, h);
+  int found;
+
+  pthread_rwlock_wrlock(&shard->lock);
+  size_t hole = __stdconcurrentmap_probe(map, shard, h, key, &found);
+  if (found) {
+    size_t mask = shard->cap-1;
+    size_t i = hole;
+    for (;;) {
+      i = (i+1) & mask;
+      void *slot = __stdconcurrentmap_slot(map, shard, i);
+      uint64_t sh;
+      (void)memcpy(&sh, slot, sizeof(sh));
+      if (sh == 0) {
+        break;
+      }
+      // Only move the entry if its home slot is not
+      // between the hole and where it sits now.
+      size_t home = sh & mask;
+      if (((i-home) & mask) >= ((i-hole) & mask)) {
+        (void)memcpy(__stdconcurrentmap_slot(map, shard, hole), slot, map->slot_size);
+        hole = i;
+      }
+    }
+    (void)memset(__stdconcurrentmap_slot(map, shard, hole), 0, map->slot_size);
+    shard->len--;
+  }
+  pthread_rwlock_unlock(&shard->lock);
+  return found;
+}
+
+// Get the number of entries in `map`. This is only
+// a snapshot when other threads are writing.
+size_t
+stdconcurrentmap_len(StdConcurrentMap *map)
+{
+  size_t len = 0;
+  for (size_t i = 0; i < map->nshards; ++i) {
+    pthread_rwlock_rdlock(&map->shards[i].lock);
+    len += map->shards[i].len;
+    pthread_rwlock_unlock(&map->shards[i].lock);
+  }
+  return len;
+}
+
+// Collect statistics over all shards of `map`.
+StdConcurrentMapStats
+stdconcurrentmap_stats(StdConcurrentMap *map)
+{
+  StdConcurrentMapStats stats = {0};
+  stats.min_shard_len = (size_t)-1;
+  for (size_t i = 0; i < map->nshards; ++i) {
+    struct __StdConcurrentMapShard *shard = &map->shards[i];
+    pthread_rwlock_rdlock(&shard->lock);
+    stats.len += shard->len;
+    stats.cap += shard->cap;
+    stats.resizes += shard->resizes;
+    if (shard->len < stats.min_shard_len) {
+      stats.min_shard_len = shard->len;
+    }
+    if (shard->len > stats.max_shard_len) {
+      stats.max_shard_len = shard->len;
+    }
+    pthread_rwlock_unlock(&shard->lock);
+  }
+  stats.load_factor = stats.cap ? (double)stats.len/(double)stats.cap : 0.0;
+  return stats;
+}
+
+#endif // STDCONCURRENTMAP_IMPL
+
+//////////////////////////////
+// StdPool IMPLEMENTATION
+#ifdef STDPOOL_IMPL
+
+// A fixed-size object allocator. Objects are carved out
+// of slabs and recycled through a free list that is
+// threaded through the freed objects themselves, so
+// alloc and dealloc are O(1) and never call malloc()
+// once the pool is warm.
+//
+// A pool set up with stdpool_init_mt() may be used from
+// many threads. Each thread then keeps a small magazine of
+// free objects and only takes the pool lock to refill or
+// flush half a magazine at a time. Such a pool holds a
+// mutex, so it is initialized in place and must not be
+// moved or copied.
+struct StdPool
+{
+  size_t stride;
+  void *free;          // Shared free list
+  void **slabs;
+  size_t slabs_len;
+  size_t slabs_cap;
+  size_t bump_slab;    // Slab that fresh objects are carved from
+  size_t bump;         // Next fresh object in `bump_slab`
+  size_t slab_objs;    // Objects in the next new slab
+  size_t capacity;     // Objects in all slabs
+  size_t handed_out;   // Objects not on the shared free list
+  size_t peak;
+  int mt;
+  pthread_mutex_t lock;
+  pthread_key_t key;
+  struct __StdPoolMagazine *magazines;
+};
+typedef struct StdPool StdPool;
+
+struct StdPoolStats
+{
+  size_t stride;
+  size_t slabs;
+  size_t capacity;     // Objects in all slabs
+  size_t in_use;       // Objects allocated and not yet deallocated
+  size_t cached;       // Free objects held in thread magazines
+  size_t peak;         // Most objects ever off the shared free list
+  size_t bytes;        // Bytes reserved for slabs
+  double utilization;  // in_use/capacity
+};
+typedef struct StdPoolStats StdPoolStats;
+
+#define __STDPOOL_MAGAZINE 64
+
+struct __StdPoolMagazine
+{
+  StdPool *pool;
+  struct __StdPoolMagazine *next;
+  _Atomic size_t len;  // Only written by the owning thread
+  void *objs[__STDPOOL_MAGAZINE];
+};
+
+// Private: every slab starts with its object count.
+#define __STDPOOL_SLAB_HDR _Alignof(max_align_t)
+
+// Private function to get the object count of `slab`.
+size_t
+__stdpool_slab_objs(void *slab)
+{
+  return *(size_t *)slab;
+}
+
+// Private function to get one object. The
+// pool lock must be held if the pool is mt.
+void *
+__stdpool_take(StdPool *pool)
+{
+  void *obj = pool->free;
+  if (obj) {
+    memcpy(&pool->free, obj, sizeof(void *));
+  } else {
+    // Carve from the current slab, moving on to
+    // already allocated slabs (after stdpool_clr)
+    // before making a new one.
+    while (pool->bump_slab < pool->slabs_len
+           && pool->bump == __stdpool_slab_objs(pool->slabs[pool->bump_slab])) {
+      pool->bump_slab++;
+      pool->bump = 0;
+    }
+    if (pool->bump_slab == pool->slabs_len) {
+      if (pool->slabs_len == pool->slabs_cap) {
+        pool->slabs_cap = pool->slabs_cap ? pool->slabs_cap*2 : 8;
+        pool->slabs = __STD_REALLOC(pool->slabs, pool->slabs_cap*sizeof(void *));
+        __STD_CHECK_MEM(pool->slabs);
+      }
+      void *slab = __STD_S_MALLOC(__STDPOOL_SLAB_HDR+pool->slab_objs*pool->stride);
+      *(size_t *)slab = pool->slab_objs;
+      pool->slabs[pool->slabs_len++] = slab;
+      pool->capacity += pool->slab_objs;
+      // Double the slab size until slabs are about 1MiB.
+      if (pool->slab_objs*pool->stride < (1 << 20)) {
+        pool->slab_objs *= 2;
+      }
+    }
+    obj = pool->slabs[pool->bump_slab]+__STDPOOL_SLAB_HDR+pool->bump*pool->stride;
+    pool->bump++;
+  }
+  pool->handed_out++;
+  if (pool->handed_out > pool->peak) {
+    pool->peak = pool->handed_out;
+  }
+  return obj;
+}
+
+// Private function to put `obj` back on the shared
+// free list. The pool lock must be held if the pool is mt.
+void
+__stdpool_give(StdPool *pool, void *obj)
+{
+  memcpy(obj, &pool->free, sizeof(void *));
+  pool->free = obj;
+  pool->handed_out--;
+}
+
+// Private thread exit handler that gives the
+// magazine's objects back to its pool.
+void
+__stdpool_magazine_exit(void *arg)
+{
+  struct __StdPoolMagazine *mag = (struct __StdPoolMagazine *)arg;
+  StdPool *pool = mag->pool;
+  pthread_mutex_lock(&pool->lock);
+  size_t len = atomic_load_explicit(&mag->len, memory_order_relaxed);
+  while (len > 0) {
+    __stdpool_give(pool, mag->objs[--len]);
+  }
+  struct __StdPoolMagazine **it = &pool->magazines;
+  while (*it != mag) {
+    it = &(*it)->next;
+  }
+  *it = mag->next;
+  pthread_mutex_unlock(&pool->lock);
+  __STD_FREE(mag);
+}
+
+// Private function to get the calling thread's magazine.
+struct __StdPoolMagazine *
+__stdpool_magazine(StdPool *pool)
+{
+  struct __StdPoolMagazine *mag = pthread_getspecific(pool->key);
+  if (!mag) {
+    mag = __STD_S_MALLOC(sizeof(*mag));
+    mag->pool = pool;
+    atomic_init(&mag->len, 0);
+    pthread_mutex_lock(&pool->lock);
+    mag->next = pool->magazines;
+    pool->magazines = mag;
+    pthread_mutex_unlock(&pool->lock);
+    pthread_setspecific(pool->key, mag);
+  }
+  return mag;
+}
+
+// Create a new single threaded StdPool of objects of
+// size `stride`. Objects are aligned to 16 bytes if
+// `stride` is at least 16, and to 8 bytes otherwise.
+StdPool
+stdpool_new(size_t stride)
+{
+  size_t align = stride >= 16 ? 16 : 8;
+  StdPool pool = {0};
+  pool.stride    = (stride+align-1)/align*align;
+  pool.slab_objs = 64;
+  pool.mt        = 0;
+  return pool;
+}
+
+// Initialize `pool` in place as a StdPool that may be
+// shared between threads. See StdPool for details.
+// Example usage:
+//   StdPool pool;
+//   stdpool_init_mt(&pool, sizeof(Node));
+void
+stdpool_init_mt(StdPool *pool, size_t stride)
+{
+  *pool = stdpool_new(stride);
+  pool->mt = 1;
+  pthread_mutex_init(&pool->lock, NULL);
+  if (pthread_key_create(&pool->key, __stdpool_magazine_exit) != 0) {
+    __STD_PANIC("could not create thread key");
+  }
+}
+
+// Get an object of `pool->stride` bytes from `pool`.
+void *
+stdpool_alloc(StdPool *pool)
+{
+  if (!pool->mt) {
+    return __stdpool_take(pool);
+  }
+  struct __StdPoolMagazine *mag = __stdpool_magazine(pool);
+  size_t len = atomic_load_explicit(&mag->len, memory_order_relaxed);
+  if (len == 0) {
+    pthread_mutex_lock(&pool->lock);
+    while (len < __STDPOOL_MAGAZINE/2) {
+      mag->objs[len++] = __stdpool_take(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+  atomic_store_explicit(&mag->len, len-1, memory_order_relaxed);
+  return mag->objs[len-1];
+}
+
+// Give `obj`, which came from `pool`, back to `pool`.
+// In an mt pool any thread may deallocate any object.
+void
+stdpool_dealloc(StdPool *pool, void *obj)
+{
+  if (!pool->mt) {
+    __stdpool_give(pool, obj);
+    return;
+  }
+  struct __StdPoolMagazine *mag = __stdpool_magazine(pool);
+  size_t len = atomic_load_explicit(&mag->len, memory_order_relaxed);
+  if (len == __STDPOOL_MAGAZINE) {
+    pthread_mutex_lock(&pool->lock);
+    while (len > __STDPOOL_MAGAZINE/2) {
+      __stdpool_give(pool, mag->objs[--len]);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+  mag->objs[len] = obj;
+  atomic_store_explicit(&mag->len, len+1, memory_order_relaxed);
+}
+
+// Release every object of `pool` at once, keeping
+// the slabs for reuse. Every pointer from `pool`
+// becomes invalid. For an mt pool, no other thread
+// may be using `pool` during this call.
+void
+stdpool_clr(StdPool *pool)
+{
+  if (pool->mt) {
+    pthread_mutex_lock(&pool->lock);
+    for (struct __StdPoolMagazine *mag = pool->magazines; mag; mag = mag->next) {
+      atomic_store_explicit(&mag->len, 0, memory_order_relaxed);
+    }
+  }
+  pool->free = NULL;
+  pool->bump_slab = 0;
+  pool->bump = 0;
+  pool->handed_out = 0;
+  if (pool->mt) {
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+// Free every slab of `pool`. Every pointer
+// from `pool` becomes invalid.
+void
+stdpool_free(StdPool *pool)
+{
+  if (pool->mt) {
+    pthread_key_delete(pool->key);
+    while (pool->magazines) {
+      struct __StdPoolMagazine *next = pool->magazines->next;
+      __STD_FREE(pool->magazines);
+      pool->magazines = next;
+    }
+    pthread_mutex_destroy(&pool->lock);
+  }
+  for (size_t i = 0; i < pool->slabs_len; ++i) {
+    __STD_FREE(pool->slabs[i]);
+  }
+  __STD_FREE(pool->slabs);
+  pool->slabs = NULL;
+  pool->free = NULL;
+  pool->slabs_len = pool->slabs_cap = pool->capacity = 0;
+  pool->bump_slab = pool->bump = pool->handed_out = pool->peak = 0;
+}
+
+// Collect usage statistics of `pool`.
+StdPoolStats
+stdpool_stats(StdPool *pool)
+{
+  StdPoolStats stats = {0};
+  if (pool->mt) {
+    pthread_mutex_lock(&pool->lock);
+  }
+  stats.stride = pool->stride;
+  stats.slabs = pool->slabs_len;
+  stats.capacity = pool->capacity;
+  stats.peak = pool->peak;
+  stats.in_use = pool->handed_out;
+  for (size_t i = 0; i < pool->slabs_len; ++i) {
+    stats.bytes += __STDPOOL_SLAB_HDR+__stdpool_slab_objs(pool->slabs[i])*pool->stride;
+  }
+  if (pool->mt) {
+    for (struct __StdPoolMagazine *mag = pool->magazines; mag; mag = mag->next) {
+      stats.cached += atomic_load_explicit(&mag->len, memory_order_relaxed);
+    }
+    stats.in_use -= stats.cached;
+    pthread_mutex_unlock(&pool->lock);
+  }
+  stats.utilization = stats.capacity ? (double)stats.in_use/(double)stats.capacity : 0.0;
+  return stats;
+}
+
+#endif // STDPOOL_IMPL
+
+//////////////////////////////
+// StdList IMPLEMENTATION
+#ifdef STDLIST_IMPL
+
+// An intrusive doubly linked list. Embed a StdListNode
+// in your own struct and link that, so the list never
+// allocates. Use STD_CONTAINER_OF (or STDLIST_ENTRY)
+// to get back from a node to your struct.
+// Example usage:
+//   struct Entry { int key; StdListNode node; };
+//   StdList list = stdlist_new();
+//   stdlist_push_back(&list, &entry.node);
+//   STDLIST_FOR_EACH(n, &list) {
+//     struct Entry *e = STDLIST_ENTRY(n, struct Entry, node);
+//   }
+struct StdListNode
+{
+  struct StdListNode *prev;
+  struct StdListNode *next;
+};
+typedef struct StdListNode StdListNode;
+
+struct StdList
+{
+  StdListNode *head;
+  StdListNode *tail;
+  size_t len;
+};
+typedef struct StdList StdList;
+
+#define STDLIST_ENTRY(node, type, member) STD_CONTAINER_OF(node, type, member)
+
+// Iterate over every node of `list` from front to back.
+#define STDLIST_FOR_EACH(node, list)                                    \
+  for (StdListNode *node = (list)->head; node != NULL; node = node->next)
+
+// Same as STDLIST_FOR_EACH, but `node` may be
+// unlinked inside of the loop.
+#define STDLIST_FOR_EACH_SAFE(node, tmp, list)                          \
+  for (StdListNode *node = (list)->head, *tmp = node ? node->next : NULL; \
+       node != NULL;                                                    \
+       node = tmp, tmp = node ? node->next : NULL)
+
+// Create a new, empty StdList.
+StdList
+stdlist_new(void)
+{
+  return (StdList) {
+    .head = NULL,
+    .tail = NULL,
+    .len = 0,
+  };
+}
+
+// Returns 1 if list is empty, 0 otherwise.
+int
+stdlist_empty(StdList *list)
+{
+  return list->len == 0;
+}
+
+// Get the first node of `list`, or NULL if it is empty.
+StdListNode *
+stdlist_front(StdList *list)
+{
+  return list->head;
+}
+
+// Get the last node of `list`, or NULL if it is empty.
+StdListNode *
+stdlist_back(StdList *list)
+{
+  return list->tail;
+}
+
+// Link `node` into `list` right before `pos`.
+// If `pos` is NULL, `node` goes at the end.
+void
+stdlist_insert_before(StdList *list, StdListNode *pos, StdListNode *node)
+{
+  node->next = pos;
+  node->prev = pos ? pos->prev : list->tail;
+  if (node->prev) {
+    node->prev->next = node;
+  } else {
+    list->head = node;
+  }
+  if (pos) {
+    pos->prev = node;
+  } else {
+    list->tail = node;
+  }
+  list->len++;
+}
+
+// Link `node` at the front of `list`.
+void
+stdlist_push_front(StdList *list, StdListNode *node)
+{
+  stdlist_insert_before(list, list->head, node);
+}
+
+// Link `node` at the end of `list`.
+void
+stdlist_push_back(StdList *list, StdListNode *node)
+{
+  stdlist_insert_before(list, NULL, node);
+}
+
+// Unlink `node` from `list` in O(1).
+// `node` must be in `list`.
+void
+stdlist_unlink(StdList *list, StdListNode *node)
+{
+  if (node->prev) {
+    node->prev->next = node->next;
+  } else {
+    list->head = node->next;
+  }
+  if (node->next) {
+    node->next->prev = node->prev;
+  } else {
+    list->tail = node->prev;
+  }
+  node->prev = node->next = NULL;
+  list->len--;
+}
+
+// Unlink and return the first node of `list`.
+// Returns NULL if the list is empty.
+StdListNode *
+stdlist_pop_front(StdList *list)
+{
+  StdListNode *node = list->head;
+  if (node) {
+    stdlist_unlink(list, node);
+  }
+  return node;
+}
+
+// Unlink and return the last node of `list`.
+// Returns NULL if the list is empty.
+StdListNode *
+stdlist_pop_back(StdList *list)
+{
+  StdListNode *node = list->tail;
+  if (node) {
+    stdlist_unlink(list, node);
+  }
+  return node;
+}
+
+// Move `node`, which must be in `list`, to the front.
+// This is the "touch" operation of an LRU.
+void
+stdlist_move_to_front(StdList *list, StdListNode *node)
+{
+  if (list->head == node) {
+    return;
+  }
+  stdlist_unlink(list, node);
+  stdlist_push_front(list, node);
+}
+
+// Move `node`, which must be in `list`, to the end.
+void
+stdlist_move_to_back(StdList *list, StdListNode *node)
+{
+  if (list->tail == node) {
+    return;
+  }
+  stdlist_unlink(list, node);
+  stdlist_push_back(list, node);
+}
+
+// Move every node of `src` into `dst` right before
+// `pos` in O(1). If `pos` is NULL they go at the end.
+// `src` is left empty.
+void
+stdlist_splice(StdList *dst, StdListNode *pos, StdList *src)
+{
+  if (src->len == 0) {
+    return;
+  }
+  StdListNode *prev = pos ? pos->prev : dst->tail;
+  src->head->prev = prev;
+  src->tail->next = pos;
+  if (prev) {
+    prev->next = src->head;
+  } else {
+    dst->head = src->head;
+  }
+  if (pos) {
+    pos->prev = src->tail;
+  } else {
+    dst->tail = src->tail;
+  }
+  dst->len += src->len;
+  *src = stdlist_new();
+}
+
+// A non-intrusive list that stores copies of `stride`
+// sized values. Nodes come from a StdPool, so pushing
+// and removing does not go through malloc() per element.
+// Pointers to values stay valid until that value is removed.
+struct StdSlabList
+{
+  StdList list;
+  size_t stride;
+  StdPool pool;
+};
+typedef struct StdSlabList StdSlabList;
+
+// Private: the value lives right after the node, rounded
+// up so any type can be stored there.
+#define __STDSLABLIST_HDR \
+  ((sizeof(StdListNode)+_Alignof(max_align_t)-1)/_Alignof(max_align_t)*_Alignof(max_align_t))
+
+// Create a new StdSlabList with element size `stride`.
+StdSlabList
+stdslablist_new(size_t stride)
+{
+  return (StdSlabList) {
+    .list = stdlist_new(),
+    .stride = stride,
+    .pool = stdpool_new(__STDSLABLIST_HDR+stride),
+  };
+}
+
+// Free every node of `list`. All value
+// pointers become invalid.
+void
+stdslablist_free(StdSlabList *list)
+{
+  stdpool_free(&list->pool);
+  list->list = stdlist_new();
+}
+
+// Get the value stored in `node`.
+void *
+stdslablist_value(StdListNode *node)
+{
+  return (char *)node+__STDSLABLIST_HDR;
+}
+
+// Get the node that stores `value`.
+StdListNode *
+stdslablist_node(void *value)
+{
+  return (StdListNode *)((char *)value-__STDSLABLIST_HDR);
+}
+
+// Private function to get a node from the pool.
+StdListNode *
+__stdslablist_alloc(StdSlabList *list)
+{
+  return stdpool_alloc(&list->pool);
+}
+
+// Private function to give `node` back to the pool.
+void
+__stdslablist_release(StdSlabList *list, StdListNode *node)
+{
+  stdpool_dealloc(&list->pool, node);
+}
+
+// Get the number of values in `list`.
+size_t
+stdslablist_len(StdSlabList *list)
+{
+  return list->list.len;
+}
+
+// Copy `value` to the front of `list`. Returns
+// a pointer to the stored copy.
+void *
+stdslablist_push_front(StdSlabList *list, const void *value)
+{
+  StdListNode *node = __stdslablist_alloc(list);
+  (void)memcpy(stdslablist_value(node), value, list->stride);
+  stdlist_push_front(&list->list, node);
+  return stdslablist_value(node);
+}
+
+// Copy `value` to the end of `list`. Returns
+// a pointer to the stored copy.
+void *
+stdslablist_push_back(StdSlabList *list, const void *value)
+{
+  StdListNode *node = __stdslablist_alloc(list);
+  (void)memcpy(stdslablist_value(node), value, list->stride);
+  stdlist_push_back(&list->list, node);
+  return stdslablist_value(node);
+}
+
+// Get the first value of `list`, or NULL if it is empty.
+void *
+stdslablist_front(StdSlabList *list)
+{
+  return list->list.head ? stdslablist_value(list->list.head) : NULL;
+}
+
+// Get the last value of `list`, or NULL if it is empty.
+void *
+stdslablist_back(StdSlabList *list)
+{
+  return list->list.tail ? stdslablist_value(list->list.tail) : NULL;
+}
+
+// Remove the stored `value` (as returned by a push or
+// front/back) from `list` in O(1).
+void
+stdslablist_rm(StdSlabList *list, void *value)
+{
+  StdListNode *node = stdslablist_node(value);
+  stdlist_unlink(&list->list, node);
+  __stdslablist_release(list, node);
+}
+
+// Remove the first value of `list`, copying it into
+// `out` if `out` is not NULL. Panics if `list` is empty.
+void
+stdslablist_pop_front(StdSlabList *list, void *out)
+{
+  StdListNode *node = stdlist_pop_front(&list->list);
+  if (!node) {
+    __STD_PANIC("tried to pop from an empty list");
+  }
+  if (out) {
+    (void)memcpy(out, stdslablist_value(node), list->stride);
+  }
+  __stdslablist_release(list, node);
+}
+
+// Remove the last value of `list`, copying it into
+// `out` if `out` is not NULL. Panics if `list` is empty.
+void
+stdslablist_pop_back(StdSlabList *list, void *out)
+{
+  StdListNode *node = stdlist_pop_back(&list->list);
+  if (!node) {
+    __STD_PANIC("tried to pop from an empty list");
+  }
+  if (out) {
+    (void)memcpy(out, stdslablist_value(node), list->stride);
+  }
+  __stdslablist_release(list, node);
+}
+
+// Move the stored `value` to the front of `list`.
+void
+stdslablist_move_to_front(StdSlabList *list, void *value)
+{
+  stdlist_move_to_front(&list->list, stdslablist_node(value));
+}
+
+#endif // STDLIST_IMPL
+
+//////////////////////////////
+// StdThreadPool IMPLEMENTATION
+#ifdef STDTHREADPOOL_IMPL
+
+// A work-stealing thread pool. Every worker owns a
+// Chase-Lev deque: it pushes and pops tasks at the bottom
+// while idle workers steal from the top of other deques.
+// Tasks submitted from outside of the pool go through a
+// shared injection queue. Idle workers spin for a while
+// and then sleep until new work shows up.
+//
+// Threads that wait on a StdFuture or StdTaskGroup run
+// other tasks while they wait, so nested fork-join never
+// deadlocks the pool.
+
+typedef void *(*StdTaskFunc)(void *arg);
+
+// Called on a chunk of `n` elements starting at `first`,
+// which is the element at index `begin` of the array.
+typedef void (*StdRangeFunc)(void *first, size_t begin, size_t n, void *ctx);
+
+struct __StdTask
+{
+  void (*run)(struct __StdTask *task);
+  StdTaskFunc fn;
+  void *arg;
+  void **result;
+  _Atomic size_t *pending;
+  size_t begin;
+  size_t end;
+};
+
+struct __StdDequeArray
+{
+  size_t cap;  // Always a power of two
+  struct __StdDequeArray *prev;  // Retired arrays, freed with the deque
+  _Atomic(struct __StdTask *) buf[];
+};
+
+struct __StdDeque
+{
+  _Alignas(__STD_CACHE_LINE) _Atomic int64_t top;
+  _Alignas(__STD_CACHE_LINE) _Atomic int64_t bottom;
+  _Atomic(struct __StdDequeArray *) array;
+};
+
+struct __StdWorker
+{
+  struct __StdDeque deque;
+  struct StdThreadPool *pool;
+  pthread_t thread;
+  uint64_t rng;
+};
+
+struct StdThreadPool
+{
+  struct __StdWorker *workers;
+  size_t nworkers;
+  StdPool tasks;              // Task records
+  StdPool futures;            // Futures of submitted tasks
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  StdQueue inject;            // Tasks from outside, guarded by `lock`
+  _Atomic size_t inject_len;
+  _Atomic size_t queued;      // Tasks pushed but not yet picked up
+  _Atomic size_t sleepers;
+  _Atomic int stop;
+};
+typedef struct StdThreadPool StdThreadPool;
+
+// A set of tasks that can be waited on together.
+// It must stay in place until stdtaskgroup_wait returns.
+struct StdTaskGroup
+{
+  StdThreadPool *pool;
+  _Atomic size_t pending;
+};
+typedef struct StdTaskGroup StdTaskGroup;
+
+// The result of a single submitted task.
+struct StdFuture
+{
+  StdTaskGroup group;
+  void *result;
+};
+typedef struct StdFuture StdFuture;
+
+static _Thread_local struct __StdWorker *__stdthreadpool_self = NULL;
+
+// Private function to make a deque array with `cap` slots.
+struct __StdDequeArray *
+__stddeque_array_new(size_t cap)
+{
+  struct __StdDequeArray *a = __STD_S_MALLOC(sizeof(*a)+cap*sizeof(a->buf[0]));
+  a->cap = cap;
+  a->prev = NULL;
+  return a;
+}
+
+// Private function to push `task` at the bottom
+// of `dq`. Only the owner may call this.
+void
+__stddeque_push(struct __StdDeque *dq, struct __StdTask *task)
+{
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+  int64_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+  struct __StdDequeArray *a = atomic_load_explicit(&dq->array, memory_order_relaxed);
+  if (b-t > (int64_t)a->cap-1) {
+    // Grow. Thieves may still be reading the old
+    // array, so it is only freed with the deque.
+    struct __StdDequeArray *grown = __stddeque_array_new(a->cap*2);
+    for (int64_t i = t; i < b; ++i) {
+      atomic_store_explicit(&grown->buf[i & (grown->cap-1)],
+                            atomic_load_explicit(&a->buf[i & (a->cap-1)], memory_order_relaxed),
+                            memory_order_relaxed);
+    }
+    grown->prev = a;
+    atomic_store_explicit(&dq->array, grown, memory_order_release);
+    a = grown;
+  }
+  atomic_store_explicit(&a->buf[b & (a->cap-1)], task, memory_order_relaxed);
+  atomic_store_explicit(&dq->bottom, b+1, memory_order_release);
+}
+
+// Private function to pop a task from the bottom of `dq`.
+// Only the owner may call this. Returns NULL if empty.
+struct __StdTask *
+__stddeque_take(struct __StdDeque *dq)
+{
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_relaxed)-1;
+  struct __StdDequeArray *a = atomic_load_explicit(&dq->array, memory_order_relaxed);
+  atomic_store_explicit(&dq->bottom, b, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t t = atomic_load_explicit(&dq->top, memory_order_relaxed);
+  struct __StdTask *task = NULL;
+  if (t <= b) {
+    task = atomic_load_explicit(&a->buf[b & (a->cap-1)], memory_order_relaxed);
+    if (t == b) {
+      // Last element, race the thieves for it.
+      if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t+1, memory_order_seq_cst,
+                                                   memory_order_relaxed)) {
+        task = NULL;
+      }
+      atomic_store_explicit(&dq->bottom, b+1, memory_order_relaxed);
+    }
+  } else {
+    atomic_store_explicit(&dq->bottom, b+1, memory_order_relaxed);
+  }
+  return task;
+}
+
+// Private function to steal a task from the top of
+// `dq`. Any thread may call this. Returns NULL if
+// `dq` is empty or another thread won the race.
+struct __StdTask *
+__stddeque_steal(struct __StdDeque *dq)
+{
+  int64_t t = atomic_load_explicit(&dq->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  int64_t b = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+  if (t >= b) {
+    return NULL;
+  }
+  struct __StdDequeArray *a = atomic_load_explicit(&dq->array, memory_order_acquire);
+  struct __StdTask *task = atomic_load_explicit(&a->buf[t & (a->cap-1)], memory_order_relaxed);
+  if (!atomic_compare_exchange_strong_explicit(&dq->top, &t, t+1, memory_order_seq_cst,
+                                               memory_order_relaxed)) {
+    return NULL;
+  }
+  return task;
+}
+
+// Private function to queue `task` on `pool` and wake
+// up a sleeping worker if there is one. Workers push to
+// their own deque, other threads to the injection queue.
+void
+__stdthreadpool_push(StdThreadPool *pool, struct __StdTask *task)
+{
+  struct __StdWorker *self = __stdthreadpool_self;
+  if (self && self->pool == pool) {
+    __stddeque_push(&self->deque, task);
+  } else {
+    pthread_mutex_lock(&pool->lock);
+    stdqueue_enqueue(&pool->inject, &task);
+    atomic_fetch_add(&pool->inject_len, 1);
+    pthread_mutex_unlock(&pool->lock);
+  }
+  atomic_fetch_add(&pool->queued, 1);
+  if (atomic_load(&pool->sleepers) > 0) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
+
+// Private function to find a task for the calling
+// thread: its own deque first, then the injection
+// queue, then the deques of random other workers.
+struct __StdTask *
+__stdthreadpool_find(StdThreadPool *pool)
+{
+  struct __StdWorker *self = __stdthreadpool_self;
+  struct __StdTask *task = NULL;
+  if (self && self->pool != pool) {
+    self = NULL;
+  }
+  if (self) {
+    task = __stddeque_take(&self->deque);
+  }
+  if (!task && atomic_load_explicit(&pool->inject_len, memory_order_relaxed) > 0) {
+    pthread_mutex_lock(&pool->lock);
+    if (!stdqueue_empty(&pool->inject)) {
+      task = *(struct __StdTask **)stdqueue_peek(&pool->inject);
+      stdqueue_dequeue(&pool->inject);
+      atomic_fetch_sub(&pool->inject_len, 1);
+    }
+    pthread_mutex_unlock(&pool->lock);
+  }
+  if (!task) {
+    uint64_t r = self ? self->rng : (uint64_t)(uintptr_t)&task;
+    size_t start = (size_t)(r % pool->nworkers);
+    for (size_t i = 0; i < pool->nworkers && !task; ++i) {
+      struct __StdWorker *victim = &pool->workers[(start+i) % pool->nworkers];
+      if (victim != self) {
+        task = __stddeque_steal(&victim->deque);
+      }
+    }
+    if (self) {
+      self->rng ^= self->rng << 13;
+      self->rng ^= self->rng >> 7;
+      self->rng ^= self->rng << 17;
+    }
+  }
+  if (task) {
+    atomic_fetch_sub(&pool->queued, 1);
+  }
+  return task;
+}
+
+// Private function to run `task` and recycle it.
+void
+__stdthreadpool_run(StdThreadPool *pool, struct __StdTask *task)
+{
+  _Atomic size_t *pending = task->pending;
+  task->run(task);
+  stdpool_dealloc(&pool->tasks, task);
+  if (pending) {
+    atomic_fetch_sub_explicit(pending, 1, memory_order_release);
+  }
+}
+
+// Private runner for plain StdTaskFunc tasks.
+void
+__stdthreadpool_run_fn(struct __StdTask *task)
+{
+  void *result = task->fn(task->arg);
+  if (task->result) {
+    *task->result = result;
+  }
+}
+
+// Private main loop of every worker thread.
+void *
+__stdthreadpool_worker(void *arg)
+{
+  struct __StdWorker *self = (struct __StdWorker *)arg;
+  StdThreadPool *pool = self->pool;
+  unsigned spins = 0;
+  __stdthreadpool_self = self;
+
+  while (!atomic_load(&pool->stop)) {
+    struct __StdTask *task = __stdthreadpool_find(pool);
+    if (task) {
+      __stdthreadpool_run(pool, task);
+      spins = 0;
+      continue;
+    }
+    if (spins < 128) {
+      __std_backoff(&spins);
+      continue;
+    }
+    // Nothing to do for a while, go to sleep. Pushers
+    // bump `queued` before they look at `sleepers`, and
+    // we bump `sleepers` before we look at `queued`,
+    // so a wakeup cannot be missed.
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->sleepers, 1);
+    while (!atomic_load(&pool->stop) && atomic_load(&pool->queued) == 0) {
+      pthread_cond_wait(&pool->cond, &pool->lock);
+    }
+    atomic_fetch_sub(&pool->sleepers, 1);
+    pthread_mutex_unlock(&pool->lock);
+    spins = 0;
+  }
+  return NULL;
+}
+
+// Create a new StdThreadPool with `nworkers` threads.
+// If `nworkers` is 0, one thread per online CPU is used.
+StdThreadPool *
+stdthreadpool_new(size_t nworkers)
+{
+  if (nworkers == 0) {
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nworkers = ncpus < 1 ? 1 : (size_t)ncpus;
+  }
+  StdThreadPool *pool = __STD_S_MALLOC(sizeof(StdThreadPool));
+  pool->nworkers = nworkers;
+  stdpool_init_mt(&pool->tasks, sizeof(struct __StdTask));
+  stdpool_init_mt(&pool->futures, sizeof(StdFuture));
+  pool->inject = stdqueue_new(sizeof(struct __StdTask *));
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->cond, NULL);
+  atomic_init(&pool->inject_len, 0);
+  atomic_init(&pool->queued, 0);
+  atomic_init(&pool->sleepers, 0);
+  atomic_init(&pool->stop, 0);
+
+  pool->workers = __STD_ALIGNED_ALLOC(__STD_CACHE_LINE, nworkers*sizeof(struct __StdWorker));
+  __STD_CHECK_MEM(pool->workers);
+  for (size_t i = 0; i < nworkers; ++i) {
+    struct __StdWorker *w = &pool->workers[i];
+    w->pool = pool;
+    w->rng = 0x9e3779b97f4a7c15ull*(i+1);
+    atomic_init(&w->deque.top, 0);
+    atomic_init(&w->deque.bottom, 0);
+    atomic_init(&w->deque.array, __stddeque_array_new(256));
+  }
+  for (size_t i = 0; i < nworkers; ++i) {
+    if (pthread_create(&pool->workers[i].thread, NULL, __stdthreadpool_worker,
+                       &pool->workers[i]) != 0) {
+      __STD_PANIC("could not create worker thread %zu", i);
+    }
+  }
+  return pool;
+}
+
+// Stop and join every worker of `pool` and free it.
+// Tasks that have not started yet are dropped, so wait
+// on your futures and task groups first.
+void
+stdthreadpool_free(StdThreadPool *pool)
+{
+  pthread_mutex_lock(&pool->lock);
+  atomic_store(&pool->stop, 1);
+  pthread_cond_broadcast(&pool->cond);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 0; i < pool->nworkers; ++i) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  for (size_t i = 0; i < pool->nworkers; ++i) {
+    struct __StdDequeArray *a = atomic_load(&pool->workers[i].deque.array);
+    while (a) {
+      struct __StdDequeArray *prev = a->prev;
+      __STD_FREE(a);
+      a = prev;
+    }
+  }
+  __STD_FREE(pool->workers);
+  stdqueue_free(&pool->inject);
+  stdpool_free(&pool->tasks);
+  stdpool_free(&pool->futures);
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->lock);
+  __STD_FREE(pool);
+}
+
+// Private function to create the default pool.
+static StdThreadPool *__stdthreadpool_default_pool = NULL;
+static pthread_once_t __stdthreadpool_default_once = PTHREAD_ONCE_INIT;
+
+void
+__stdthreadpool_default_init(void)
+{
+  __stdthreadpool_default_pool = stdthreadpool_new(0);
+}
+
+// Get the shared default pool, which has one worker
+// per online CPU. It is created on first use and
+// lives until the program exits.
+StdThreadPool *
+stdthreadpool_default(void)
+{
+  pthread_once(&__stdthreadpool_default_once, __stdthreadpool_default_init);
+  return __stdthreadpool_default_pool;
+}
+
+// Private function to get a task record.
+struct __StdTask *
+__stdthreadpool_task(StdThreadPool *pool, void (*run)(struct __StdTask *),
+                     _Atomic size_t *pending)
+{
+  struct __StdTask *task = stdpool_alloc(&pool->tasks);
+  task->run = run;
+  task->fn = NULL;
+  task->arg = NULL;
+  task->result = NULL;
+  task->pending = pending;
+  if (pending) {
+    atomic_fetch_add_explicit(pending, 1, memory_order_relaxed);
+  }
+  return task;
+}
+
+// Run one queued task of `pool` on the calling thread,
+// if there is one. Returns 1 if a task was run.
+int
+stdthreadpool_help(StdThreadPool *pool)
+{
+  struct __StdTask *task = __stdthreadpool_find(pool);
+  if (!task) {
+    return 0;
+  }
+  __stdthreadpool_run(pool, task);
+  return 1;
+}
+
+// Create a new, empty StdTaskGroup on `pool`.
+StdTaskGroup
+stdtaskgroup_new(StdThreadPool *pool)
+{
+  StdTaskGroup group;
+  group.pool = pool;
+  atomic_init(&group.pending, 0);
+  return group;
+}
+
+// Run `fn(arg)` on the pool of `group`. The result is
+// dropped. Tasks may spawn more tasks into the same group.
+void
+stdtaskgroup_spawn(StdTaskGroup *group, StdTaskFunc fn, void *arg)
+{
+  struct __StdTask *task = __stdthreadpool_task(group->pool, __stdthreadpool_run_fn,
+                                                &group->pending);
+  task->fn = fn;
+  task->arg = arg;
+  __stdthreadpool_push(group->pool, task);
+}
+
+// Wait until every task spawned into `group` is
+// done, running queued tasks in the meantime.
+void
+stdtaskgroup_wait(StdTaskGroup *group)
+{
+  unsigned spins = 0;
+  while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+    if (stdthreadpool_help(group->pool)) {
+      spins = 0;
+    } else {
+      __std_backoff(&spins);
+    }
+  }
+}
+
+// Submit `fn(arg)` to `pool`. Get the result with
+// stdfuture_get, which also frees the future, before
+// `pool` is freed. Futures come from a pool of their
+// own, so once it is warm submitting does not malloc.
+StdFuture *
+stdthreadpool_submit(StdThreadPool *pool, StdTaskFunc fn, void *arg)
+{
+  StdFuture *future = stdpool_alloc(&pool->futures);
+  future->group = stdtaskgroup_new(pool);
+  future->result = NULL;
+  struct __StdTask *task = __stdthreadpool_task(pool, __stdthreadpool_run_fn,
+                                                &future->group.pending);
+  task->fn = fn;
+  task->arg = arg;
+  task->result = &future->result;
+  __stdthreadpool_push(pool, task);
+  return future;
+}
+
+// Returns 1 if the task of `future` is done, 0 otherwise.
+int
+stdfuture_ready(StdFuture *future)
+{
+  return atomic_load_explicit(&future->group.pending, memory_order_acquire) == 0;
+}
+
+// Wait for the task of `future` and return its result.
+// `future` is freed and may not be used afterwards.
+void *
+stdfuture_get(StdFuture *future)
+{
+  stdtaskgroup_wait(&future->group);
+  void *result = future->result;
+  stdpool_dealloc(&future->group.pool->futures, future);
+  return result;
+}
+
+struct __StdParallelFor
+{
+  void *arr;
+  size_t stride;
+  size_t grain;
+  StdRangeFunc fn;
+  void *ctx;
+  StdTaskGroup *group;
+};
+
+// Private runner for parallel_for ranges. Splits off the
+// upper half as a new task until the range is at most
+// `grain` elements, then runs `fn` on what is left.
+void
+__stdthreadpool_run_range(struct __StdTask *task)
+{
+  struct __StdParallelFor *pf = (struct __StdParallelFor *)task->arg;
+  size_t begin = task->begin, end = task->end;
+  while (end-begin > pf->grain) {
+    size_t mid = begin+(end-begin)/2;
+    struct __StdTask *half = __stdthreadpool_task(pf->group->pool, __stdthreadpool_run_range,
+                                                  &pf->group->pending);
+    half->arg = pf;
+    half->begin = mid;
+    half->end = end;
+    __stdthreadpool_push(pf->group->pool, half);
+    end = mid;
+  }
+  pf->fn(pf->arr+begin*pf->stride, begin, end-begin, pf->ctx);
+}
+
+// Call `fn` on chunks of at most `grain` elements that
+// together cover all `len` elements of `arr` on `pool`,
+// and wait for all of them. The calling thread takes part.
+// If `grain` is 0, a grain is picked from the pool size.
+void
+stdthreadpool_parallel_for(StdThreadPool *pool, void *arr, size_t stride, size_t len,
+                           size_t grain, StdRangeFunc fn, void *ctx)
+{
+  if (len == 0) {
+    return;
+  }
+  if (grain == 0) {
+    grain = len/(8*pool->nworkers);
+    grain = grain < 1 ? 1 : grain;
+  }
+  StdTaskGroup group = stdtaskgroup_new(pool);
+  struct __StdParallelFor pf = {
+    .arr = arr,
+    .stride = stride,
+    .grain = grain,
+    .fn = fn,
+    .ctx = ctx,
+    .group = &group,
+  };
+  // Run the root range right here.
+  struct __StdTask root = {
+    .run = __stdthreadpool_run_range,
+    .arg = &pf,
+    .begin = 0,
+    .end = len,
+  };
+  root.run(&root);
+  stdtaskgroup_wait(&group);
+}
+
+// Same as stdthreadpool_parallel_for on the default pool.
+void
+std_parallel_for(void *arr, size_t stride, size_t len, size_t grain, StdRangeFunc fn, void *ctx)
+{
+  stdthreadpool_parallel_for(stdthreadpool_default(), arr, stride, len, grain, fn, ctx);
+}
+
+#endif // STDTHREADPOOL_IMPL
+
+//////////////////////////////
+// Parallel Functions IMPLEMENTATION
+#ifdef STDPARFUNCS_IMPL
+
+// Parallel versions of the functions in STDFUNCS_IMPL.
+// They run on the default StdThreadPool and take an extra
+// `ctx` that is passed to every call of `boolfunc`, so the
+// predicate may carry state. `boolfunc` must be safe to
+// call from many threads at once.
+
+typedef int (*StdPredFunc)(const void *elem, void *ctx);
+
+// Below this many elements the functions just run serially.
+#define __STDPARFUNCS_SERIAL 16384
+
+// How many elements a worker checks between looks
+// at the shared `decided` flag.
+#define __STDPARFUNCS_BLOCK 1024
+
+struct __StdParPred
+{
+  StdPredFunc boolfunc;
+  void *ctx;
+  size_t stride;
+  int decides;            // The predicate result that decides the answer
+  _Atomic int decided;
+};
+
+// Private range function that looks for an element where
+// `boolfunc` returns `decides`. As soon as any worker finds
+// one it sets `decided`, and every other worker stops at
+// its next block boundary (or does not start at all).
+void
+__stdparfuncs_scan(void *first, size_t begin, size_t n, void *arg)
+{
+  struct __StdParPred *pp = (struct __StdParPred *)arg;
+  (void)begin;
+  for (size_t i = 0; i < n; i += __STDPARFUNCS_BLOCK) {
+    if (atomic_load_explicit(&pp->decided, memory_order_relaxed)) {
+      return;
+    }
+    size_t end = i+__STDPARFUNCS_BLOCK < n ? i+__STDPARFUNCS_BLOCK : n;
+    for (size_t j = i; j < end; ++j) {
+      if (!!pp->boolfunc(first+j*pp->stride, pp->ctx) == pp->decides) {
+        atomic_store_explicit(&pp->decided, 1, memory_order_relaxed);
+        return;
+      }
+    }
+  }
+}
+
+// Private function that returns 1 if `boolfunc` returns
+// `decides` for any element of `arr`, 0 otherwise.
+int
+__stdparfuncs_find(void *arr, size_t stride, size_t len, StdPredFunc boolfunc, void *ctx,
+                   int decides)
+{
+  struct __StdParPred pp = {
+    .boolfunc = boolfunc,
+    .ctx = ctx,
+    .stride = stride,
+    .decides = decides,
+  };
+  atomic_init(&pp.decided, 0);
+  if (len < __STDPARFUNCS_SERIAL) {
+    __stdparfuncs_scan(arr, 0, len, &pp);
+  } else {
+    StdThreadPool *pool = stdthreadpool_default();
+    size_t grain = len/(8*pool->nworkers);
+    grain = grain < __STDPARFUNCS_BLOCK ? __STDPARFUNCS_BLOCK : grain;
+    stdthreadpool_parallel_for(pool, arr, stride, len, grain, __stdparfuncs_scan, &pp);
+  }
+  return atomic_load(&pp.decided);
+}
+
+// Returns 1 if all elements in `arr` satisfy
+// the function `boolfunc`. Otherwise it
+// returns 0.
+int
+stdall_of_par(void *arr, size_t stride, size_t len, StdPredFunc boolfunc, void *ctx)
+{
+  return !__stdparfuncs_find(arr, stride, len, boolfunc, ctx, 0);
+}
+
+// Returns 1 if any elements in `arr` satisfy
+// the function `boolfunc`. Otherwise it
+// returns 0.
+int
+stdany_of_par(void *arr, size_t stride, size_t len, StdPredFunc boolfunc, void *ctx)
+{
+  return __stdparfuncs_find(arr, stride, len, boolfunc, ctx, 1);
+}
+
+// Returns 1 if none of the elements in `arr` satisfy
+// the function `boolfunc`. Otherwise it
+// returns 0.
+int
+stdnone_of_par(void *arr, size_t stride, size_t len, StdPredFunc boolfunc, void *ctx)
+{
+  return !__stdparfuncs_find(arr, stride, len, boolfunc, ctx, 1);
+}
+
+// Parallel prefix sums, in two passes over chunks of at
+// least __STDPARFUNCS_SERIAL elements: the first pass
+// sums up each chunk, a short serial pass turns those
+// sums into the carry into each chunk, and the second
+// pass scans every chunk from its carry. The last
+// chunk's sum is never needed, so it is not computed.
+struct __StdParScan
+{
+  const void *in;
+  void *out;
+  size_t stride;
   size_t len;
-  size_t cap;
-  size_t head;  // Index of the front of the queue
+  size_t chunk;
+  void *sums;             // The sum of each chunk, then the carry out of it
+  StdReduceFunc op;
+  int exclusive;
+  const void *init;
+};
+
+// Private function that splits `len` elements into
+// chunks for a parallel scan. Returns the chunk count.
+size_t
+__stdparfuncs_chunks(size_t len, size_t *chunk)
+{
+  size_t nworkers = stdthreadpool_default()->nworkers;
+  size_t c = (len+4*nworkers-1)/(4*nworkers);
+  *chunk = c < __STDPARFUNCS_SERIAL ? __STDPARFUNCS_SERIAL : c;
+  return (len+*chunk-1)/(*chunk);
+}
+
+// Private range functions of std_inclusive_scan_par, over
+// chunk indices. The first folds each chunk into its
+// slot of `sums`, the second scans each chunk.
+void
+__stdparfuncs_fold_chunk(void *first, size_t begin, size_t n, void *arg)
+{
+  struct __StdParScan *ps = (struct __StdParScan *)arg;
+  const char *in = ps->in;
+  char *sums = first;
+  for (size_t c = begin; c < begin+n; ++c, sums += ps->stride) {
+    size_t lo = c*ps->chunk;
+    size_t hi = lo+ps->chunk < ps->len ? lo+ps->chunk : ps->len;
+    (void)memcpy(sums, in+lo*ps->stride, ps->stride);
+    for (size_t i = lo+1; i < hi; ++i) {
+      ps->op(sums, in+i*ps->stride);
+    }
+  }
+}
+
+void
+__stdparfuncs_scan_chunk(void *first, size_t begin, size_t n, void *arg)
+{
+  struct __StdParScan *ps = (struct __StdParScan *)arg;
+  const char *in = ps->in;
+  char *out = ps->out;
+  char acc[ps->stride], x[ps->stride];
+  (void)first;
+  for (size_t c = begin; c < begin+n; ++c) {
+    size_t lo = c*ps->chunk;
+    size_t hi = lo+ps->chunk < ps->len ? lo+ps->chunk : ps->len;
+    if (c == 0) {
+      std_inclusive_scan(in, out, ps->stride, hi, ps->op);
+      continue;
+    }
+    (void)memcpy(acc, (char *)ps->sums+(c-1)*ps->stride, ps->stride);
+    for (size_t i = lo; i < hi; ++i) {
+      (void)memcpy(x, in+i*ps->stride, ps->stride);
+      ps->op(acc, x);
+      (void)memcpy(out+i*ps->stride, acc, ps->stride);
+    }
+  }
+}
+
+// Same as std_inclusive_scan, on the default
+// StdThreadPool. `op` must be associative, since the
+// chunks are folded separately, but it need not be
+// commutative, and it must be safe to call from many
+// threads at once. `in` and `out` may be the same array.
+void
+std_inclusive_scan_par(const void *in, void *out, size_t stride, size_t len, StdReduceFunc op)
+{
+  if (len < __STDPARFUNCS_SERIAL) {
+    std_inclusive_scan(in, out, stride, len, op);
+    return;
+  }
+  size_t chunk, nchunks = __stdparfuncs_chunks(len, &chunk);
+  struct __StdParScan ps = {
+    .in = in,
+    .out = out,
+    .stride = stride,
+    .len = len,
+    .chunk = chunk,
+    .sums = __STD_S_MALLOC(nchunks*stride),
+    .op = op,
+  };
+  std_parallel_for(ps.sums, stride, nchunks-1, 1, __stdparfuncs_fold_chunk, &ps);
+  char *sums = ps.sums, x[stride];
+  for (size_t c = 1; c+1 < nchunks; ++c) {
+    (void)memcpy(x, sums+c*stride, stride);
+    (void)memcpy(sums+c*stride, sums+(c-1)*stride, stride);
+    op(sums+c*stride, x);
+  }
+  std_parallel_for(ps.sums, stride, nchunks, 1, __stdparfuncs_scan_chunk, &ps);
+  __STD_FREE(ps.sums);
+}
+
+// Private: generates the range functions and the public
+// functions of the typed parallel scans for one type,
+// on top of the SIMD kernels of STDFUNCS_IMPL.
+#define __STD_PAR_SCAN_DECL(sfx, type, atype)                           \
+  void                                                                  \
+  __stdparfuncs_sum_chunk_##sfx(void *first, size_t begin, size_t n, void *arg) \
+  {                                                                     \
+    struct __StdParScan *ps = (struct __StdParScan *)arg;               \
+    const type *in = ps->in;                                            \
+    atype *sums = first;                                                \
+    for (size_t c = begin; c < begin+n; ++c) {                          \
+      size_t lo = c*ps->chunk;                                          \
+      size_t hi = lo+ps->chunk < ps->len ? lo+ps->chunk : ps->len;      \
+      *sums++ = __std_sum_##sfx(in+lo, hi-lo);                          \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  __stdparfuncs_scan_chunk_##sfx(void *first, size_t begin, size_t n, void *arg) \
+  {                                                                     \
+    struct __StdParScan *ps = (struct __StdParScan *)arg;               \
+    const type *in = ps->in;                                            \
+    type *out = ps->out;                                                \
+    const atype *sums = ps->sums;                                       \
+    atype init = ps->exclusive ? (atype)*(const type *)ps->init : 0;    \
+    (void)first;                                                        \
+    for (size_t c = begin; c < begin+n; ++c) {                          \
+      size_t lo = c*ps->chunk;                                          \
+      size_t hi = lo+ps->chunk < ps->len ? lo+ps->chunk : ps->len;      \
+      atype carry = c == 0 ? init : init+sums[c-1];                     \
+      (void)__std_scan_##sfx(in+lo, out+lo, hi-lo, carry, ps->exclusive); \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  __std_scan_par_##sfx(const type *in, type *out, size_t len, int exclusive, type init) \
+  {                                                                     \
+    size_t chunk, nchunks = __stdparfuncs_chunks(len, &chunk);          \
+    struct __StdParScan ps = {                                          \
+      .in = in,                                                         \
+      .out = out,                                                       \
+      .len = len,                                                       \
+      .chunk = chunk,                                                   \
+      .sums = __STD_S_MALLOC(nchunks*sizeof(atype)),                    \
+      .exclusive = exclusive,                                           \
+      .init = &init,                                                    \
+    };                                                                  \
+    atype *sums = ps.sums;                                              \
+    std_parallel_for(sums, sizeof(atype), nchunks-1, 1,                 \
+                     __stdparfuncs_sum_chunk_##sfx, &ps);               \
+    for (size_t c = 1; c+1 < nchunks; ++c) {                            \
+      sums[c] += sums[c-1];                                             \
+    }                                                                   \
+    std_parallel_for(sums, sizeof(atype), nchunks, 1,                   \
+                     __stdparfuncs_scan_chunk_##sfx, &ps);              \
+    __STD_FREE(sums);                                                   \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  std_inclusive_scan_par_##sfx(const type *in, type *out, size_t len)   \
+  {                                                                     \
+    if (len < __STDPARFUNCS_SERIAL) {                                   \
+      std_inclusive_scan_##sfx(in, out, len);                           \
+    } else {                                                            \
+      __std_scan_par_##sfx(in, out, len, 0, 0);                         \
+    }                                                                   \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  std_exclusive_scan_par_##sfx(const type *in, type *out, size_t len, type init) \
+  {                                                                     \
+    if (len < __STDPARFUNCS_SERIAL) {                                   \
+      std_exclusive_scan_##sfx(in, out, len, init);                     \
+    } else {                                                            \
+      __std_scan_par_##sfx(in, out, len, 1, init);                      \
+    }                                                                   \
+  }
+
+// Typed parallel prefix sums, with the same results as
+// the serial ones for integers:
+//   std_inclusive_scan_par_<type>(in, out, len)
+//   std_exclusive_scan_par_<type>(in, out, len, init)
+// Float sums are added up in a different order, so the
+// results can differ from the serial ones by rounding.
+__STD_PAR_SCAN_DECL(i32, int32_t, uint32_t)
+__STD_PAR_SCAN_DECL(i64, int64_t, uint64_t)
+__STD_PAR_SCAN_DECL(f32, float, float)
+__STD_PAR_SCAN_DECL(f64, double, double)
+
+#endif // STDPARFUNCS_IMPL
+
+//////////////////////////////
+// StdBitset IMPLEMENTATION
+#ifdef STDBITSET_IMPL
+
+// Words covered by one entry of the rank index.
+#define __STDBITSET_RANK_WORDS 8
+
+// A dynamic array of bits stored 64 to a word. Bits
+// past `len` in the last word are always 0, so whole
+// words can be counted and compared. `ranks` holds the
+// number of set bits before every block of
+// __STDBITSET_RANK_WORDS words. It is rebuilt by
+// stdbitset_rank/stdbitset_select after the bitset
+// was modified.
+struct StdBitset
+{
+  uint64_t *words;
+  size_t len;       // Number of bits
+  size_t nwords;
+  size_t cap;       // Allocated words
+  uint64_t *ranks;
+  int ranks_dirty;
+};
+typedef struct StdBitset StdBitset;
+
+// Private: words needed for `nbits` bits.
+static inline size_t
+__stdbitset_words(size_t nbits)
+{
+  return (nbits+63)/64;
+}
+
+// Private: clears the bits past `len` in the last word.
+static inline void
+__stdbitset_trim(StdBitset *bs)
+{
+  if (bs->len%64 != 0) {
+    bs->words[bs->nwords-1] &= ((uint64_t)1 << (bs->len%64))-1;
+  }
+}
+
+// Create a new StdBitset of `nbits` bits, all 0.
+StdBitset
+stdbitset_new(size_t nbits)
+{
+  StdBitset bs;
+  bs.len         = nbits;
+  bs.nwords      = __stdbitset_words(nbits);
+  bs.cap         = bs.nwords ? bs.nwords : 1;
+  bs.words       = __STD_CALLOC(bs.cap, sizeof(uint64_t));
+  bs.ranks       = NULL;
+  bs.ranks_dirty = 1;
+  __STD_CHECK_MEM(bs.words);
+  return bs;
+}
+
+// Free the underlying memory of `bs`.
+void
+stdbitset_free(StdBitset *bs)
+{
+  __STD_CHECK_MEM(bs->words);
+  __STD_FREE(bs->words);
+  __STD_FREE(bs->ranks);
+  bs->words = NULL;
+  bs->ranks = NULL;
+  bs->len = bs->nwords = bs->cap = 0;
+}
+
+// Grow or shrink `bs` to `nbits` bits.
+// New bits are 0.
+void
+stdbitset_resize(StdBitset *bs, size_t nbits)
+{
+  size_t nwords = __stdbitset_words(nbits);
+  if (nwords > bs->cap) {
+    size_t cap = bs->cap;
+    while (cap < nwords) {
+      cap *= 2;
+    }
+    bs->words = __STD_REALLOC(bs->words, cap*sizeof(uint64_t));
+    __STD_INSTR_WASTE((cap-nwords)*sizeof(uint64_t));
+    __STD_CHECK_MEM(bs->words);
+    bs->cap = cap;
+  }
+  if (nwords > bs->nwords) {
+    (void)memset(bs->words+bs->nwords, 0, (nwords-bs->nwords)*sizeof(uint64_t));
+  }
+  bs->len = nbits;
+  bs->nwords = nwords;
+  __stdbitset_trim(bs);
+  bs->ranks_dirty = 1;
+}
+
+// Set bit `i` to 1. Panics if `i` is out of range.
+void
+stdbitset_set(StdBitset *bs, size_t i)
+{
+  if (i >= bs->len) {
+    __STD_PANIC("bit %zu out of range of bitset of len %zu", i, bs->len);
+  }
+  bs->words[i/64] |= (uint64_t)1 << (i%64);
+  bs->ranks_dirty = 1;
+}
+
+// Set bit `i` to 0. Panics if `i` is out of range.
+void
+stdbitset_clear(StdBitset *bs, size_t i)
+{
+  if (i >= bs->len) {
+    __STD_PANIC("bit %zu out of range of bitset of len %zu", i, bs->len);
+  }
+  bs->words[i/64] &= ~((uint64_t)1 << (i%64));
+  bs->ranks_dirty = 1;
+}
+
+// Flip bit `i`. Panics if `i` is out of range.
+void
+stdbitset_flip(StdBitset *bs, size_t i)
+{
+  if (i >= bs->len) {
+    __STD_PANIC("bit %zu out of range of bitset of len %zu", i, bs->len);
+  }
+  bs->words[i/64] ^= (uint64_t)1 << (i%64);
+  bs->ranks_dirty = 1;
+}
+
+// Returns bit `i` of `bs`, 0 if `i` is out of range.
+int
+stdbitset_test(const StdBitset *bs, size_t i)
+{
+  return i < bs->len && (bs->words[i/64] >> (i%64)) & 1;
+}
+
+// Set every bit of `bs` to `value`.
+void
+stdbitset_fill(StdBitset *bs, int value)
+{
+  (void)memset(bs->words, value ? 0xff : 0, bs->nwords*sizeof(uint64_t));
+  __stdbitset_trim(bs);
+  bs->ranks_dirty = 1;
+}
+
+// Word-parallel operations, storing the result in
+// `dst`. `dst` keeps its length. If `src` is shorter
+// its missing bits count as 0 and bits of `src` past
+// the end of `dst` are ignored. `dst` and `src` may be
+// the same bitset.
+#define __STDBITSET_OP(name, expr, rest)                                \
+  void                                                                  \
+  name(StdBitset *dst, const StdBitset *src)                            \
+  {                                                                     \
+    size_t n = dst->nwords < src->nwords ? dst->nwords : src->nwords;   \
+    uint64_t *d = dst->words;                                           \
+    const uint64_t *s = src->words;                                     \
+    for (size_t i = 0; i < n; ++i) {                                    \
+      d[i] = expr;                                                      \
+    }                                                                   \
+    rest;                                                               \
+    __stdbitset_trim(dst);                                              \
+    dst->ranks_dirty = 1;                                               \
+  }
+
+// dst &= src
+__STDBITSET_OP(stdbitset_and, d[i] & s[i],
+               (void)memset(d+n, 0, (dst->nwords-n)*sizeof(uint64_t)))
+// dst |= src
+__STDBITSET_OP(stdbitset_or, d[i] | s[i], (void)0)
+// dst ^= src
+__STDBITSET_OP(stdbitset_xor, d[i] ^ s[i], (void)0)
+// dst &= ~src
+__STDBITSET_OP(stdbitset_andnot, d[i] & ~s[i], (void)0)
+
+// Private: number of set bits in `n` words.
+size_t
+__stdbitset_popcount_generic(const uint64_t *words, size_t n)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    count += (size_t)__builtin_popcountll(words[i]);
+  }
+  return count;
+}
+
+#ifdef __STD_X86
+// Private: same as above, built to use the
+// popcnt instruction.
+__attribute__((target("popcnt"))) size_t
+__stdbitset_popcount_hw(const uint64_t *words, size_t n)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    count += (size_t)__builtin_popcountll(words[i]);
+  }
+  return count;
+}
+#endif // __STD_X86
+
+// Private: popcount of `n` words, with the
+// popcnt instruction if the CPU has it.
+size_t
+__stdbitset_popcount(const uint64_t *words, size_t n)
+{
+#ifdef __STD_X86
+  if (__builtin_cpu_supports("popcnt")) {
+    return __stdbitset_popcount_hw(words, n);
+  }
+#endif
+  return __stdbitset_popcount_generic(words, n);
+}
+
+// Returns the number of set bits in `bs`.
+size_t
+stdbitset_count(const StdBitset *bs)
+{
+  return __stdbitset_popcount(bs->words, bs->nwords);
+}
+
+// Returns 1 if any bit of `bs` is set, 0 otherwise.
+int
+stdbitset_any(const StdBitset *bs)
+{
+  for (size_t i = 0; i < bs->nwords; ++i) {
+    if (bs->words[i]) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Returns 1 if every bit of `bs` is set, 0 otherwise.
+int
+stdbitset_all(const StdBitset *bs)
+{
+  size_t full = bs->len/64;
+  for (size_t i = 0; i < full; ++i) {
+    if (~bs->words[i]) {
+      return 0;
+    }
+  }
+  return bs->len%64 == 0
+    || bs->words[full] == ((uint64_t)1 << (bs->len%64))-1;
+}
+
+// Returns the index of the first set bit at or
+// after `from`, or `bs->len` if there is none.
+// Example usage:
+//   for (size_t i = stdbitset_next(&bs, 0); i < bs.len; i = stdbitset_next(&bs, i+1)) { ... }
+size_t
+stdbitset_next(const StdBitset *bs, size_t from)
+{
+  if (from >= bs->len) {
+    return bs->len;
+  }
+  size_t w = from/64;
+  uint64_t word = bs->words[w] & (~(uint64_t)0 << (from%64));
+  while (word == 0) {
+    if (++w == bs->nwords) {
+      return bs->len;
+    }
+    word = bs->words[w];
+  }
+  return w*64+(size_t)__builtin_ctzll(word);
+}
+
+// Private: rebuilds the rank index if `bs` changed.
+void
+__stdbitset_ranks(StdBitset *bs)
+{
+  if (!bs->ranks_dirty) {
+    return;
+  }
+  size_t nblocks = bs->nwords/__STDBITSET_RANK_WORDS+1;
+  __STD_FREE(bs->ranks);
+  bs->ranks = __STD_S_MALLOC(nblocks*sizeof(uint64_t));
+  uint64_t count = 0;
+  for (size_t b = 0; b < nblocks; ++b) {
+    bs->ranks[b] = count;
+    size_t first = b*__STDBITSET_RANK_WORDS;
+    size_t n = bs->nwords-first < __STDBITSET_RANK_WORDS
+      ? bs->nwords-first
+      : __STDBITSET_RANK_WORDS;
+    count += __stdbitset_popcount(bs->words+first, n);
+  }
+  bs->ranks_dirty = 0;
+}
+
+// Returns the number of set bits before bit `i`.
+// The first call after a modification builds an
+// index in O(len/64), later calls are O(1).
+size_t
+stdbitset_rank(StdBitset *bs, size_t i)
+{
+  if (i > bs->len) {
+    i = bs->len;
+  }
+  __stdbitset_ranks(bs);
+  size_t w = i/64;
+  size_t b = w/__STDBITSET_RANK_WORDS;
+  size_t count = (size_t)bs->ranks[b];
+  for (size_t j = b*__STDBITSET_RANK_WORDS; j < w; ++j) {
+    count += (size_t)__builtin_popcountll(bs->words[j]);
+  }
+  if (i%64 != 0) {
+    count += (size_t)__builtin_popcountll(bs->words[w] & (((uint64_t)1 << (i%64))-1));
+  }
+  return count;
+}
+
+// Returns the index of the set bit with rank `k`,
+// i.e., the k-th set bit counting from 0, or
+// `bs->len` if fewer than k+1 bits are set. Uses the
+// same index as stdbitset_rank.
+size_t
+stdbitset_select(StdBitset *bs, size_t k)
+{
+  __stdbitset_ranks(bs);
+  size_t nblocks = bs->nwords/__STDBITSET_RANK_WORDS+1;
+  // Last block whose rank is <= k.
+  size_t lo = 0, hi = nblocks;
+  while (hi-lo > 1) {
+    size_t mid = lo+(hi-lo)/2;
+    if (bs->ranks[mid] <= k) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  k -= (size_t)bs->ranks[lo];
+  for (size_t w = lo*__STDBITSET_RANK_WORDS; w < bs->nwords; ++w) {
+    uint64_t word = bs->words[w];
+    size_t count = (size_t)__builtin_popcountll(word);
+    if (k < count) {
+      while (k--) {
+        word &= word-1;
+      }
+      return w*64+(size_t)__builtin_ctzll(word);
+    }
+    k -= count;
+  }
+  return bs->len;
+}
+
+#endif // STDBITSET_IMPL
+
+//////////////////////////////
+// StdBloom IMPLEMENTATION
+#ifdef STDBLOOM_IMPL
+
+// Bits per block. A block is one cache line
+// and every key only touches its own block.
+#define __STDBLOOM_BLOCK_BITS 512
+#define __STDBLOOM_BLOCK_WORDS (__STDBLOOM_BLOCK_BITS/64)
+#define __STDBLOOM_MAX_K 16
+#define __STDBLOOM_MAGIC 0x4d4f4f4c42445453ull // "STDBLOOM"
+#define __STDBLOOM_VERSION 1
+
+// A blocked Bloom filter. stdbloom_contains never says
+// no for a key that was added, and says yes for a key
+// that was not with roughly the rate the filter was
+// sized for. Each key hashes to one 64 byte block and
+// sets `k` bits in it picked by enhanced double
+// hashing (the stride grows each step), so a
+// query is one cache miss.
+struct StdBloom
+{
+  uint64_t *words;
+  size_t nblocks;
+  uint32_t k;
+  uint64_t seed;
+  size_t count;     // Number of adds
 };
-typedef struct StdQueue StdQueue;
+typedef struct StdBloom StdBloom;
 
-// Create a new StdQueue with element
-// size being `stride`.
-StdQueue
-stdqueue_new(size_t stride)
+// Private: serialized header, followed by the words.
+struct __StdBloomHeader
 {
-  StdQueue queue;
-  queue.data   = __STD_S_MALLOC(stride);
-  queue.cap    = 1;
-  queue.len    = 0;
-  queue.head   = 0;
-  queue.stride = stride;
-  return queue;
+  uint64_t magic;
+  uint32_t version;
+  uint32_t k;
+  uint64_t nblocks;
+  uint64_t seed;
+  uint64_t count;
+};
+
+// Private: natural log, so sizing does not need libm.
+double
+__stdbloom_ln(double x)
+{
+  // x = m*2^e with m in [1, 2), then
+  // ln(m) = 2*atanh((m-1)/(m+1)).
+  int e = 0;
+  while (x >= 2.) {
+    x /= 2.;
+    ++e;
+  }
+  while (x < 1.) {
+    x *= 2.;
+    --e;
+  }
+  double t = (x-1.)/(x+1.), t2 = t*t, term = t, sum = 0.;
+  for (int i = 1; i < 40; i += 2) {
+    sum += term/i;
+    term *= t2;
+  }
+  return 2.*sum+e*0.69314718055994530942;
 }
 
-// Free the underlying memory of `queue`.
+// Private: e^x, also so sizing does not need libm.
+double
+__stdbloom_exp(double x)
+{
+  int halvings = 0;
+  while (x > .5 || x < -.5) {
+    x /= 2.;
+    ++halvings;
+  }
+  double sum = 1., term = 1.;
+  for (int i = 1; i < 20; ++i) {
+    term *= x/i;
+    sum += term;
+  }
+  while (halvings--) {
+    sum *= sum;
+  }
+  return sum;
+}
+
+// Private: false positive rate of a blocked filter
+// with `lambda` keys per block on average. The keys
+// in a block follow a Poisson distribution, and a
+// block with j keys answers yes to a missing key
+// with the textbook (1-(1-1/B)^(kj))^k.
+double
+__stdbloom_fp(double lambda, uint32_t k)
+{
+  double qk = 1.;
+  for (uint32_t i = 0; i < k; ++i) {
+    qk *= 1.-1./__STDBLOOM_BLOCK_BITS;
+  }
+  double pj = __stdbloom_exp(-lambda), qkj = 1., fp = 0.;
+  for (size_t j = 0; j < (size_t)(lambda*4.)+64; ++j) {
+    double hit = 1.;
+    for (uint32_t i = 0; i < k; ++i) {
+      hit *= 1.-qkj;
+    }
+    fp += pj*hit;
+    qkj *= qk;
+    pj *= lambda/(double)(j+1);
+  }
+  return fp;
+}
+
+// Private: allocates zeroed cache-line aligned words.
+uint64_t *
+__stdbloom_alloc(size_t nblocks)
+{
+  uint64_t *words = __STD_ALIGNED_ALLOC(__STD_CACHE_LINE, nblocks*__STD_CACHE_LINE);
+  __STD_CHECK_MEM(words);
+  (void)memset(words, 0, nblocks*__STD_CACHE_LINE);
+  return words;
+}
+
+// Create a new StdBloom for about `expected` keys
+// with a false positive rate of about `fp_rate`.
+// Example usage:
+//   StdBloom bf = stdbloom_new(100000, 0.01);
+//   stdbloom_add(&bf, &id, sizeof(id));
+//   if (stdbloom_contains(&bf, &id, sizeof(id))) { expensive_lookup(id); }
+StdBloom
+stdbloom_new(size_t expected, double fp_rate)
+{
+  if (expected == 0) {
+    expected = 1;
+  }
+  if (!(fp_rate > 0. && fp_rate < 1.)) {
+    __STD_PANIC("fp_rate must be in (0, 1), got %f", fp_rate);
+  }
+  double ln2 = 0.69314718055994530942;
+  double bits_per_key = -__stdbloom_ln(fp_rate)/(ln2*ln2);
+  StdBloom bf;
+  bf.nblocks = (size_t)((double)expected*bits_per_key/__STDBLOOM_BLOCK_BITS)+1;
+  bf.k       = (uint32_t)(bits_per_key*ln2+.5);
+  bf.k       = bf.k < 1 ? 1 : bf.k > __STDBLOOM_MAX_K ? __STDBLOOM_MAX_K : bf.k;
+  // Blocking spreads keys less evenly than the textbook
+  // filter, more so at low rates. Add blocks until the
+  // blocked rate meets the target.
+  while (__stdbloom_fp((double)expected/bf.nblocks, bf.k) > fp_rate) {
+    bf.nblocks += bf.nblocks/16+1;
+  }
+  bf.seed    = 0x9e3779b97f4a7c15ull;
+  bf.count   = 0;
+  bf.words   = __stdbloom_alloc(bf.nblocks);
+  return bf;
+}
+
+// Free the underlying memory of `bf`.
 void
-stdqueue_free(StdQueue *queue)
+stdbloom_free(StdBloom *bf)
 {
-  __STD_CHECK_MEM(queue->data);
-  free(queue->data);
-  queue->data = NULL;
-  queue->len = queue->cap = queue->stride = queue->head = 0;
+  __STD_CHECK_MEM(bf->words);
+  __STD_FREE(bf->words);
+  bf->words = NULL;
+  bf->nblocks = bf->count = 0;
 }
 
-// Returns 1 if queue is empty, 0 otherwise.
+// Remove every key from `bf`.
+void
+stdbloom_clr(StdBloom *bf)
+{
+  (void)memset(bf->words, 0, bf->nblocks*__STD_CACHE_LINE);
+  bf->count = 0;
+}
+
+// Private: the block of `hash` and the mask of
+// the bits it sets in that block.
+uint64_t *
+__stdbloom_mask(const StdBloom *bf, uint64_t hash, uint64_t mask[__STDBLOOM_BLOCK_WORDS])
+{
+  uint64_t *block = bf->words
+    + ((hash >> 32)*bf->nblocks >> 32)*__STDBLOOM_BLOCK_WORDS;
+  uint64_t h2 = hash*0x9e3779b97f4a7c15ull;
+  uint32_t a = (uint32_t)(h2 >> 32), b = (uint32_t)h2 | 1;
+  for (size_t w = 0; w < __STDBLOOM_BLOCK_WORDS; ++w) {
+    mask[w] = 0;
+  }
+  for (uint32_t i = 0; i < bf->k; ++i) {
+    uint32_t bit = a % __STDBLOOM_BLOCK_BITS;
+    mask[bit/64] |= (uint64_t)1 << (bit%64);
+    a += b;
+    b += i;
+  }
+  return block;
+}
+
+// Add a key by its hash, for keys the caller
+// already has a good 64 bit hash of.
+void
+stdbloom_add_hash(StdBloom *bf, uint64_t hash)
+{
+  uint64_t mask[__STDBLOOM_BLOCK_WORDS];
+  uint64_t *block = __stdbloom_mask(bf, hash, mask);
+  for (size_t w = 0; w < __STDBLOOM_BLOCK_WORDS; ++w) {
+    block[w] |= mask[w];
+  }
+  bf->count++;
+}
+
+// Returns 0 if the key with `hash` was never added,
+// 1 if it probably was.
 int
-stdqueue_empty(StdQueue *queue)
+stdbloom_contains_hash(const StdBloom *bf, uint64_t hash)
 {
-  return queue->len == 0;
+  uint64_t mask[__STDBLOOM_BLOCK_WORDS];
+  const uint64_t *block = __stdbloom_mask(bf, hash, mask);
+  uint64_t miss = 0;
+  for (size_t w = 0; w < __STDBLOOM_BLOCK_WORDS; ++w) {
+    miss |= mask[w] & ~block[w];
+  }
+  return miss == 0;
 }
 
-// Get the element at the front of `queue`.
-// Returns NULL if the queue is empty.
-void *
-stdqueue_peek(StdQueue *queue)
+// Add the `len` bytes at `key` to `bf`.
+void
+stdbloom_add(StdBloom *bf, const void *key, size_t len)
 {
-  return queue->len == 0
-    ? NULL
-    : queue->data + queue->head * queue->stride;
+  stdbloom_add_hash(bf, __std_hash_bytes(key, len, bf->seed));
 }
 
-// Remove the value at the front of `queue`.
-// Panics if len = 0.
+// Returns 0 if the `len` bytes at `key` were
+// never added to `bf`, 1 if they probably were.
+int
+stdbloom_contains(const StdBloom *bf, const void *key, size_t len)
+{
+  return stdbloom_contains_hash(bf, __std_hash_bytes(key, len, bf->seed));
+}
+
+// Add every key of `src` to `dst`. Both must have been
+// created with the same parameters. Returns 0 and does
+// nothing if they were not, 1 otherwise.
+int
+stdbloom_union(StdBloom *dst, const StdBloom *src)
+{
+  if (dst->nblocks != src->nblocks || dst->k != src->k || dst->seed != src->seed) {
+    return 0;
+  }
+  size_t n = dst->nblocks*__STDBLOOM_BLOCK_WORDS;
+  for (size_t i = 0; i < n; ++i) {
+    dst->words[i] |= src->words[i];
+  }
+  dst->count += src->count;
+  return 1;
+}
+
+// Write `bf` into `buf` if it has room for `cap`
+// bytes. Returns the number of bytes needed either
+// way, so it can be called with a NULL `buf` to size
+// it first. The format uses the host byte order.
+size_t
+stdbloom_serialize(const StdBloom *bf, void *buf, size_t cap)
+{
+  size_t bytes = bf->nblocks*__STD_CACHE_LINE;
+  size_t need = sizeof(struct __StdBloomHeader)+bytes;
+  if (buf && cap >= need) {
+    struct __StdBloomHeader hdr = {
+      .magic   = __STDBLOOM_MAGIC,
+      .version = __STDBLOOM_VERSION,
+      .k       = bf->k,
+      .nblocks = bf->nblocks,
+      .seed    = bf->seed,
+      .count   = bf->count,
+    };
+    (void)memcpy(buf, &hdr, sizeof(hdr));
+    (void)memcpy((char *)buf+sizeof(hdr), bf->words, bytes);
+  }
+  return need;
+}
+
+// Read a filter written by stdbloom_serialize from the
+// `len` bytes at `buf` into `bf`. Returns 0 if they are
+// not a valid filter, in which case `bf` is untouched.
+int
+stdbloom_deserialize(StdBloom *bf, const void *buf, size_t len)
+{
+  struct __StdBloomHeader hdr;
+  if (len < sizeof(hdr)) {
+    return 0;
+  }
+  (void)memcpy(&hdr, buf, sizeof(hdr));
+  if (hdr.magic != __STDBLOOM_MAGIC
+      || hdr.version != __STDBLOOM_VERSION
+      || hdr.k < 1 || hdr.k > __STDBLOOM_MAX_K
+      || hdr.nblocks == 0
+      || hdr.nblocks > (len-sizeof(hdr))/__STD_CACHE_LINE
+      || len-sizeof(hdr) != hdr.nblocks*__STD_CACHE_LINE) {
+    return 0;
+  }
+  bf->nblocks = hdr.nblocks;
+  bf->k       = hdr.k;
+  bf->seed    = hdr.seed;
+  bf->count   = hdr.count;
+  bf->words   = __stdbloom_alloc(bf->nblocks);
+  (void)memcpy(bf->words, (const char *)buf+sizeof(hdr), bf->nblocks*__STD_CACHE_LINE);
+  return 1;
+}
+
+#endif // STDBLOOM_IMPL
+
+//////////////////////////////
+// StdIter IMPLEMENTATION
+#ifdef STDITER_IMPL
+
+// Max number of stages of a StdIter.
+#define STDITER_MAX_STAGES 16
+
+// A lazy pipeline over the elements of an array or a
+// stdvec. Stages added with stditer_map, stditer_filter
+// and stditer_take do nothing until stditer_collect or
+// stditer_reduce runs the pipeline, which then takes
+// every element through all the stages in a single pass
+// with no intermediate vectors. Unlike stdvec_map, the
+// source is left as it is. A StdIter is only a
+// description: running it again gives the same result.
+// Example usage:
+//   StdIter it = stditer_from(&prices);
+//   stditer_take(stditer_filter(stditer_map(&it, to_eur, sizeof(double), &rate),
+//                               is_positive, NULL), 100);
+//   StdVec eur = stditer_collect(&it);
+enum __StdIterOp
+{
+  __STDITER_MAP,
+  __STDITER_FILTER,
+  __STDITER_TAKE,
+};
+
+struct __StdIterStage
+{
+  enum __StdIterOp op;
+  union {
+    void (*map)(void *out, const void *x, void *ctx);
+    int (*filter)(const void *x, void *ctx);
+    size_t take;
+  } as;
+  void *ctx;
+};
+
+struct StdIter
+{
+  const void *data;
+  size_t len;
+  size_t stride;      // of the source
+  size_t out_stride;  // of what comes out of the last stage
+  size_t max_stride;  // of any stage
+  size_t nstages;
+  struct __StdIterStage stages[STDITER_MAX_STAGES];
+};
+typedef struct StdIter StdIter;
+
+// Creates an iterator over `len` elements of `stride`
+// bytes at `data`.
+StdIter
+stditer_from_array(const void *data, size_t len, size_t stride)
+{
+  StdIter it;
+  it.data = data;
+  it.len = len;
+  it.stride = it.out_stride = it.max_stride = stride;
+  it.nstages = 0;
+  return it;
+}
+
+// Creates an iterator over the elements of `stdvec`,
+// which must not change while the iterator is used.
+StdIter
+stditer_from(const StdVec *stdvec)
+{
+  return stditer_from_array(stdvec->data, stdvec->len, stdvec->stride);
+}
+
+// Private: appends a stage to `it`.
+StdIter *
+__stditer_push(StdIter *it, struct __StdIterStage stage)
+{
+  if (it->nstages == STDITER_MAX_STAGES) {
+    __STD_PANIC("more than %d stages", STDITER_MAX_STAGES);
+  }
+  it->stages[it->nstages++] = stage;
+  return it;
+}
+
+// Adds a stage that calls `map(out, x, ctx)` on every
+// element `x`, which writes `out_stride` bytes to `out`
+// for the next stage. Returns `it`, for chaining.
+StdIter *
+stditer_map(StdIter *it, void (*map)(void *out, const void *x, void *ctx),
+            size_t out_stride, void *ctx)
+{
+  it->out_stride = out_stride;
+  it->max_stride = out_stride > it->max_stride ? out_stride : it->max_stride;
+  return __stditer_push(it, (struct __StdIterStage) {
+      .op = __STDITER_MAP, .as.map = map, .ctx = ctx,
+    });
+}
+
+// Adds a stage that only lets through the elements `x`
+// for which `filter(x, ctx)` is not 0. Returns `it`.
+StdIter *
+stditer_filter(StdIter *it, int (*filter)(const void *x, void *ctx), void *ctx)
+{
+  return __stditer_push(it, (struct __StdIterStage) {
+      .op = __STDITER_FILTER, .as.filter = filter, .ctx = ctx,
+    });
+}
+
+// Adds a stage that lets through the first `n` elements
+// that get to it, after which the pipeline stops
+// reading the source. Returns `it`.
+StdIter *
+stditer_take(StdIter *it, size_t n)
+{
+  return __stditer_push(it, (struct __StdIterStage) {
+      .op = __STDITER_TAKE, .as.take = n,
+    });
+}
+
+// Private: runs the pipeline, calling `sink(x, ctx)`
+// with every element that comes out of it. Mapped
+// elements go back and forth between two buffers.
 void
-stdqueue_dequeue(StdQueue *queue)
+__stditer_run(const StdIter *it, void (*sink)(const void *x, void *ctx), void *ctx)
 {
-  if (queue->len == 0) {
-    __STD_PANIC("tried to dequeue from an empty queue");
+  size_t taken[STDITER_MAX_STAGES] = {0};
+  // Both buffers must be aligned for whatever a map
+  // writes, so each one gets a whole number of
+  // max_align_t.
+  size_t align = _Alignof(max_align_t);
+  size_t slot = (it->max_stride+align-1)/align*align;
+  _Alignas(max_align_t) char buf[2][slot];
+  int done = 0;
+  for (size_t s = 0; s < it->nstages; ++s) {
+    done |= it->stages[s].op == __STDITER_TAKE && it->stages[s].as.take == 0;
+  }
+  for (size_t i = 0; i < it->len && !done; ++i) {
+    const void *x = (const char *)it->data+i*it->stride;
+    int pass = 1, side = 0;
+    for (size_t s = 0; s < it->nstages && pass; ++s) {
+      const struct __StdIterStage *stage = &it->stages[s];
+      switch (stage->op) {
+      case __STDITER_MAP:
+        stage->as.map(buf[side], x, stage->ctx);
+        x = buf[side];
+        side ^= 1;
+        break;
+      case __STDITER_FILTER:
+        pass = stage->as.filter(x, stage->ctx) != 0;
+        break;
+      case __STDITER_TAKE:
+        // Nothing more gets past a full take.
+        done |= ++taken[s] == stage->as.take;
+        break;
+      }
+    }
+    if (pass) {
+      sink(x, ctx);
+    }
   }
-  queue->head = (queue->head + 1) % queue->cap;
-  queue->len--;
 }
 
-// Enqueue an element into `queue` at the end.
+// Private: the most elements that can come out of `it`.
+size_t
+__stditer_bound(const StdIter *it)
+{
+  size_t bound = it->len;
+  for (size_t s = 0; s < it->nstages; ++s) {
+    if (it->stages[s].op == __STDITER_TAKE && it->stages[s].as.take < bound) {
+      bound = it->stages[s].as.take;
+    }
+  }
+  return bound;
+}
+
+// Private: sink of stditer_collect. Never grows `out`.
 void
-stdqueue_enqueue(StdQueue *queue, void *value)
+__stditer_collect_sink(const void *x, void *ctx)
 {
-  __STD_CHECK_MEM(queue->data);
-  __STD_DA_APPEND(queue, data, stride, len, cap, value);
+  StdVec *out = ctx;
+  (void)memcpy((char *)out->data+out->len*out->stride, x, out->stride);
+  out->len += 1;
 }
 
-#endif // STDQUEUE_IMPL
+// Runs the pipeline and returns a new stdvec with what
+// comes out of it. The stdvec is allocated once, for as
+// many elements as can come out: the source length, or
+// the smallest take if lower.
+StdVec
+stditer_collect(const StdIter *it)
+{
+  size_t bound = __stditer_bound(it);
+  StdVec out = stdvec_wcap(it->out_stride, bound ? bound : 1);
+  __stditer_run(it, __stditer_collect_sink, &out);
+  return out;
+}
+
+// Private: context of stditer_reduce.
+struct __StdIterReduce
+{
+  void (*reduce)(void *acc, const void *x, void *ctx);
+  void *acc;
+  void *ctx;
+};
+
+void
+__stditer_reduce_sink(const void *x, void *ctx)
+{
+  struct __StdIterReduce *r = ctx;
+  r->reduce(r->acc, x, r->ctx);
+}
+
+// Runs the pipeline, calling `reduce(acc, x, ctx)` for
+// every element `x` that comes out of it, in order.
+// `acc` should hold the initial value.
+// Example usage:
+//   double total = 0;
+//   stditer_reduce(&it, &total, add_double, NULL);
+void
+stditer_reduce(const StdIter *it, void *acc,
+               void (*reduce)(void *acc, const void *x, void *ctx), void *ctx)
+{
+  struct __StdIterReduce r = {.reduce = reduce, .acc = acc, .ctx = ctx};
+  __stditer_run(it, __stditer_reduce_sink, &r);
+}
+
+#endif // STDITER_IMPL
+
+//////////////////////////////
+// StdSearchIndex IMPLEMENTATION
+#ifdef STDSEARCHINDEX_IMPL
+
+// How many searches a batch lookup runs side by side.
+#define __STDSEARCHINDEX_BATCH 16
+
+// A read-only copy of a sorted stdvec for fast lookups.
+// The elements are laid out in Eytzinger (BFS) order:
+// slot 1 holds the root of the binary search tree, and
+// slot k has its children at 2k and 2k+1. The first few
+// levels, which every search visits, stay in cache.
+// Descending is k = 2k+(slot k < key), with no branch
+// to mispredict. The 2^d descendants of a slot d levels
+// down are contiguous, so each step prefetches the
+// cache line holding the ones it will read d steps
+// later. Lookups return the index of the element in the
+// sorted stdvec, which is left as it is.
+// Example usage:
+//   StdSearchIndex idx = stdsearchindex_new(&starts, compare_u64);
+//   size_t i = stdsearchindex_upper_bound_u64(&idx, addr)-1;
+//   Range *r = stdvec_at(&ranges, i);
+struct StdSearchIndex
+{
+  char *data;                 // Slot k at data+k*stride, slot 0 unused
+  size_t *rank;               // Index in the sorted stdvec of each slot
+  size_t len;
+  size_t stride;
+  size_t depth;               // Levels of the tree
+  size_t ahead;               // Slots of descendants to prefetch
+  CompareFunction compare;
+};
+typedef struct StdSearchIndex StdSearchIndex;
+
+// Private: copies `src` into the subtree at slot `k` in
+// order, starting at element `i`. Returns the index of
+// the next element.
+size_t
+__stdsearchindex_fill(StdSearchIndex *idx, const char *src, size_t i, size_t k)
+{
+  if (k <= idx->len) {
+    i = __stdsearchindex_fill(idx, src, i, 2*k);
+    (void)memcpy(idx->data+k*idx->stride, src+i*idx->stride, idx->stride);
+    idx->rank[k] = i++;
+    i = __stdsearchindex_fill(idx, src, i, 2*k+1);
+  }
+  return i;
+}
+
+// Create a new StdSearchIndex with the elements of
+// `sorted`, which must be sorted by `compare`. `compare`
+// gets an element first and a key second, and may be
+// NULL if only the typed lookups are used.
+StdSearchIndex
+stdsearchindex_new(const StdVec *sorted, CompareFunction compare)
+{
+  StdSearchIndex idx;
+  idx.len     = sorted->len;
+  idx.stride  = sorted->stride;
+  idx.compare = compare;
+  idx.depth   = 0;
+  while ((idx.len >> idx.depth) != 0) {
+    idx.depth += 1;
+  }
+  // As many descendants as fit in a cache line, but at
+  // least two levels down.
+  idx.ahead = 4;
+  while (2*idx.ahead*idx.stride <= __STD_CACHE_LINE) {
+    idx.ahead *= 2;
+  }
+  idx.data = __std_aligned_alloc((void *)(uintptr_t)__STD_CACHE_LINE, (idx.len+1)*idx.stride);
+  __STD_CHECK_MEM(idx.data);
+  idx.rank = __STD_S_MALLOC((idx.len+1)*sizeof(size_t));
+  (void)__stdsearchindex_fill(&idx, sorted->data, 0, 1);
+  return idx;
+}
+
+// Free the underlying memory of `idx`.
+void
+stdsearchindex_free(StdSearchIndex *idx)
+{
+  __STD_CHECK_MEM(idx->data);
+  __STD_FREE(idx->data);
+  __STD_FREE(idx->rank);
+  idx->data = NULL;
+  idx->rank = NULL;
+  idx->len = 0;
+}
+
+// Private: prefetches the descendants of slot `k`
+// that a search reads log2(ahead) steps later.
+static inline void
+__stdsearchindex_prefetch(const StdSearchIndex *idx, size_t k)
+{
+  // Past the last level this points outside `data`,
+  // which is fine for a prefetch but not for a pointer.
+  __builtin_prefetch((const void *)((uintptr_t)idx->data+k*idx->ahead*idx->stride));
+}
+
+// Private: turns the slot a search fell off the tree at
+// into the index of its answer. The answer is the last
+// slot where the search went left, so the trailing
+// right turns (set bits), and that left turn, are
+// dropped. A search that never went left gets slot 0.
+static inline size_t
+__stdsearchindex_rank(const StdSearchIndex *idx, size_t k)
+{
+  k >>= __builtin_ctzll(~(unsigned long long)k)+1;
+  return k == 0 ? idx->len : idx->rank[k];
+}
+
+// Private: searches for `key`, going right past the
+// elements less than `key`, or not greater if `upper`.
+size_t
+__stdsearchindex_search(const StdSearchIndex *idx, const void *key, int upper)
+{
+  size_t k = 1;
+  while (k <= idx->len) {
+    __stdsearchindex_prefetch(idx, k);
+    int cmp = idx->compare(idx->data+k*idx->stride, key);
+    k = 2*k+(upper ? cmp <= 0 : cmp < 0);
+  }
+  return __stdsearchindex_rank(idx, k);
+}
+
+// Returns the index of the first element not less than
+// `key`, or the number of elements if there is none.
+size_t
+stdsearchindex_lower_bound(const StdSearchIndex *idx, const void *key)
+{
+  return __stdsearchindex_search(idx, key, 0);
+}
+
+// Returns the index of the first element greater than
+// `key`, or the number of elements if there is none.
+size_t
+stdsearchindex_upper_bound(const StdSearchIndex *idx, const void *key)
+{
+  return __stdsearchindex_search(idx, key, 1);
+}
+
+// Sets [lo, hi) to the indices of the elements equal
+// to `key`.
+void
+stdsearchindex_equal_range(const StdSearchIndex *idx, const void *key, size_t *lo, size_t *hi)
+{
+  *lo = __stdsearchindex_search(idx, key, 0);
+  *hi = __stdsearchindex_search(idx, key, 1);
+}
+
+// Sets out[i] to stdsearchindex_lower_bound of the i-th
+// of the `n` keys at `keys`, which are `key_stride`
+// bytes apart. The searches run in groups that take
+// each step together, so the cache misses of a group
+// overlap instead of waiting on each other.
+void
+stdsearchindex_lower_bound_batch(const StdSearchIndex *idx, const void *keys, size_t key_stride,
+                                 size_t n, size_t *out)
+{
+  for (size_t i = 0; i < n; i += __STDSEARCHINDEX_BATCH) {
+    size_t m = n-i < __STDSEARCHINDEX_BATCH ? n-i : __STDSEARCHINDEX_BATCH;
+    const char *key = (const char *)keys+i*key_stride;
+    size_t k[__STDSEARCHINDEX_BATCH];
+    for (size_t j = 0; j < m; ++j) {
+      k[j] = 1;
+    }
+    for (size_t level = 0; level < idx->depth; ++level) {
+      for (size_t j = 0; j < m; ++j) {
+        if (k[j] <= idx->len) {
+          __stdsearchindex_prefetch(idx, k[j]);
+          int cmp = idx->compare(idx->data+k[j]*idx->stride, key+j*key_stride);
+          k[j] = 2*k[j]+(cmp < 0);
+        }
+      }
+    }
+    for (size_t j = 0; j < m; ++j) {
+      out[i+j] = __stdsearchindex_rank(idx, k[j]);
+    }
+  }
+}
+
+// Private: generates the typed lookups for one type.
+// They compare the leading `type` of each element
+// directly instead of calling `compare`.
+#define __STDSEARCHINDEX_DECL(sfx, type)                                \
+  static inline size_t                                                  \
+  __stdsearchindex_search_##sfx(const StdSearchIndex *idx, type key, int upper) \
+  {                                                                     \
+    size_t k = 1;                                                       \
+    while (k <= idx->len) {                                             \
+      __stdsearchindex_prefetch(idx, k);                                \
+      type x = *(const type *)(idx->data+k*idx->stride);                \
+      k = 2*k+(upper ? !(key < x) : x < key);                           \
+    }                                                                   \
+    return __stdsearchindex_rank(idx, k);                               \
+  }                                                                     \
+                                                                        \
+  size_t                                                                \
+  stdsearchindex_lower_bound_##sfx(const StdSearchIndex *idx, type key) \
+  {                                                                     \
+    return __stdsearchindex_search_##sfx(idx, key, 0);                  \
+  }                                                                     \
+                                                                        \
+  size_t                                                                \
+  stdsearchindex_upper_bound_##sfx(const StdSearchIndex *idx, type key) \
+  {                                                                     \
+    return __stdsearchindex_search_##sfx(idx, key, 1);                  \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  stdsearchindex_equal_range_##sfx(const StdSearchIndex *idx, type key, size_t *lo, size_t *hi) \
+  {                                                                     \
+    *lo = __stdsearchindex_search_##sfx(idx, key, 0);                   \
+    *hi = __stdsearchindex_search_##sfx(idx, key, 1);                   \
+  }                                                                     \
+                                                                        \
+  void                                                                  \
+  stdsearchindex_lower_bound_batch_##sfx(const StdSearchIndex *idx, const type *keys, \
+                                         size_t n, size_t *out)         \
+  {                                                                     \
+    for (size_t i = 0; i < n; i += __STDSEARCHINDEX_BATCH) {            \
+      size_t m = n-i < __STDSEARCHINDEX_BATCH ? n-i : __STDSEARCHINDEX_BATCH; \
+      size_t k[__STDSEARCHINDEX_BATCH];                                 \
+      for (size_t j = 0; j < m; ++j) {                                  \
+        k[j] = 1;                                                       \
+      }                                                                 \
+      for (size_t level = 0; level < idx->depth; ++level) {             \
+        for (size_t j = 0; j < m; ++j) {                                \
+          if (k[j] <= idx->len) {                                       \
+            __stdsearchindex_prefetch(idx, k[j]);                       \
+            type x = *(const type *)(idx->data+k[j]*idx->stride);       \
+            k[j] = 2*k[j]+(x < keys[i+j]);                              \
+          }                                                             \
+        }                                                               \
+      }                                                                 \
+      for (size_t j = 0; j < m; ++j) {                                  \
+        out[i+j] = __stdsearchindex_rank(idx, k[j]);                    \
+      }                                                                 \
+    }                                                                   \
+  }
+
+// Typed lookups, for elements that are a `type` or
+// start with one (like a struct whose first member is
+// the key), sorted by it:
+//   stdsearchindex_lower_bound_<type>(idx, key)
+//   stdsearchindex_upper_bound_<type>(idx, key)
+//   stdsearchindex_equal_range_<type>(idx, key, &lo, &hi)
+//   stdsearchindex_lower_bound_batch_<type>(idx, keys, n, out)
+// Float keys must not be NaN.
+__STDSEARCHINDEX_DECL(i32, int32_t)
+__STDSEARCHINDEX_DECL(u32, uint32_t)
+__STDSEARCHINDEX_DECL(i64, int64_t)
+__STDSEARCHINDEX_DECL(u64, uint64_t)
+__STDSEARCHINDEX_DECL(f32, float)
+__STDSEARCHINDEX_DECL(f64, double)
+
+#endif // STDSEARCHINDEX_IMPL
 
 #endif // STD_H
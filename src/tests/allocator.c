@@ -0,0 +1,181 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDVEC_IMPL
+#define STDSTR_IMPL
+#define STDSTACK_IMPL
+#define STDQUEUE_IMPL
+#include "../cstd.h"
+
+// Checks that every free and realloc is given
+// the size the block was allocated with.
+struct Counting
+{
+  size_t live;
+  size_t calls;
+  int bad_size;
+};
+
+void *
+counting_alloc(void *ctx, size_t bytes)
+{
+  struct Counting *c = ctx;
+  c->live += bytes;
+  c->calls++;
+  char *mem = malloc(sizeof(max_align_t)+bytes);
+  memcpy(mem, &bytes, sizeof(bytes));
+  return mem+sizeof(max_align_t);
+}
+
+void
+counting_free(void *ctx, void *ptr, size_t bytes)
+{
+  struct Counting *c = ctx;
+  char *mem = (char *)ptr-sizeof(max_align_t);
+  size_t size;
+  memcpy(&size, mem, sizeof(size));
+  c->bad_size |= size != bytes;
+  c->live -= bytes;
+  free(mem);
+}
+
+void *
+counting_realloc(void *ctx, void *ptr, size_t old, size_t bytes)
+{
+  void *mem = counting_alloc(ctx, bytes);
+  memcpy(mem, ptr, old < bytes ? old : bytes);
+  counting_free(ctx, ptr, old);
+  return mem;
+}
+
+void
+double_int(void *x)
+{
+  *(int *)x *= 2;
+}
+
+void
+test_counting_allocator(void)
+{
+  struct Counting c = {0};
+  StdAllocator a = {counting_alloc, counting_realloc, counting_free, &c};
+
+  StdVec v = stdvec_new_alloc(sizeof(int), &a);
+  StdStr str = stdstr_new_alloc(&a);
+  StdStack s = stdstack_new_alloc(sizeof(int), &a);
+  StdStack seg = stdstack_new_segmented_alloc(sizeof(int), 16, &a);
+  StdQueue q = stdqueue_new_alloc(sizeof(int), &a);
+  int in[100];
+  for (int i = 0; i < 100; ++i) {
+    in[i] = i;
+    stdvec_push(&v, &i);
+    stdstr_push(&str, 'a'+i%26);
+    stdstack_push(&s, &i);
+    stdqueue_enqueue(&q, &i);
+  }
+  stdstack_push_n(&s, in, 100);
+  stdstack_push_n(&seg, in, 100);
+  stdstack_pop_n(&seg, NULL, 90);
+  cut_assert_true(c.calls > 20);
+  cut_assert_true(c.live > 0);
+
+  for (int i = 0; i < 100; ++i) {
+    cut_assert_eq(*(int *)stdvec_at(&v, i), i);
+    cut_assert_eq(*(int *)stdqueue_peek(&q), i);
+    stdqueue_dequeue(&q);
+  }
+  cut_assert_eq(str.data[27], 'b');
+  cut_assert_eq(*(int *)stdstack_peek(&seg), 9);
+  cut_assert_eq(s.len, 200);
+
+  // The mapped vector keeps the allocator.
+  StdVec mapped = stdvec_map(&v, double_int);
+  cut_assert_true(mapped.alloc == &a);
+  cut_assert_eq(*(int *)stdvec_at(&mapped, 99), 198);
+
+  stdvec_free(&mapped);
+  stdstr_free(&str);
+  stdstack_free(&s);
+  stdstack_free(&seg);
+  stdqueue_free(&q);
+  cut_assert_eq(c.live, 0);
+  cut_assert_false(c.bad_size);
+}
+
+void
+test_aligned_allocator(void)
+{
+  StdAllocator a = stdallocator_aligned(64);
+  StdVec v = stdvec_new_alloc(sizeof(float), &a);
+  for (int i = 0; i < 1000; ++i) {
+    float f = (float)i;
+    stdvec_push(&v, &f);
+    cut_assert_eq((uintptr_t)v.data%64, 0);
+  }
+  cut_assert_true(*(float *)stdvec_at(&v, 999) == 999.f);
+  stdvec_free(&v);
+
+  StdQueue q = stdqueue_wcap_alloc(sizeof(int), 8, &a);
+  for (int i = 0; i < 6; ++i) {
+    stdqueue_enqueue(&q, &i);
+  }
+  // Wrap around, then grow.
+  stdqueue_dequeue_n(&q, NULL, 4);
+  for (int i = 6; i < 40; ++i) {
+    stdqueue_enqueue(&q, &i);
+  }
+  cut_assert_eq((uintptr_t)q.data%64, 0);
+  for (int i = 4; i < 40; ++i) {
+    cut_assert_eq(*(int *)stdqueue_peek(&q), i);
+    stdqueue_dequeue(&q);
+  }
+  stdqueue_free(&q);
+
+  StdAllocator page = stdallocator_aligned(4096);
+  StdStr str = stdstr_new_alloc(&page);
+  stdstr_append(&str, "hello");
+  cut_assert_eq((uintptr_t)str.data%4096, 0);
+  cut_assert_eq(str.len, 5);
+  stdstr_free(&str);
+}
+
+void
+test_hugepage_allocator(void)
+{
+  // A low threshold so the test does not need GBs.
+  StdAllocator a = stdallocator_hugepage(1 << 16);
+  StdVec v = stdvec_new_alloc(sizeof(int), &a);
+  for (int i = 0; i < (1 << 20); ++i) {
+    stdvec_push(&v, &i);
+  }
+  cut_assert_true(v.cap*v.stride >= (1 << 16));
+  cut_assert_eq((uintptr_t)v.data%(2 << 20), 0);
+  size_t bad = 0;
+  for (int i = 0; i < (1 << 20); ++i) {
+    bad += *(int *)stdvec_at(&v, i) != i;
+  }
+  cut_assert_eq(bad, 0);
+  stdvec_free(&v);
+
+  StdAllocator def = stdallocator_hugepage(0);
+  StdStack s = stdstack_new_alloc(sizeof(double), &def);
+  for (int i = 0; i < 300000; ++i) {
+    double d = i;
+    stdstack_push(&s, &d);
+  }
+  cut_assert_eq((uintptr_t)s.data%(2 << 20), 0);
+  cut_assert_true(*(double *)stdstack_peek(&s) == 299999.);
+  stdstack_free(&s);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_counting_allocator();
+  test_aligned_allocator();
+  test_hugepage_allocator();
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,169 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDBITSET_IMPL
+#include "../cstd.h"
+
+void
+test_set_clear_test(void)
+{
+  StdBitset bs = stdbitset_new(200);
+  cut_assert_eq(bs.nwords, 4);
+  cut_assert_false(stdbitset_any(&bs));
+
+  stdbitset_set(&bs, 0);
+  stdbitset_set(&bs, 63);
+  stdbitset_set(&bs, 64);
+  stdbitset_set(&bs, 199);
+  cut_assert_true(stdbitset_test(&bs, 63));
+  cut_assert_true(stdbitset_test(&bs, 64));
+  cut_assert_false(stdbitset_test(&bs, 65));
+  cut_assert_false(stdbitset_test(&bs, 1000));
+  cut_assert_eq(stdbitset_count(&bs), 4);
+
+  stdbitset_clear(&bs, 63);
+  stdbitset_flip(&bs, 64);
+  stdbitset_flip(&bs, 100);
+  cut_assert_false(stdbitset_test(&bs, 63));
+  cut_assert_false(stdbitset_test(&bs, 64));
+  cut_assert_true(stdbitset_test(&bs, 100));
+  cut_assert_eq(stdbitset_count(&bs), 3);
+
+  stdbitset_fill(&bs, 1);
+  cut_assert_eq(stdbitset_count(&bs), 200);
+  cut_assert_true(stdbitset_all(&bs));
+  stdbitset_clear(&bs, 150);
+  cut_assert_false(stdbitset_all(&bs));
+
+  stdbitset_free(&bs);
+}
+
+void
+test_resize(void)
+{
+  StdBitset bs = stdbitset_new(0);
+  cut_assert_true(stdbitset_all(&bs));
+  for (size_t i = 0; i < 1000; ++i) {
+    stdbitset_resize(&bs, i+1);
+    stdbitset_set(&bs, i);
+  }
+  cut_assert_eq(stdbitset_count(&bs), 1000);
+
+  // Shrinking drops the bits past the new end, and
+  // growing back brings zeros.
+  stdbitset_resize(&bs, 70);
+  cut_assert_eq(stdbitset_count(&bs), 70);
+  stdbitset_resize(&bs, 500);
+  cut_assert_eq(stdbitset_count(&bs), 70);
+  cut_assert_false(stdbitset_test(&bs, 70));
+
+  stdbitset_free(&bs);
+}
+
+void
+test_word_ops(void)
+{
+  StdBitset a = stdbitset_new(300), b = stdbitset_new(300), c = stdbitset_new(100);
+  for (size_t i = 0; i < 300; ++i) {
+    if (i%2 == 0) stdbitset_set(&a, i);
+    if (i%3 == 0) stdbitset_set(&b, i);
+  }
+  stdbitset_fill(&c, 1);
+
+  StdBitset x = stdbitset_new(300);
+  stdbitset_or(&x, &a);
+  stdbitset_and(&x, &b);
+  cut_assert_eq(stdbitset_count(&x), 50);
+  for (size_t i = 0; i < 300; ++i) {
+    cut_assert_eq(stdbitset_test(&x, i), (i%6 == 0));
+  }
+
+  stdbitset_xor(&x, &a);
+  cut_assert_eq(stdbitset_count(&x), 100);
+  stdbitset_andnot(&x, &b);
+  cut_assert_eq(stdbitset_count(&x), 100);
+
+  // A shorter `src` counts as 0 past its end.
+  stdbitset_fill(&x, 1);
+  stdbitset_and(&x, &c);
+  cut_assert_eq(stdbitset_count(&x), 100);
+  // And a longer one is cut at the end of `dst`.
+  stdbitset_or(&c, &a);
+  cut_assert_eq(stdbitset_count(&c), 100);
+
+  // `dst` may be `src`.
+  stdbitset_and(&a, &a);
+  cut_assert_eq(stdbitset_count(&a), 150);
+  stdbitset_or(&a, &a);
+  cut_assert_eq(stdbitset_count(&a), 150);
+  stdbitset_andnot(&b, &b);
+  cut_assert_eq(stdbitset_count(&b), 0);
+  stdbitset_xor(&x, &x);
+  cut_assert_eq(stdbitset_count(&x), 0);
+
+  stdbitset_free(&a);
+  stdbitset_free(&b);
+  stdbitset_free(&c);
+  stdbitset_free(&x);
+}
+
+void
+test_next(void)
+{
+  StdBitset bs = stdbitset_new(1000);
+  size_t want[] = {3, 64, 65, 500, 999};
+  for (size_t i = 0; i < 5; ++i) {
+    stdbitset_set(&bs, want[i]);
+  }
+  size_t k = 0;
+  for (size_t i = stdbitset_next(&bs, 0); i < bs.len; i = stdbitset_next(&bs, i+1)) {
+    cut_assert_eq(i, want[k]);
+    ++k;
+  }
+  cut_assert_eq(k, 5);
+  cut_assert_eq(stdbitset_next(&bs, 66), 500);
+  cut_assert_eq(stdbitset_next(&bs, 1000), 1000);
+  stdbitset_free(&bs);
+}
+
+void
+test_rank_select(void)
+{
+  StdBitset bs = stdbitset_new(5000);
+  size_t count = 0;
+  for (size_t i = 0; i < 5000; i += 7) {
+    stdbitset_set(&bs, i);
+    ++count;
+  }
+  for (size_t i = 0; i <= 5000; i += 13) {
+    size_t r = stdbitset_rank(&bs, i);
+    cut_assert_eq(r, (i+6)/7);
+  }
+  for (size_t k = 0; k < count; ++k) {
+    size_t at = stdbitset_select(&bs, k);
+    cut_assert_eq(at, k*7);
+  }
+  cut_assert_eq(stdbitset_select(&bs, count), 5000);
+
+  // The index is rebuilt after a modification.
+  stdbitset_set(&bs, 1);
+  cut_assert_eq(stdbitset_rank(&bs, 8), 3);
+  cut_assert_eq(stdbitset_select(&bs, 1), 1);
+  cut_assert_eq(stdbitset_select(&bs, 2), 7);
+
+  stdbitset_free(&bs);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_set_clear_test();
+  test_resize();
+  test_word_ops();
+  test_next();
+  test_rank_select();
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,118 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDBLOOM_IMPL
+#include "../cstd.h"
+
+void
+test_no_false_negatives(void)
+{
+  StdBloom bf = stdbloom_new(10000, 0.01);
+  cut_assert_true(bf.k >= 1);
+  for (uint64_t i = 0; i < 10000; ++i) {
+    stdbloom_add(&bf, &i, sizeof(i));
+  }
+  cut_assert_eq(bf.count, 10000);
+  size_t missing = 0;
+  for (uint64_t i = 0; i < 10000; ++i) {
+    missing += !stdbloom_contains(&bf, &i, sizeof(i));
+  }
+  cut_assert_eq(missing, 0);
+  stdbloom_free(&bf);
+}
+
+void
+test_false_positive_rate(void)
+{
+  double rates[] = {0.1, 0.01, 0.001};
+  for (size_t r = 0; r < 3; ++r) {
+    StdBloom bf = stdbloom_new(20000, rates[r]);
+    for (uint64_t i = 0; i < 20000; ++i) {
+      stdbloom_add(&bf, &i, sizeof(i));
+    }
+    size_t fp = 0, n = 200000;
+    for (uint64_t i = 1000000; i < 1000000+n; ++i) {
+      fp += stdbloom_contains(&bf, &i, sizeof(i));
+    }
+    double rate = (double)fp/n;
+    cut_assert_true(rate < rates[r]*1.25);
+    stdbloom_free(&bf);
+  }
+}
+
+void
+test_union(void)
+{
+  StdBloom a = stdbloom_new(1000, 0.01), b = stdbloom_new(1000, 0.01);
+  StdBloom c = stdbloom_new(5000, 0.01);
+  const char *x = "hello", *y = "world";
+  stdbloom_add(&a, x, 5);
+  stdbloom_add(&b, y, 5);
+  cut_assert_false(stdbloom_contains(&a, y, 5));
+
+  int ok = stdbloom_union(&a, &b);
+  cut_assert_true(ok);
+  cut_assert_true(stdbloom_contains(&a, x, 5));
+  cut_assert_true(stdbloom_contains(&a, y, 5));
+  cut_assert_eq(a.count, 2);
+
+  ok = stdbloom_union(&a, &c);
+  cut_assert_false(ok);
+
+  stdbloom_clr(&a);
+  cut_assert_false(stdbloom_contains(&a, x, 5));
+
+  stdbloom_free(&a);
+  stdbloom_free(&b);
+  stdbloom_free(&c);
+}
+
+void
+test_serialize(void)
+{
+  StdBloom bf = stdbloom_new(3000, 0.02);
+  for (uint32_t i = 0; i < 3000; ++i) {
+    stdbloom_add(&bf, &i, sizeof(i));
+  }
+  size_t need = stdbloom_serialize(&bf, NULL, 0);
+  char *buf = malloc(need);
+  size_t wrote = stdbloom_serialize(&bf, buf, need);
+  cut_assert_eq(wrote, need);
+
+  StdBloom back;
+  int ok = stdbloom_deserialize(&back, buf, need);
+  cut_assert_true(ok);
+  cut_assert_eq(back.nblocks, bf.nblocks);
+  cut_assert_eq(back.k, bf.k);
+  cut_assert_eq(back.count, 3000);
+  for (uint32_t i = 0; i < 3000; ++i) {
+    cut_assert_true(stdbloom_contains(&back, &i, sizeof(i)));
+  }
+  for (uint32_t i = 3000; i < 10000; ++i) {
+    int same = stdbloom_contains(&back, &i, sizeof(i)) == stdbloom_contains(&bf, &i, sizeof(i));
+    cut_assert_true(same);
+  }
+
+  ok = stdbloom_deserialize(&back, buf, need-1);
+  cut_assert_false(ok);
+  buf[0] ^= 1;
+  ok = stdbloom_deserialize(&back, buf, need);
+  cut_assert_false(ok);
+
+  free(buf);
+  stdbloom_free(&back);
+  stdbloom_free(&bf);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_no_false_negatives();
+  test_false_positive_rate();
+  test_union();
+  test_serialize();
+  CUT_END;
+  return 0;
+}
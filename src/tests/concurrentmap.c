@@ -0,0 +1,163 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDCONCURRENTMAP_IMPL
+#include "../cstd.h"
+
+#define N_THREADS 4
+#define N_PER_THREAD 5000
+
+struct Ctx
+{
+  StdConcurrentMap *map;
+  int id;
+  int ok;
+};
+
+void
+test_put_get_overwrite(void)
+{
+  StdConcurrentMap map = stdconcurrentmap_new(sizeof(int), sizeof(double), 4);
+  cut_assert_eq(map.nshards, 4);
+
+  cut_assert_true(stdconcurrentmap_put(&map, STDCL(int, 1), STDCL(double, 1.5)));
+  cut_assert_true(stdconcurrentmap_put(&map, STDCL(int, 2), STDCL(double, 2.5)));
+  cut_assert_false(stdconcurrentmap_put(&map, STDCL(int, 1), STDCL(double, 3.5)));
+
+  double v = 0;
+  cut_assert_true(stdconcurrentmap_get(&map, STDCL(int, 1), &v));
+  cut_assert_true(v == 3.5);
+  cut_assert_true(stdconcurrentmap_get(&map, STDCL(int, 2), NULL));
+  cut_assert_false(stdconcurrentmap_get(&map, STDCL(int, 3), &v));
+  cut_assert_eq(stdconcurrentmap_len(&map), 2);
+
+  stdconcurrentmap_free(&map);
+}
+
+void
+test_overwrite_does_not_grow(void)
+{
+  StdConcurrentMap map = stdconcurrentmap_new(sizeof(int), sizeof(int), 1);
+  StdConcurrentMapStats stats = stdconcurrentmap_stats(&map);
+  // Fill the shard up to the load factor limit, so
+  // that the next new key makes it grow.
+  int n = 0;
+  while ((stats.len+1)*4 <= stats.cap*3) {
+    stdconcurrentmap_put(&map, &n, &n);
+    n += 1;
+    stats = stdconcurrentmap_stats(&map);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    cut_assert_false(stdconcurrentmap_put(&map, &i, STDCL(int, -i)));
+  }
+  StdConcurrentMapStats after = stdconcurrentmap_stats(&map);
+  cut_assert_eq(after.cap, stats.cap);
+  cut_assert_eq(after.resizes, stats.resizes);
+
+  cut_assert_true(stdconcurrentmap_put(&map, &n, &n));
+  after = stdconcurrentmap_stats(&map);
+  cut_assert_eq(after.cap, 2*stats.cap);
+  int v = 0;
+  cut_assert_true(stdconcurrentmap_get(&map, STDCL(int, n-1), &v));
+  cut_assert_eq(v, 1-n);
+
+  stdconcurrentmap_free(&map);
+}
+
+void
+test_resize_and_remove(void)
+{
+  StdConcurrentMap map = stdconcurrentmap_new(sizeof(int), sizeof(int), 2);
+  int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    stdconcurrentmap_put(&map, &i, STDCL(int, i*2));
+  }
+  cut_assert_eq(stdconcurrentmap_len(&map), (size_t)n);
+
+  // Remove every third key, which exercises the
+  // backward shift on long probe runs.
+  for (int i = 0; i < n; i += 3) {
+    cut_assert_true(stdconcurrentmap_remove(&map, &i));
+  }
+  cut_assert_false(stdconcurrentmap_remove(&map, STDCL(int, 0)));
+
+  int all_ok = 1;
+  for (int i = 0; i < n; ++i) {
+    int v = -1;
+    int found = stdconcurrentmap_get(&map, &i, &v);
+    if (i % 3 == 0 ? found : (!found || v != i*2)) {
+      all_ok = 0;
+    }
+  }
+  cut_assert_true(all_ok);
+
+  StdConcurrentMapStats stats = stdconcurrentmap_stats(&map);
+  cut_assert_eq(stats.len, (size_t)(n-(n+2)/3));
+  cut_assert_true(stats.resizes > 0);
+  cut_assert_true(stats.load_factor <= 0.75);
+  cut_assert_true(stats.min_shard_len <= stats.max_shard_len);
+
+  stdconcurrentmap_free(&map);
+}
+
+void *
+worker(void *arg)
+{
+  struct Ctx *ctx = (struct Ctx *)arg;
+  int base = ctx->id*N_PER_THREAD;
+  ctx->ok = 1;
+  for (int i = base; i < base+N_PER_THREAD; ++i) {
+    stdconcurrentmap_put(ctx->map, &i, &i);
+  }
+  // Read back our own keys and a neighbour's,
+  // which may or may not be there yet.
+  int other = ((ctx->id+1) % N_THREADS)*N_PER_THREAD;
+  for (int i = 0; i < N_PER_THREAD; ++i) {
+    int key = base+i, v = -1;
+    if (!stdconcurrentmap_get(ctx->map, &key, &v) || v != key) {
+      ctx->ok = 0;
+    }
+    key = other+i;
+    if (stdconcurrentmap_get(ctx->map, &key, &v) && v != key) {
+      ctx->ok = 0;
+    }
+  }
+  for (int i = base; i < base+N_PER_THREAD; i += 2) {
+    stdconcurrentmap_remove(ctx->map, &i);
+  }
+  return NULL;
+}
+
+void
+test_many_threads(void)
+{
+  StdConcurrentMap map = stdconcurrentmap_new(sizeof(int), sizeof(int), 8);
+  pthread_t threads[N_THREADS];
+  struct Ctx ctxs[N_THREADS];
+
+  for (int i = 0; i < N_THREADS; ++i) {
+    ctxs[i] = (struct Ctx) { .map = &map, .id = i, .ok = 0 };
+    pthread_create(&threads[i], NULL, worker, &ctxs[i]);
+  }
+  for (int i = 0; i < N_THREADS; ++i) {
+    pthread_join(threads[i], NULL);
+    cut_assert_true(ctxs[i].ok);
+  }
+  cut_assert_eq(stdconcurrentmap_len(&map), N_THREADS*N_PER_THREAD/2);
+
+  stdconcurrentmap_free(&map);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_put_get_overwrite();
+  test_overwrite_does_not_grow();
+  test_resize_and_remove();
+  test_many_threads();
+  CUT_END;
+  return 0;
+}
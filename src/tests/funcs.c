@@ -71,9 +71,115 @@ void
 test_is_sorted(void)
 {
   int arr[5] = {1,2,3,4,5};
-  cut_assert_true(is_sorted(arr, arr+5, &compare_int));
+  cut_assert_true(std_is_sorted(arr, arr+5, sizeof(*arr), &compare_int));
   int arr2[5] = {5,4,3,2,1};
-  cut_assert_false(is_sorted(arr2, arr2+5, &compare_int));
+  cut_assert_false(std_is_sorted(arr2, arr2+5, sizeof(*arr2), &compare_int));
+
+  int arr3[5] = {1,2,2,3,4};
+  cut_assert_true(std_is_sorted(arr3, arr3+5, sizeof(*arr3), &compare_int));
+  cut_assert_false(std_is_sorted_strict(arr3, arr3+5, sizeof(*arr3), &compare_int));
+  cut_assert_true(std_is_sorted_strict_until(arr3, arr3+5, sizeof(*arr3), &compare_int) == arr3+2);
+  cut_assert_true(std_is_sorted_strict(arr, arr+5, sizeof(*arr), &compare_int));
+}
+
+// The SIMD kernels only exist on x86.
+#ifdef __STD_X86
+#define TEST_SORTED_KERNELS(sfx)                                        \
+  if (__builtin_cpu_supports("sse4.2")) {                               \
+    got = __std_is_sorted_until_##sfx##_sse(arr, n, order);             \
+    cut_assert_eq(got, want);                                           \
+  }                                                                     \
+  if (__builtin_cpu_supports("avx2")) {                                 \
+    got = __std_is_sorted_until_##sfx##_avx2(arr, n, order);            \
+    cut_assert_eq(got, want);                                           \
+  }
+#else
+#define TEST_SORTED_KERNELS(sfx)
+#endif
+
+// Every kernel must agree with the scalar one, in every
+// order, for a break planted anywhere in the vector body
+// or in the tail of an ascending or a descending array.
+#define TEST_SORTED_TYPE(sfx, type)                                     \
+  void                                                                  \
+  test_is_sorted_##sfx(void)                                            \
+  {                                                                     \
+    type arr[75];                                                       \
+    size_t n = sizeof(arr)/sizeof(*arr), one = 1, got;                  \
+    int ok;                                                             \
+    for (size_t bad = 1; bad <= n; ++bad) {                             \
+      for (size_t i = 0; i < n; ++i) {                                  \
+        arr[i] = (type)(i/2);                                           \
+      }                                                                 \
+      if (bad < n) {                                                    \
+        arr[bad] = (type)0;                                             \
+      }                                                                 \
+      size_t want = bad < n && arr[bad-1] > 0 ? bad : n;                \
+      got = std_is_sorted_until_##sfx(arr, n, STD_SORT_ASC);            \
+      cut_assert_eq(got, want);                                         \
+      got = __std_is_sorted_until_##sfx##_scalar(arr, n, STD_SORT_ASC, 1); \
+      cut_assert_eq(got, want);                                         \
+      for (int desc = 0; desc < 2; ++desc) {                            \
+        for (size_t i = 0; i < n; ++i) {                                \
+          arr[i] = (type)(desc ? (n-i)/2 : i/2);                        \
+        }                                                               \
+        if (bad < n) {                                                  \
+          arr[bad] = (type)(desc ? n : 0);                              \
+        }                                                               \
+        for (int o = STD_SORT_ASC; o <= STD_SORT_DESC_STRICT; ++o) {    \
+          StdSortOrder order = (StdSortOrder)o;                         \
+          want = __std_is_sorted_until_##sfx##_scalar(arr, n, order, 1); \
+          got = std_is_sorted_until_##sfx(arr, n, order);               \
+          cut_assert_eq(got, want);                                     \
+          TEST_SORTED_KERNELS(sfx);                                     \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    for (size_t i = 0; i < n; ++i) {                                    \
+      arr[i] = (type)(n-i);                                             \
+    }                                                                   \
+    ok = std_is_sorted_##sfx(arr, n, STD_SORT_DESC_STRICT);             \
+    cut_assert_true(ok);                                                \
+    ok = std_is_sorted_##sfx(arr, n, STD_SORT_DESC);                    \
+    cut_assert_true(ok);                                                \
+    got = std_is_sorted_until_##sfx(arr, n, STD_SORT_ASC);              \
+    cut_assert_eq(got, one);                                            \
+    arr[60] = arr[59];                                                  \
+    ok = std_is_sorted_##sfx(arr, n, STD_SORT_DESC);                    \
+    cut_assert_true(ok);                                                \
+    got = std_is_sorted_until_##sfx(arr, n, STD_SORT_DESC_STRICT);      \
+    cut_assert_eq(got, (size_t)60);                                     \
+    ok = std_is_sorted_##sfx(arr, 1, STD_SORT_ASC_STRICT);              \
+    cut_assert_true(ok);                                                \
+    ok = std_is_sorted_##sfx(arr, 0, STD_SORT_ASC_STRICT);              \
+    cut_assert_true(ok);                                                \
+  }
+
+TEST_SORTED_TYPE(i32, int32_t)
+TEST_SORTED_TYPE(u32, uint32_t)
+TEST_SORTED_TYPE(i64, int64_t)
+TEST_SORTED_TYPE(u64, uint64_t)
+TEST_SORTED_TYPE(f32, float)
+TEST_SORTED_TYPE(f64, double)
+
+void
+test_is_sorted_signedness(void)
+{
+  int32_t s[9] = {-5, -4, -3, -2, -1, 0, 1, 2, 3};
+  uint32_t u[9] = {0, 1, 2, 3, 4, 5, 6, 0x80000000u, 0xffffffffu};
+  int ok = std_is_sorted_i32(s, 9, STD_SORT_ASC_STRICT);
+  cut_assert_true(ok);
+  ok = std_is_sorted_u32(u, 9, STD_SORT_ASC_STRICT);
+  cut_assert_true(ok);
+  size_t at = std_is_sorted_until_u32((const uint32_t *)s, 9, STD_SORT_ASC);
+  cut_assert_eq(at, (size_t)5);
+
+  double d[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  d[6] = 0.0/0.0;
+  ok = std_is_sorted_f64(d, 10, STD_SORT_ASC);
+  cut_assert_true(ok);
+  at = std_is_sorted_until_f64(d, 10, STD_SORT_ASC_STRICT);
+  cut_assert_eq(at, (size_t)6);
 }
 
 int
@@ -94,6 +200,73 @@ test_basic_iota(int cur)
 __STDSWAP(int);
 __STDSWAP(char);
 
+static inline int
+is_even(int x)
+{
+  return x % 2 == 0;
+}
+
+STD_ALGO_DECL(int, is_even);
+STD_ORD_ALGO_DECL(int);
+STD_ORD_ALGO_DECL(double);
+
+void
+test_algo_decl(void)
+{
+  int arr[200];
+  size_t n = sizeof(arr)/sizeof(*arr);
+  for (size_t i = 0; i < n; ++i) {
+    arr[i] = (int)i*2;
+  }
+  cut_assert_true(stdall_of_is_even(arr, n));
+  cut_assert_false(stdnone_of_is_even(arr, n));
+  cut_assert_eq(stdcount_if_is_even(arr, n), n);
+  cut_assert_eq(stdfind_if_is_even(arr, n), 0);
+
+  // Past the first block, and in the tail.
+  arr[130] = 1;
+  arr[199] = 3;
+  cut_assert_false(stdall_of_is_even(arr, n));
+  cut_assert_eq(stdcount_if_is_even(arr, n), n-2);
+  for (size_t i = 0; i < n; ++i) {
+    arr[i] = arr[i] % 2 == 0 ? 1 : 2;
+  }
+  cut_assert_eq(stdfind_if_is_even(arr, n), 130);
+  cut_assert_true(stdany_of_is_even(arr, n));
+  cut_assert_true(stdnone_of_is_even(arr, 130));
+  cut_assert_true(stdall_of_is_even(arr, 0));
+}
+
+void
+test_ord_algo_decl(void)
+{
+  int arr[150];
+  size_t n = sizeof(arr)/sizeof(*arr);
+  for (size_t i = 0; i < n; ++i) {
+    arr[i] = (int)i;
+  }
+  cut_assert_eq(stdis_sorted_until_int(arr, n), n);
+  arr[100] = 5;
+  cut_assert_eq(stdis_sorted_until_int(arr, n), 100);
+  cut_assert_eq(stdis_sorted_until_int(arr, 0), 0);
+
+  arr[70] = -4;
+  arr[120] = -4;
+  arr[90] = 1000;
+  cut_assert_eq(stdmin_element_int(arr, n), 70);
+  cut_assert_eq(stdmax_element_int(arr, n), 90);
+  size_t lo, hi;
+  cut_assert_true(stdminmax_element_int(arr, n, &lo, &hi));
+  cut_assert_eq(lo, 70);
+  cut_assert_eq(hi, 90);
+  cut_assert_false(stdminmax_element_int(arr, 0, &lo, &hi));
+
+  double d[3] = {2.5, -1.0, 7.25};
+  cut_assert_eq(stdmin_element_double(d, 3), 1);
+  cut_assert_eq(stdmax_element_double(d, 3), 2);
+  cut_assert_eq(stdis_sorted_until_double(d, 3), 1);
+}
+
 void test_swap() {
     int a_int = 3, b_int = 5;
     int tst1 = a_int; int tst2 = b_int;
@@ -108,6 +281,194 @@ void test_swap() {
     cut_assert_eq(b_char, t1);
 }
 
+void
+add_int(void *acc, const void *x)
+{
+  *(int *)acc += *(const int *)x;
+}
+
+// Not commutative, so the order of the fold shows.
+void
+append_digit(void *acc, const void *x)
+{
+  *(long *)acc = *(long *)acc*10+*(const int *)x;
+}
+
+void
+test_reduce_scan(void)
+{
+  int arr[5] = {1, 2, 3, 4, 5};
+  int total = 0;
+  std_reduce(arr, sizeof(int), 5, &total, add_int);
+  cut_assert_eq(total, 15);
+
+  long digits = 0;
+  int d[4] = {1, 2, 3, 4};
+  std_reduce(d, sizeof(int), 4, &digits, append_digit);
+  cut_assert_eq(digits, 1234);
+
+  int out[5];
+  std_inclusive_scan(arr, out, sizeof(int), 5, add_int);
+  cut_assert_eq(out[0], 1);
+  cut_assert_eq(out[4], 15);
+  int init = 100;
+  std_exclusive_scan(arr, out, sizeof(int), 5, &init, add_int);
+  cut_assert_eq(out[0], 100);
+  cut_assert_eq(out[4], 110);
+  // In place.
+  std_inclusive_scan(arr, arr, sizeof(int), 5, add_int);
+  cut_assert_eq(arr[2], 6);
+  cut_assert_eq(arr[4], 15);
+
+  int m[6] = {3, 1, 4, 1, 5, 5};
+  size_t lo = 0, hi = 0;
+  cut_assert_true(std_minmax(m, sizeof(int), 6, compare_int, &lo, &hi));
+  cut_assert_eq(lo, 1);
+  cut_assert_eq(hi, 4);
+  cut_assert_false(std_minmax(m, sizeof(int), 0, compare_int, &lo, &hi));
+}
+
+// The SIMD kernels only exist on x86.
+#ifdef __STD_X86
+#define TEST_NUMERIC_KERNELS(sfx)                                       \
+  if (__builtin_cpu_supports("sse4.2")) {                               \
+    ok &= __std_sum_##sfx##_sse(in, len) == want;                       \
+  }                                                                     \
+  if (__builtin_cpu_supports("avx2")) {                                 \
+    ok &= __std_sum_##sfx##_avx2(in, len) == want;                      \
+  }
+#else
+#define TEST_NUMERIC_KERNELS(sfx)
+#endif
+
+// Every kernel must agree with a plain loop for every
+// length around the vector and unroll sizes, in place
+// or not. The values are small integers, so even float
+// sums are exact whatever order they are added in.
+#define TEST_NUMERIC_TYPE(sfx, type, atype)                             \
+  void                                                                  \
+  test_numeric_##sfx(void)                                              \
+  {                                                                     \
+    type in[70] = {0}, out[70];                                         \
+    int ok = 1;                                                         \
+    for (size_t len = 0; len <= 70; ++len) {                            \
+      atype want = 0;                                                   \
+      for (size_t i = 0; i < len; ++i) {                                \
+        in[i] = (type)((i*7)%23)-(type)11;                              \
+      }                                                                 \
+      if (len > 7) {                                                    \
+        in[len-3] = (type)-50;                                          \
+        in[len/2] = (type)60;                                           \
+        in[len-1] = (type)60;                                           \
+      }                                                                 \
+      for (size_t i = 0; i < len; ++i) {                                \
+        want += (atype)in[i];                                           \
+      }                                                                 \
+      ok &= std_reduce_sum_##sfx(in, len) == (type)want;                \
+      ok &= __std_sum_##sfx##_scalar(in, len, 0) == want;               \
+      TEST_NUMERIC_KERNELS(sfx);                                        \
+                                                                        \
+      size_t lo = 99, hi = 99;                                          \
+      int some = std_minmax_##sfx(in, len, &lo, &hi);                   \
+      ok &= some == (len > 0);                                          \
+      if (len > 7) {                                                    \
+        ok &= lo == len-3 && hi == len/2;                               \
+      }                                                                 \
+                                                                        \
+      for (int excl = 0; excl < 2; ++excl) {                            \
+        for (int kern = 0; kern < 3; ++kern) {                          \
+          type *dst = kern == 2 ? in : out;                             \
+          type copy[70];                                                \
+          (void)memcpy(copy, in, sizeof(copy));                         \
+          if (kern == 0 && excl) {                                      \
+            std_exclusive_scan_##sfx(in, dst, len, (type)5);            \
+          } else if (kern == 0) {                                       \
+            std_inclusive_scan_##sfx(in, dst, len);                     \
+          } else {                                                      \
+            (void)__std_scan_##sfx##_scalar(in, dst, len, excl ? 5 : 0, excl);  \
+          }                                                             \
+          atype acc = excl ? 5 : 0;                                     \
+          for (size_t i = 0; i < len; ++i) {                            \
+            if (excl) {                                                 \
+              ok &= dst[i] == (type)acc;                                \
+              acc += (atype)copy[i];                                    \
+            } else {                                                    \
+              acc += (atype)copy[i];                                    \
+              ok &= dst[i] == (type)acc;                                \
+            }                                                           \
+          }                                                             \
+          (void)memcpy(in, copy, sizeof(copy));                         \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+    cut_assert_true(ok);                                                \
+  }
+
+TEST_NUMERIC_TYPE(i32, int32_t, uint32_t)
+TEST_NUMERIC_TYPE(i64, int64_t, uint64_t)
+TEST_NUMERIC_TYPE(f32, float, float)
+TEST_NUMERIC_TYPE(f64, double, double)
+
+void
+test_numeric_edges(void)
+{
+  int32_t big[3] = {INT32_MAX, 1, 0};
+  cut_assert_eq(std_reduce_sum_i32(big, 2), INT32_MIN);
+
+  double d[4] = {0.0/0.0, 2, -1, 0.0/0.0};
+  size_t lo = 0, hi = 0;
+  cut_assert_true(std_minmax_f64(d, 4, &lo, &hi));
+  cut_assert_eq(lo, 2);
+  cut_assert_eq(hi, 1);
+  d[1] = d[2] = d[0];
+  cut_assert_false(std_minmax_f64(d, 4, &lo, &hi));
+}
+
+// Checks every bound against a linear scan, for every
+// length up to a few levels of halving, with runs of
+// equal elements and keys before, between and after them.
+void
+test_bounds(void)
+{
+  int32_t arr[40];
+  int ok = 1;
+  for (size_t len = 0; len <= 40; ++len) {
+    for (size_t i = 0; i < len; ++i) {
+      arr[i] = (int32_t)(i/3*2);
+    }
+    for (int32_t key = -1; key <= (int32_t)len; ++key) {
+      size_t lo = 0, hi = 0;
+      while (lo < len && arr[lo] < key) {
+        lo += 1;
+      }
+      hi = lo;
+      while (hi < len && arr[hi] == key) {
+        hi += 1;
+      }
+      const int32_t *end = arr+len;
+      const void *plo, *phi;
+      ok &= std_lower_bound(arr, end, sizeof(int32_t), &key, compare_int) == arr+lo;
+      ok &= std_upper_bound(arr, end, sizeof(int32_t), &key, compare_int) == arr+hi;
+      std_equal_range(arr, end, sizeof(int32_t), &key, compare_int, &plo, &phi);
+      ok &= plo == arr+lo && phi == arr+hi;
+      ok &= std_lower_bound_i32(arr, len, key) == lo;
+      ok &= std_upper_bound_i32(arr, len, key) == hi;
+      size_t tlo, thi;
+      std_equal_range_i32(arr, len, key, &tlo, &thi);
+      ok &= tlo == lo && thi == hi;
+    }
+  }
+  cut_assert_true(ok);
+
+  double d[5] = {-2.5, -0.0, 0.0, 1e300, __builtin_inf()};
+  cut_assert_eq(std_lower_bound_f64(d, 5, 0.0), 1);
+  cut_assert_eq(std_upper_bound_f64(d, 5, 0.0), 3);
+  cut_assert_eq(std_lower_bound_f64(d, 5, __builtin_inf()), 4);
+  uint64_t u[3] = {1, UINT64_MAX-1, UINT64_MAX};
+  cut_assert_eq(std_upper_bound_u64(u, 3, UINT64_MAX), 3);
+  cut_assert_eq(std_lower_bound_u64(u, 3, 2), 1);
+}
+
 int
 main(void)
 {
@@ -119,6 +480,22 @@ main(void)
   test_none_of();
   test_swap();
   test_is_sorted();
+  test_is_sorted_i32();
+  test_is_sorted_u32();
+  test_is_sorted_i64();
+  test_is_sorted_u64();
+  test_is_sorted_f32();
+  test_is_sorted_f64();
+  test_is_sorted_signedness();
+  test_algo_decl();
+  test_ord_algo_decl();
+  test_reduce_scan();
+  test_numeric_i32();
+  test_numeric_i64();
+  test_numeric_f32();
+  test_numeric_f64();
+  test_numeric_edges();
+  test_bounds();
   CUT_END;
   return 0;
 }
@@ -0,0 +1,106 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STD_INSTRUMENT
+#define STDVEC_IMPL
+#define STDQUEUE_IMPL
+#define STDSTACK_IMPL
+#include "../cstd.h"
+
+void
+test_vec_counters(void)
+{
+  StdInstrumentStats st;
+  int found = std_instrument_stats("stdvec", &st);
+  cut_assert_false(found);
+
+  StdVec v = stdvec_new(sizeof(int));
+  for (int i = 0; i < 1000; ++i) {
+    stdvec_push(&v, &i);
+  }
+  found = std_instrument_stats("stdvec", &st);
+  cut_assert_true(found);
+  // One malloc, then a realloc at every doubling up to 1024.
+  cut_assert_eq(st.allocs, 1);
+  cut_assert_eq(st.reallocs, 10);
+  cut_assert_eq(st.frees, 0);
+  cut_assert_true(st.bytes >= 1024*sizeof(int));
+  // The last growth to 1024 left 1024-512-1 slots unused.
+  cut_assert_true(st.wasted >= 511*sizeof(int));
+#ifdef __GLIBC__
+  cut_assert_true(st.live >= (int64_t)(1024*sizeof(int)));
+  cut_assert_true(st.peak >= st.live);
+#endif
+
+  stdvec_free(&v);
+  std_instrument_stats("stdvec", &st);
+  cut_assert_eq(st.frees, 1);
+#ifdef __GLIBC__
+  cut_assert_eq(st.live, 0);
+  cut_assert_true(st.peak >= (int64_t)(1024*sizeof(int)));
+#endif
+}
+
+void
+test_types_are_separate(void)
+{
+  StdInstrumentStats before, after;
+  std_instrument_stats(NULL, &before);
+
+  StdQueue q = stdqueue_new(sizeof(int));
+  for (int i = 0; i < 100; ++i) {
+    stdqueue_enqueue(&q, &i);
+  }
+  StdStack s = stdstack_new(sizeof(int));
+  stdstack_push(&s, &q.len);
+  stdqueue_free(&q);
+  stdstack_free(&s);
+
+  StdInstrumentStats st;
+  int found = std_instrument_stats("stdqueue", &st);
+  cut_assert_true(found);
+  cut_assert_eq(st.allocs, 1);
+  cut_assert_eq(st.frees, 1);
+  cut_assert_true(st.reallocs > 0);
+  found = std_instrument_stats("stdstack", &st);
+  cut_assert_true(found);
+  cut_assert_eq(st.allocs, 1);
+  cut_assert_eq(st.reallocs, 0);
+
+  std_instrument_stats(NULL, &after);
+  cut_assert_eq(after.allocs-before.allocs, 2);
+  cut_assert_eq(after.frees-before.frees, 2);
+}
+
+void
+test_dump(void)
+{
+  char *buf = NULL;
+  size_t len = 0;
+  FILE *out = open_memstream(&buf, &len);
+  std_instrument_dump(out, 1);
+  fclose(out);
+  cut_assert_true(buf[0] == '{');
+  cut_assert_not_null(strstr(buf, "\"type\":\"stdvec\""));
+  cut_assert_not_null(strstr(buf, "\"func\":\"stdvec_push\""));
+  free(buf);
+
+  out = open_memstream(&buf, &len);
+  std_instrument_dump(out, 0);
+  fclose(out);
+  cut_assert_not_null(strstr(buf, "stdqueue"));
+  cut_assert_not_null(strstr(buf, "cstd.h:"));
+  free(buf);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_vec_counters();
+  test_types_are_separate();
+  test_dump();
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,205 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STD_INSTRUMENT
+#define STDITER_IMPL
+#include "../cstd.h"
+
+void
+half(void *out, const void *x, void *ctx)
+{
+  (void)ctx;
+  *(double *)out = *(const int *)x/2.0;
+}
+
+void
+add(void *out, const void *x, void *ctx)
+{
+  *(double *)out = *(const double *)x+*(const double *)ctx;
+}
+
+int
+is_whole(const void *x, void *ctx)
+{
+  (void)ctx;
+  double d = *(const double *)x;
+  return d == (double)(long)d;
+}
+
+int
+is_multiple(const void *x, void *ctx)
+{
+  return *(const int *)x % *(const int *)ctx == 0;
+}
+
+void
+sum(void *acc, const void *x, void *ctx)
+{
+  (void)ctx;
+  *(double *)acc += *(const double *)x;
+}
+
+void
+count_calls(void *acc, const void *x, void *ctx)
+{
+  (void)x;
+  (void)ctx;
+  *(size_t *)acc += 1;
+}
+
+struct Triple
+{
+  int a, b, c;
+};
+
+void
+copy_triple(void *out, const void *x, void *ctx)
+{
+  (void)ctx;
+  *(struct Triple *)out = *(const struct Triple *)x;
+}
+
+// Counts in `ctx` the calls where `out` is not aligned
+// for a double.
+void
+sum_triple(void *out, const void *x, void *ctx)
+{
+  const struct Triple *t = x;
+  *(int *)ctx += (uintptr_t)out % _Alignof(double) != 0;
+  *(double *)out = t->a+t->b+t->c;
+}
+
+StdVec
+make_ints(size_t n)
+{
+  StdVec v = stdvec_new(sizeof(int));
+  for (size_t i = 0; i < n; ++i) {
+    int x = (int)i;
+    stdvec_push(&v, &x);
+  }
+  return v;
+}
+
+void
+test_map_filter_collect(void)
+{
+  StdVec v = make_ints(100);
+  double one = 1;
+  StdIter it = stditer_from(&v);
+  stditer_filter(stditer_map(stditer_map(&it, half, sizeof(double), NULL),
+                             add, sizeof(double), &one),
+                 is_whole, NULL);
+  StdVec out = stditer_collect(&it);
+  cut_assert_eq(out.stride, sizeof(double));
+  cut_assert_eq(out.len, 50);
+  cut_assert_true(*(double *)stdvec_at(&out, 0) == 1.0);
+  cut_assert_true(*(double *)stdvec_at(&out, 49) == 50.0);
+
+  // The source is untouched, and the pipeline can run again.
+  cut_assert_eq(*(int *)stdvec_at(&v, 99), 99);
+  StdVec again = stditer_collect(&it);
+  cut_assert_eq(again.len, out.len);
+  cut_assert_eq(memcmp(again.data, out.data, out.len*out.stride), 0);
+  stdvec_free(&again);
+  stdvec_free(&out);
+  stdvec_free(&v);
+}
+
+// A take counts only what gets to it, and stops reading
+// the source once it is full.
+void
+test_take(void)
+{
+  StdVec v = make_ints(1000);
+  int three = 3;
+  StdIter it = stditer_from(&v);
+  stditer_take(stditer_filter(&it, is_multiple, &three), 4);
+  StdVec out = stditer_collect(&it);
+  cut_assert_eq(out.len, 4);
+  cut_assert_eq(*(int *)stdvec_at(&out, 3), 9);
+  stdvec_free(&out);
+
+  size_t calls = 0;
+  it = stditer_from(&v);
+  stditer_map(stditer_take(&it, 10), half, sizeof(double), NULL);
+  stditer_reduce(&it, &calls, count_calls, NULL);
+  cut_assert_eq(calls, 10);
+
+  calls = 0;
+  it = stditer_from(&v);
+  stditer_take(&it, 0);
+  stditer_reduce(&it, &calls, count_calls, NULL);
+  cut_assert_eq(calls, 0);
+  out = stditer_collect(&it);
+  cut_assert_eq(out.len, 0);
+  stdvec_free(&out);
+  stdvec_free(&v);
+}
+
+void
+test_reduce(void)
+{
+  int arr[] = {1, 2, 3, 4, 5, 6};
+  StdIter it = stditer_from_array(arr, 6, sizeof(int));
+  stditer_map(&it, half, sizeof(double), NULL);
+  double total = 0;
+  stditer_reduce(&it, &total, sum, NULL);
+  cut_assert_true(total == 10.5);
+}
+
+// A map into a double right after a map into a 12 byte
+// struct still writes to aligned memory.
+void
+test_map_alignment(void)
+{
+  struct Triple arr[] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+  StdIter it = stditer_from_array(arr, 3, sizeof(*arr));
+  int misaligned = 0;
+  stditer_map(stditer_map(&it, copy_triple, sizeof(struct Triple), NULL),
+              sum_triple, sizeof(double), &misaligned);
+  double total = 0;
+  stditer_reduce(&it, &total, sum, NULL);
+  cut_assert_true(total == 45.0);
+  cut_assert_eq(misaligned, 0);
+}
+
+// However many stages there are, collect allocates its
+// output once and nothing else.
+void
+test_collect_allocates_once(void)
+{
+  StdVec v = make_ints(10000);
+  double one = 1;
+  StdIter it = stditer_from(&v);
+  for (int s = 0; s < 8; ++s) {
+    if (s == 0) {
+      stditer_map(&it, half, sizeof(double), NULL);
+    } else {
+      stditer_map(&it, add, sizeof(double), &one);
+    }
+  }
+  StdInstrumentStats before, after;
+  std_instrument_stats(NULL, &before);
+  StdVec out = stditer_collect(&it);
+  std_instrument_stats(NULL, &after);
+  cut_assert_true(after.allocs-before.allocs == 1);
+  cut_assert_true(after.reallocs == before.reallocs);
+  cut_assert_eq(out.len, 10000);
+  cut_assert_true(*(double *)stdvec_at(&out, 2) == 8.0);
+  stdvec_free(&out);
+  stdvec_free(&v);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_map_filter_collect();
+  test_take();
+  test_reduce();
+  test_map_alignment();
+  test_collect_allocates_once();
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,134 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDLIST_IMPL
+#include "../cstd.h"
+
+struct Entry
+{
+  int key;
+  StdListNode node;
+};
+
+int
+keys_match(StdList *list, int *expected, size_t n)
+{
+  size_t i = 0;
+  if (list->len != n) {
+    return 0;
+  }
+  STDLIST_FOR_EACH(node, list) {
+    if (STDLIST_ENTRY(node, struct Entry, node)->key != expected[i++]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void
+test_intrusive_push_unlink(void)
+{
+  struct Entry e[5];
+  StdList list = stdlist_new();
+  for (int i = 0; i < 5; ++i) {
+    e[i].key = i;
+    stdlist_push_back(&list, &e[i].node);
+  }
+  cut_assert_true(keys_match(&list, (int[]){0,1,2,3,4}, 5));
+
+  stdlist_unlink(&list, &e[2].node);
+  stdlist_unlink(&list, &e[0].node);
+  stdlist_unlink(&list, &e[4].node);
+  cut_assert_true(keys_match(&list, (int[]){1,3}, 2));
+
+  stdlist_push_front(&list, &e[4].node);
+  stdlist_insert_before(&list, &e[3].node, &e[2].node);
+  cut_assert_true(keys_match(&list, (int[]){4,1,2,3}, 4));
+
+  cut_assert_eq(STDLIST_ENTRY(stdlist_pop_back(&list), struct Entry, node)->key, 3);
+  cut_assert_eq(STDLIST_ENTRY(stdlist_pop_front(&list), struct Entry, node)->key, 4);
+  cut_assert_true(keys_match(&list, (int[]){1,2}, 2));
+}
+
+void
+test_move_and_splice(void)
+{
+  struct Entry e[6];
+  StdList a = stdlist_new(), b = stdlist_new();
+  for (int i = 0; i < 6; ++i) {
+    e[i].key = i;
+    stdlist_push_back(i < 3 ? &a : &b, &e[i].node);
+  }
+
+  stdlist_move_to_front(&a, &e[2].node);
+  stdlist_move_to_back(&a, &e[0].node);
+  cut_assert_true(keys_match(&a, (int[]){2,1,0}, 3));
+
+  stdlist_splice(&a, &e[1].node, &b);
+  cut_assert_true(keys_match(&a, (int[]){2,3,4,5,1,0}, 6));
+  cut_assert_true(stdlist_empty(&b));
+
+  stdlist_splice(&b, NULL, &a);
+  cut_assert_true(keys_match(&b, (int[]){2,3,4,5,1,0}, 6));
+  cut_assert_null(stdlist_front(&a));
+
+  // Unlink while iterating.
+  STDLIST_FOR_EACH_SAFE(node, tmp, &b) {
+    if (STDLIST_ENTRY(node, struct Entry, node)->key % 2 == 0) {
+      stdlist_unlink(&b, node);
+    }
+  }
+  cut_assert_true(keys_match(&b, (int[]){3,5,1}, 3));
+}
+
+void
+test_slab_list(void)
+{
+  StdSlabList list = stdslablist_new(sizeof(double));
+  double *ptrs[1000];
+  for (int i = 0; i < 1000; ++i) {
+    ptrs[i] = stdslablist_push_back(&list, STDCL(double, i));
+  }
+  cut_assert_eq(stdslablist_len(&list), 1000);
+
+  // Pointers stay valid while the list grows.
+  int stable = 1;
+  for (int i = 0; i < 1000; ++i) {
+    if (*ptrs[i] != (double)i) {
+      stable = 0;
+    }
+  }
+  cut_assert_true(stable);
+
+  stdslablist_rm(&list, ptrs[500]);
+  stdslablist_move_to_front(&list, ptrs[999]);
+  cut_assert_true(*(double *)stdslablist_front(&list) == 999.0);
+  cut_assert_true(*(double *)stdslablist_back(&list) == 998.0);
+
+  double x;
+  stdslablist_pop_front(&list, &x);
+  cut_assert_true(x == 999.0);
+  stdslablist_pop_back(&list, &x);
+  cut_assert_true(x == 998.0);
+  cut_assert_eq(stdslablist_len(&list), 997);
+
+  // Removed nodes are reused before new slabs are made.
+  size_t slabs = stdpool_stats(&list.pool).slabs;
+  stdslablist_push_front(&list, STDCL(double, -1));
+  stdslablist_push_front(&list, STDCL(double, -2));
+  cut_assert_eq(stdpool_stats(&list.pool).slabs, slabs);
+
+  stdslablist_free(&list);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_intrusive_push_unlink();
+  test_move_and_splice();
+  test_slab_list();
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,151 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDMPMCQUEUE_IMPL
+#include "../cstd.h"
+
+#define N_PRODUCERS 4
+#define N_CONSUMERS 4
+#define N_PER_PRODUCER 20000
+
+struct Item
+{
+  int producer;
+  int value;
+  char pad[5];  // Make the stride awkward on purpose
+};
+
+struct Ctx
+{
+  StdMpmcQueue *q;
+  int id;
+  _Atomic int *seen;
+  _Atomic long *consumed;
+};
+
+void
+test_try_enqueue_dequeue(void)
+{
+  StdMpmcQueue q = stdmpmcqueue_new(sizeof(int), 3);
+  cut_assert_eq(q.cap, 4);
+
+  for (int i = 0; i < 4; ++i) {
+    cut_assert_true(stdmpmcqueue_try_enqueue(&q, &i));
+  }
+  cut_assert_false(stdmpmcqueue_try_enqueue(&q, STDCL(int, 99)));
+  cut_assert_eq(stdmpmcqueue_len(&q), 4);
+
+  int x;
+  cut_assert_true(stdmpmcqueue_try_dequeue(&q, &x));
+  cut_assert_eq(x, 0);
+
+  // Wrap around and make sure order holds.
+  cut_assert_true(stdmpmcqueue_try_enqueue(&q, STDCL(int, 4)));
+  for (int i = 1; i < 5; ++i) {
+    cut_assert_true(stdmpmcqueue_try_dequeue(&q, &x));
+    cut_assert_eq(x, i);
+  }
+  cut_assert_false(stdmpmcqueue_try_dequeue(&q, &x));
+
+  stdmpmcqueue_free(&q);
+}
+
+void
+test_batch_dequeue(void)
+{
+  StdMpmcQueue q = stdmpmcqueue_new(sizeof(int), 8);
+  int out[8] = {0};
+
+  for (int i = 0; i < 6; ++i) {
+    stdmpmcqueue_enqueue(&q, &i);
+  }
+  cut_assert_eq(stdmpmcqueue_try_dequeue_n(&q, out, 4), 4);
+  cut_assert_eq(stdmpmcqueue_try_dequeue_n(&q, out+4, 4), 2);
+  for (int i = 0; i < 6; ++i) {
+    cut_assert_eq(out[i], i);
+  }
+  cut_assert_eq(stdmpmcqueue_try_dequeue_n(&q, out, 4), 0);
+
+  stdmpmcqueue_free(&q);
+}
+
+void *
+producer(void *arg)
+{
+  struct Ctx *ctx = (struct Ctx *)arg;
+  struct Item item = {0};
+  item.producer = ctx->id;
+  for (int i = 0; i < N_PER_PRODUCER; ++i) {
+    item.value = i;
+    stdmpmcqueue_enqueue(ctx->q, &item);
+  }
+  return NULL;
+}
+
+void *
+consumer(void *arg)
+{
+  struct Ctx *ctx = (struct Ctx *)arg;
+  long total = N_PRODUCERS*N_PER_PRODUCER;
+  struct Item items[8];
+  while (atomic_load(ctx->consumed) < total) {
+    size_t n = stdmpmcqueue_try_dequeue_n(ctx->q, items, 1+ctx->id%8);
+    if (n == 0) {
+      sched_yield();
+      continue;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      atomic_fetch_add(&ctx->seen[items[i].producer*N_PER_PRODUCER+items[i].value], 1);
+    }
+    atomic_fetch_add(ctx->consumed, (long)n);
+  }
+  return NULL;
+}
+
+void
+test_stress_many_threads(void)
+{
+  StdMpmcQueue q = stdmpmcqueue_new(sizeof(struct Item), 64);
+  _Atomic int *seen = calloc(N_PRODUCERS*N_PER_PRODUCER, sizeof(*seen));
+  _Atomic long consumed = 0;
+  pthread_t threads[N_PRODUCERS+N_CONSUMERS];
+  struct Ctx ctxs[N_PRODUCERS+N_CONSUMERS];
+
+  for (int i = 0; i < N_PRODUCERS+N_CONSUMERS; ++i) {
+    ctxs[i] = (struct Ctx) {
+      .q = &q,
+      .id = i < N_PRODUCERS ? i : i-N_PRODUCERS,
+      .seen = seen,
+      .consumed = &consumed,
+    };
+    pthread_create(&threads[i], NULL, i < N_PRODUCERS ? producer : consumer, &ctxs[i]);
+  }
+  for (int i = 0; i < N_PRODUCERS+N_CONSUMERS; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  // Every item must be received exactly once.
+  int exactly_once = 1;
+  for (int i = 0; i < N_PRODUCERS*N_PER_PRODUCER; ++i) {
+    if (atomic_load(&seen[i]) != 1) {
+      exactly_once = 0;
+    }
+  }
+  cut_assert_true(exactly_once);
+  cut_assert_eq(stdmpmcqueue_len(&q), 0);
+
+  free(seen);
+  stdmpmcqueue_free(&q);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_try_enqueue_dequeue();
+  test_batch_dequeue();
+  test_stress_many_threads();
+  CUT_END;
+  return 0;
+}
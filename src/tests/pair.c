@@ -2,6 +2,7 @@
 #define CUT_ABORT_ON_FAIL
 #define CUT_IMPL
 #include "./cut.h"
+#define STDFUNCS_IMPL
 #define STDPAIR_IMPL
 #include "../cstd.h"
 
@@ -29,12 +30,96 @@ test_basic_pair(void)
   cut_assert_eq(*(float *)stdpair_snd(&p), y);
 }
 
+STDPAIR_DECL(int, double);
+STDTUPLE_DECL(Edge, int, int, float);
+
+void
+test_pair_decl(void)
+{
+  StdPair_int_double arr[4] = {
+    stdpair_int_double_new(2, 1.),
+    stdpair_int_double_new(1, 5.),
+    stdpair_int_double_new(2, -3.),
+    stdpair_int_double_new(1, 5.),
+  };
+  cut_assert_eq(sizeof(arr), 4*sizeof(StdPair_int_double));
+
+  qsort(arr, 4, sizeof(*arr), stdpair_int_double_cmp);
+  cut_assert_eq(arr[0].fst, 1);
+  cut_assert_eq(arr[2].fst, 2);
+  cut_assert_true(arr[2].snd == -3.);
+  cut_assert_true(arr[3].snd == 1.);
+
+  int sorted = std_is_sorted(arr, arr+4, sizeof(*arr), stdpair_int_double_cmp);
+  cut_assert_true(sorted);
+  int eq = stdpair_int_double_eq(&arr[0], &arr[1]);
+  cut_assert_true(eq);
+  eq = stdpair_int_double_eq(&arr[1], &arr[2]);
+  cut_assert_false(eq);
+
+  uint64_t h0 = stdpair_int_double_hash(&arr[0], 0);
+  uint64_t h1 = stdpair_int_double_hash(&arr[1], 0);
+  uint64_t h2 = stdpair_int_double_hash(&arr[2], 0);
+  cut_assert_eq(h0, h1);
+  cut_assert_true(h0 != h2);
+
+  // Padding between the members is not hashed.
+  StdPair_int_double a, b;
+  memset(&a, 0x00, sizeof(a));
+  memset(&b, 0xff, sizeof(b));
+  a.fst = b.fst = 7;
+  a.snd = b.snd = 2.5;
+  h0 = stdpair_int_double_hash(&a, 42);
+  h1 = stdpair_int_double_hash(&b, 42);
+  cut_assert_eq(h0, h1);
+
+  // -0.0 == 0.0, so they must hash the same.
+  b.snd = a.snd = 0.;
+  b.snd = -b.snd;
+  cut_assert_true(stdpair_int_double_eq(&a, &b));
+  h0 = stdpair_int_double_hash(&a, 42);
+  h1 = stdpair_int_double_hash(&b, 42);
+  cut_assert_eq(h0, h1);
+}
+
+void
+test_tuple_decl(void)
+{
+  Edge edges[4] = {
+    Edge_new(1, 2, .5f),
+    Edge_new(0, 9, 1.f),
+    Edge_new(1, 2, .25f),
+    Edge_new(1, 1, 9.f),
+  };
+  qsort(edges, 4, sizeof(*edges), Edge_cmp);
+  cut_assert_eq(edges[0]._0, 0);
+  cut_assert_eq(edges[1]._1, 1);
+  cut_assert_true(edges[2]._2 == .25f);
+  cut_assert_true(edges[3]._2 == .5f);
+
+  Edge e = Edge_new(1, 2, .5f);
+  int eq = Edge_eq(&e, &edges[3]);
+  cut_assert_true(eq);
+  eq = Edge_eq(&e, &edges[2]);
+  cut_assert_false(eq);
+  uint64_t h0 = Edge_hash(&e, 1), h1 = Edge_hash(&edges[3], 1);
+  cut_assert_eq(h0, h1);
+  h1 = Edge_hash(&edges[2], 1);
+  cut_assert_true(h0 != h1);
+
+  Edge z = Edge_new(1, 2, 0.f), nz = Edge_new(1, 2, -0.f);
+  cut_assert_true(Edge_eq(&z, &nz));
+  cut_assert_eq(Edge_hash(&z, 1), Edge_hash(&nz, 1));
+}
+
 int
 main(void)
 {
   CUT_BEGIN;
   test_basic_pair();
   test_modifying_pair();
+  test_pair_decl();
+  test_tuple_decl();
   CUT_END;
   return 0;
 }
@@ -0,0 +1,182 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDPARFUNCS_IMPL
+#include "../cstd.h"
+
+#define N 1000000
+
+int
+is_positive(const void *x, void *ctx)
+{
+  (void)ctx;
+  return (*(int *)x) > -1;
+}
+
+int
+is_negative(const void *x, void *ctx)
+{
+  (void)ctx;
+  return (*(int *)x) < 0;
+}
+
+int
+greater_than(const void *x, void *ctx)
+{
+  return (*(int *)x) > *(int *)ctx;
+}
+
+// Counts how many elements it was called on.
+int
+counting_is_negative(const void *x, void *ctx)
+{
+  atomic_fetch_add_explicit((_Atomic size_t *)ctx, 1, memory_order_relaxed);
+  return (*(int *)x) < 0;
+}
+
+int *
+make_arr(void)
+{
+  int *arr = malloc(N*sizeof(int));
+  for (int i = 0; i < N; ++i) {
+    arr[i] = i;
+  }
+  return arr;
+}
+
+void
+test_all_of_par(void)
+{
+  int *arr = make_arr();
+  cut_assert_true(stdall_of_par(arr, sizeof(*arr), N, is_positive, NULL));
+  arr[N-1] = -1;
+  cut_assert_false(stdall_of_par(arr, sizeof(*arr), N, is_positive, NULL));
+  cut_assert_true(stdall_of_par(arr, sizeof(*arr), 0, is_negative, NULL));
+  free(arr);
+}
+
+void
+test_any_of_par(void)
+{
+  int *arr = make_arr();
+  cut_assert_false(stdany_of_par(arr, sizeof(*arr), N, is_negative, NULL));
+  arr[N/2] = -1;
+  cut_assert_true(stdany_of_par(arr, sizeof(*arr), N, is_negative, NULL));
+  cut_assert_true(stdany_of_par(arr, sizeof(*arr), N, greater_than, STDCL(int, N-2)));
+  cut_assert_false(stdany_of_par(arr, sizeof(*arr), N, greater_than, STDCL(int, N)));
+  free(arr);
+}
+
+void
+test_none_of_par(void)
+{
+  int *arr = make_arr();
+  cut_assert_true(stdnone_of_par(arr, sizeof(*arr), N, is_negative, NULL));
+  cut_assert_false(stdnone_of_par(arr, sizeof(*arr), N, is_positive, NULL));
+  // Small arrays take the serial path.
+  cut_assert_false(stdnone_of_par(arr, sizeof(*arr), 10, greater_than, STDCL(int, 5)));
+  free(arr);
+}
+
+void
+test_stops_early(void)
+{
+  int *arr = make_arr();
+  _Atomic size_t calls = 0;
+  arr[0] = -1;
+  cut_assert_true(stdany_of_par(arr, sizeof(*arr), N, counting_is_negative, (void *)&calls));
+  size_t n = atomic_load(&calls);
+  cut_assert_true(n < N);
+  free(arr);
+}
+
+// Composes affine maps x -> a*x+b, which is associative
+// but not commutative, so chunks folded out of order show.
+struct affine
+{
+  uint32_t a, b;
+};
+
+void
+compose(void *acc, const void *x)
+{
+  struct affine *f = acc;
+  const struct affine *g = x;
+  f->a *= g->a;
+  f->b = f->b*g->a+g->b;
+}
+
+void
+test_inclusive_scan_par(void)
+{
+  size_t lens[] = {0, 100, 16385, 3*16384+7, N};
+  struct affine *in = malloc(N*sizeof(*in));
+  struct affine *want = malloc(N*sizeof(*in));
+  struct affine *got = malloc(N*sizeof(*in));
+  for (size_t i = 0; i < N; ++i) {
+    in[i] = (struct affine){(uint32_t)i*2+1, (uint32_t)i};
+  }
+  for (size_t k = 0; k < sizeof(lens)/sizeof(*lens); ++k) {
+    size_t n = lens[k];
+    std_inclusive_scan(in, want, sizeof(*in), n, compose);
+    std_inclusive_scan_par(in, got, sizeof(*in), n, compose);
+    cut_assert_eq(memcmp(want, got, n*sizeof(*in)), 0);
+  }
+  // In place.
+  std_inclusive_scan_par(in, in, sizeof(*in), N, compose);
+  cut_assert_eq(memcmp(want, in, N*sizeof(*in)), 0);
+  free(in);
+  free(want);
+  free(got);
+}
+
+void
+test_typed_scan_par(void)
+{
+  size_t lens[] = {0, 100, 16385, 3*16384+7, N};
+  int64_t *in = malloc(N*sizeof(*in));
+  int64_t *want = malloc(N*sizeof(*in));
+  int64_t *got = malloc(N*sizeof(*in));
+  for (size_t i = 0; i < N; ++i) {
+    in[i] = (int64_t)(i*7919 % 1000)-500;
+  }
+  for (size_t k = 0; k < sizeof(lens)/sizeof(*lens); ++k) {
+    size_t n = lens[k];
+    std_inclusive_scan_i64(in, want, n);
+    std_inclusive_scan_par_i64(in, got, n);
+    cut_assert_eq(memcmp(want, got, n*sizeof(*in)), 0);
+    std_exclusive_scan_i64(in, want, n, 42);
+    std_exclusive_scan_par_i64(in, got, n, 42);
+    cut_assert_eq(memcmp(want, got, n*sizeof(*in)), 0);
+  }
+  std_inclusive_scan_i64(in, want, N);
+  std_inclusive_scan_par_i64(in, in, N);
+  cut_assert_eq(memcmp(want, in, N*sizeof(*in)), 0);
+
+  // Small integers add up exactly as floats too.
+  float *f = malloc(N*sizeof(*f));
+  for (size_t i = 0; i < N; ++i) {
+    f[i] = (float)(i % 3);
+  }
+  std_inclusive_scan_par_f32(f, f, N);
+  cut_assert_true(f[N-1] == (float)(N/3*3));
+  free(f);
+  free(in);
+  free(want);
+  free(got);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_all_of_par();
+  test_any_of_par();
+  test_none_of_par();
+  test_stops_early();
+  test_inclusive_scan_par();
+  test_typed_scan_par();
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,131 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDPOOL_IMPL
+#include "../cstd.h"
+
+#define N_THREADS 4
+#define N_ROUNDS 2000
+
+struct Record
+{
+  long id;
+  double values[3];
+};
+
+void
+test_alloc_dealloc_reuse(void)
+{
+  StdPool pool = stdpool_new(sizeof(struct Record));
+  cut_assert_eq(pool.stride % 16, 0);
+
+  struct Record *a = stdpool_alloc(&pool);
+  struct Record *b = stdpool_alloc(&pool);
+  cut_assert_true(a != b);
+  a->id = 1;
+  b->id = 2;
+
+  // The last object given back is the next one handed out.
+  stdpool_dealloc(&pool, a);
+  cut_assert_true(stdpool_alloc(&pool) == (void *)a);
+
+  StdPoolStats stats = stdpool_stats(&pool);
+  cut_assert_eq(stats.in_use, 2);
+  cut_assert_eq(stats.slabs, 1);
+  cut_assert_true(stats.utilization > 0.0);
+
+  stdpool_free(&pool);
+}
+
+void
+test_many_objects_and_clr(void)
+{
+  StdPool pool = stdpool_new(sizeof(int));
+  int *objs[10000];
+  for (int i = 0; i < 10000; ++i) {
+    objs[i] = stdpool_alloc(&pool);
+    *objs[i] = i;
+  }
+
+  int intact = 1;
+  for (int i = 0; i < 10000; ++i) {
+    if (*objs[i] != i) {
+      intact = 0;
+    }
+  }
+  cut_assert_true(intact);
+
+  StdPoolStats before = stdpool_stats(&pool);
+  cut_assert_eq(before.in_use, 10000);
+  cut_assert_eq(before.peak, 10000);
+  cut_assert_true(before.capacity >= 10000);
+
+  // Bulk release keeps the slabs and hands
+  // out the same memory again.
+  stdpool_clr(&pool);
+  cut_assert_eq(stdpool_stats(&pool).in_use, 0);
+  for (int i = 0; i < 10000; ++i) {
+    stdpool_alloc(&pool);
+  }
+  StdPoolStats after = stdpool_stats(&pool);
+  cut_assert_eq(after.slabs, before.slabs);
+  cut_assert_eq(after.capacity, before.capacity);
+
+  stdpool_free(&pool);
+}
+
+void *
+worker(void *arg)
+{
+  StdPool *pool = (StdPool *)arg;
+  long *live[100];
+  for (int round = 0; round < N_ROUNDS; ++round) {
+    for (int i = 0; i < 100; ++i) {
+      live[i] = stdpool_alloc(pool);
+      *live[i] = round;
+    }
+    for (int i = 0; i < 100; ++i) {
+      if (*live[i] != round) {
+        return (void *)1;
+      }
+      stdpool_dealloc(pool, live[i]);
+    }
+  }
+  return NULL;
+}
+
+void
+test_many_threads(void)
+{
+  StdPool pool;
+  stdpool_init_mt(&pool, sizeof(long));
+  pthread_t threads[N_THREADS];
+  for (int i = 0; i < N_THREADS; ++i) {
+    pthread_create(&threads[i], NULL, worker, &pool);
+  }
+  for (int i = 0; i < N_THREADS; ++i) {
+    void *ret;
+    pthread_join(threads[i], &ret);
+    cut_assert_null(ret);
+  }
+
+  // Exited threads gave their magazines back.
+  StdPoolStats stats = stdpool_stats(&pool);
+  cut_assert_eq(stats.in_use, 0);
+  cut_assert_eq(stats.cached, 0);
+  cut_assert_true(stats.peak <= stats.capacity);
+
+  stdpool_free(&pool);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_alloc_dealloc_reuse();
+  test_many_objects_and_clr();
+  test_many_threads();
+  CUT_END;
+  return 0;
+}
@@ -42,12 +42,102 @@ test_inserting_small_num_of_elems(void)
   stdqueue_free(&q);
 }
 
+void
+test_growing_while_wrapped(void)
+{
+  StdQueue q = stdqueue_new(sizeof(int));
+  int next_in = 0, next_out = 0;
+
+  // Keep the queue partially drained so that
+  // `head` moves and the contents wrap before
+  // every growth.
+  for (int round = 0; round < 200; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      stdqueue_enqueue(&q, &next_in);
+      ++next_in;
+    }
+    for (int i = 0; i < 2; ++i) {
+      cut_assert_eq(*(int *)stdqueue_peek(&q), next_out);
+      ++next_out;
+      stdqueue_dequeue(&q);
+    }
+  }
+
+  while (!stdqueue_empty(&q)) {
+    cut_assert_eq(*(int *)stdqueue_peek(&q), next_out);
+    ++next_out;
+    stdqueue_dequeue(&q);
+  }
+  cut_assert_eq(next_out, next_in);
+  cut_assert_eq(q.cap & (q.cap-1), 0);
+
+  stdqueue_free(&q);
+}
+
+void
+test_bulk_enqueue_dequeue(void)
+{
+  StdQueue q = stdqueue_wcap(sizeof(int), 5);
+  cut_assert_eq(q.cap, 8);
+
+  int in[6] = {0,1,2,3,4,5};
+  int out[6] = {0};
+
+  cut_assert_eq(stdqueue_enqueue_n(&q, in, 6), 6);
+  cut_assert_eq(stdqueue_dequeue_n(&q, out, 4), 4);
+  for (int i = 0; i < 4; ++i) {
+    cut_assert_eq(out[i], i);
+  }
+
+  // This one wraps around the end of the buffer.
+  cut_assert_eq(stdqueue_enqueue_n(&q, in, 6), 6);
+  cut_assert_eq(q.len, 8);
+  cut_assert_eq(stdqueue_dequeue_n(&q, out, 2), 2);
+  cut_assert_eq(out[0], 4);
+  cut_assert_eq(out[1], 5);
+  cut_assert_eq(stdqueue_dequeue_n(&q, out, 10), 6);
+  for (int i = 0; i < 6; ++i) {
+    cut_assert_eq(out[i], i);
+  }
+  cut_assert_true(stdqueue_empty(&q));
+
+  stdqueue_free(&q);
+}
+
+void
+test_fixed_queue_does_not_grow(void)
+{
+  StdQueue q = stdqueue_fixed(sizeof(int), 4);
+  int in[6] = {0,1,2,3,4,5};
+
+  cut_assert_eq(stdqueue_enqueue_n(&q, in, 3), 3);
+  cut_assert_true(stdqueue_enqueue(&q, &in[3]));
+  cut_assert_true(stdqueue_full(&q));
+  cut_assert_false(stdqueue_enqueue(&q, &in[4]));
+  cut_assert_eq(stdqueue_enqueue_n(&q, in, 6), 0);
+  cut_assert_eq(q.cap, 4);
+
+  stdqueue_dequeue(&q);
+  cut_assert_eq(stdqueue_enqueue_n(&q, &in[4], 2), 1);
+  cut_assert_eq(q.cap, 4);
+
+  int out[4] = {0};
+  cut_assert_eq(stdqueue_dequeue_n(&q, out, 4), 4);
+  cut_assert_eq(out[0], 1);
+  cut_assert_eq(out[3], 4);
+
+  stdqueue_free(&q);
+}
+
 int
 main(void)
 {
   CUT_BEGIN;
   test_inserting_small_num_of_elems();
   test_inserting_large_num_of_elems();
+  test_growing_while_wrapped();
+  test_bulk_enqueue_dequeue();
+  test_fixed_queue_does_not_grow();
   CUT_END;
   return 0;
 }
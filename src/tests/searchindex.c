@@ -0,0 +1,123 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDSEARCHINDEX_IMPL
+#include "../cstd.h"
+
+int
+compare_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y)-(x < y);
+}
+
+// Every lookup must agree with a binary search of the
+// sorted array, for every tree shape up to a few full
+// levels, with runs of equal elements.
+void
+test_matches_binary_search(void)
+{
+  int ok = 1;
+  for (size_t len = 0; len <= 300; ++len) {
+    StdVec vec = stdvec_new(sizeof(uint64_t));
+    for (uint64_t i = 0; i < len; ++i) {
+      uint64_t x = i/2*3+1;
+      stdvec_push(&vec, &x);
+    }
+    const uint64_t *arr = vec.data;
+    StdSearchIndex idx = stdsearchindex_new(&vec, compare_u64);
+    uint64_t keys[500];
+    size_t nkeys = len/2*3+4, want[500], got[500];
+    for (uint64_t key = 0; key < nkeys; ++key) {
+      keys[key] = key;
+      want[key] = std_lower_bound_u64(arr, len, key);
+      size_t hi = std_upper_bound_u64(arr, len, key);
+      ok &= stdsearchindex_lower_bound(&idx, &key) == want[key];
+      ok &= stdsearchindex_upper_bound(&idx, &key) == hi;
+      ok &= stdsearchindex_lower_bound_u64(&idx, key) == want[key];
+      ok &= stdsearchindex_upper_bound_u64(&idx, key) == hi;
+      size_t lo = 1, up = 0;
+      stdsearchindex_equal_range_u64(&idx, key, &lo, &up);
+      ok &= lo == want[key] && up == hi;
+      stdsearchindex_equal_range(&idx, &key, &lo, &up);
+      ok &= lo == want[key] && up == hi;
+    }
+    stdsearchindex_lower_bound_batch(&idx, keys, sizeof(*keys), nkeys, got);
+    ok &= memcmp(got, want, nkeys*sizeof(size_t)) == 0;
+    (void)memset(got, 0, sizeof(got));
+    stdsearchindex_lower_bound_batch_u64(&idx, keys, nkeys, got);
+    ok &= memcmp(got, want, nkeys*sizeof(size_t)) == 0;
+    stdsearchindex_free(&idx);
+    stdvec_free(&vec);
+  }
+  cut_assert_true(ok);
+}
+
+struct range
+{
+  int64_t start;
+  int64_t id;
+};
+
+// Elements that start with their key: finds the range
+// a key falls in.
+void
+test_struct_elements(void)
+{
+  StdVec vec = stdvec_new(sizeof(struct range));
+  for (int64_t i = 0; i < 1000; ++i) {
+    struct range r = {i*10-5000, i};
+    stdvec_push(&vec, &r);
+  }
+  StdSearchIndex idx = stdsearchindex_new(&vec, NULL);
+  size_t i = stdsearchindex_upper_bound_i64(&idx, 37)-1;
+  cut_assert_eq(((struct range *)stdvec_at(&vec, i))->id, 503);
+  i = stdsearchindex_upper_bound_i64(&idx, -5000)-1;
+  cut_assert_eq(i, 0);
+  cut_assert_eq(stdsearchindex_upper_bound_i64(&idx, -5001), 0);
+  cut_assert_eq(stdsearchindex_lower_bound_i64(&idx, 1000000), 1000);
+  // The index is a copy.
+  stdvec_clr(&vec);
+  cut_assert_eq(stdsearchindex_lower_bound_i64(&idx, 0), 500);
+  stdsearchindex_free(&idx);
+  stdvec_free(&vec);
+}
+
+void
+test_large(void)
+{
+  size_t n = 1 << 18;
+  StdVec vec = stdvec_wcap(sizeof(float), n);
+  for (size_t i = 0; i < n; ++i) {
+    float x = (float)i*0.5f;
+    stdvec_push(&vec, &x);
+  }
+  StdSearchIndex idx = stdsearchindex_new(&vec, NULL);
+  cut_assert_eq(idx.depth, 19);
+  size_t bad = 0;
+  float keys[1000];
+  size_t out[1000];
+  for (size_t i = 0; i < 1000; ++i) {
+    keys[i] = (float)((i*7919) % n)*0.5f-0.25f;
+  }
+  stdsearchindex_lower_bound_batch_f32(&idx, keys, 1000, out);
+  for (size_t i = 0; i < 1000; ++i) {
+    bad += out[i] != (i*7919) % n;
+    bad += stdsearchindex_lower_bound_f32(&idx, keys[i]) != out[i];
+  }
+  cut_assert_eq(bad, 0);
+  stdsearchindex_free(&idx);
+  stdvec_free(&vec);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_matches_binary_search();
+  test_struct_elements();
+  test_large();
+  CUT_END;
+  return 0;
+}
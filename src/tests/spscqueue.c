@@ -0,0 +1,116 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDSPSCQUEUE_IMPL
+#include "../cstd.h"
+
+#define N_ITEMS 200000
+
+void
+test_try_push_pop(void)
+{
+  StdSpscQueue q = stdspscqueue_new(sizeof(int), 3);
+  cut_assert_eq(q.cap, 4);
+
+  for (int i = 0; i < 4; ++i) {
+    cut_assert_true(stdspscqueue_try_push(&q, &i));
+  }
+  cut_assert_false(stdspscqueue_try_push(&q, STDCL(int, 99)));
+  cut_assert_eq(stdspscqueue_len(&q), 4);
+
+  int x;
+  for (int i = 0; i < 4; ++i) {
+    cut_assert_true(stdspscqueue_try_pop(&q, &x));
+    cut_assert_eq(x, i);
+  }
+  cut_assert_false(stdspscqueue_try_pop(&q, &x));
+
+  stdspscqueue_free(&q);
+}
+
+void
+test_batch_wraparound(void)
+{
+  StdSpscQueue q = stdspscqueue_new(sizeof(int), 8);
+  int in[8] = {0,1,2,3,4,5,6,7};
+  int out[8] = {0};
+
+  cut_assert_eq(stdspscqueue_push_n(&q, in, 6), 6);
+  cut_assert_eq(stdspscqueue_pop_n(&q, out, 5), 5);
+  cut_assert_eq(stdspscqueue_push_n(&q, in, 8), 7);
+  cut_assert_eq(stdspscqueue_pop_n(&q, out, 8), 8);
+  cut_assert_eq(out[0], 5);
+  for (int i = 1; i < 8; ++i) {
+    cut_assert_eq(out[i], i-1);
+  }
+
+  stdspscqueue_free(&q);
+}
+
+void *
+producer(void *arg)
+{
+  StdSpscQueue *q = (StdSpscQueue *)arg;
+  int batch[16];
+  int i = 0;
+  while (i < N_ITEMS) {
+    // Alternate between single and batched pushes.
+    if (i % 3 == 0) {
+      stdspscqueue_push(q, &i);
+      ++i;
+      continue;
+    }
+    int n = 0;
+    while (n < 16 && i+n < N_ITEMS) {
+      batch[n] = i+n;
+      ++n;
+    }
+    size_t done = 0;
+    while (done < (size_t)n) {
+      done += stdspscqueue_push_n(q, batch+done, n-done);
+    }
+    i += n;
+  }
+  return NULL;
+}
+
+void
+test_two_threads(void)
+{
+  StdSpscQueue q = stdspscqueue_new(sizeof(int), 1024);
+  pthread_t t;
+  pthread_create(&t, NULL, producer, &q);
+
+  int expected = 0, in_order = 1;
+  int buf[32];
+  while (expected < N_ITEMS) {
+    size_t n = stdspscqueue_pop_n(&q, buf, 32);
+    if (n == 0) {
+      stdspscqueue_pop(&q, buf);
+      n = 1;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if (buf[i] != expected++) {
+        in_order = 0;
+      }
+    }
+  }
+
+  pthread_join(t, NULL);
+  cut_assert_true(in_order);
+  cut_assert_eq(stdspscqueue_len(&q), 0);
+
+  stdspscqueue_free(&q);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_try_push_pop();
+  test_batch_wraparound();
+  test_two_threads();
+  CUT_END;
+  return 0;
+}
@@ -44,12 +44,103 @@ test_inserting_small_num_of_elems(void)
   stdstack_free(&s);
 }
 
+void
+test_segmented_stable_addresses(void)
+{
+  StdStack s = stdstack_new_segmented(sizeof(int), 8);
+  int *ptrs[100];
+  for (int i = 0; i < 100; ++i) {
+    stdstack_push(&s, &i);
+    ptrs[i] = stdstack_peek(&s);
+  }
+  cut_assert_eq(s.len, 100);
+  for (int i = 0; i < 100; ++i) {
+    cut_assert_eq(*ptrs[i], i);
+  }
+
+  int v = -1;
+  for (int i = 99; i >= 0; --i) {
+    cut_assert_true(stdstack_pop_into(&s, &v));
+    cut_assert_eq(v, i);
+  }
+  cut_assert_false(stdstack_pop_into(&s, &v));
+  cut_assert_null(stdstack_peek(&s));
+  cut_assert_true(stdstack_empty(&s));
+
+  stdstack_free(&s);
+}
+
+void
+test_segmented_boundary_keeps_spare(void)
+{
+  StdStack s = stdstack_new_segmented(sizeof(int), 4);
+  for (int i = 0; i < 4; ++i) {
+    stdstack_push(&s, &i);
+  }
+  cut_assert_eq(s.cap, 4);
+
+  // Crossing the boundary back and forth reuses one chunk.
+  for (int i = 0; i < 10; ++i) {
+    stdstack_push(&s, &i);
+    cut_assert_eq(*(int *)stdstack_peek(&s), i);
+    stdstack_pop(&s);
+    cut_assert_eq(*(int *)stdstack_peek(&s), 3);
+  }
+  cut_assert_eq(s.cap, 8);
+  cut_assert_not_null(s.spare);
+
+  stdstack_free(&s);
+}
+
+void
+test_push_pop_n(int segmented)
+{
+  StdStack s = segmented
+    ? stdstack_new_segmented(sizeof(int), 16)
+    : stdstack_new(sizeof(int));
+  int in[100], out[100];
+  for (int i = 0; i < 100; ++i) {
+    in[i] = i;
+  }
+
+  stdstack_push_n(&s, in, 100);
+  cut_assert_eq(s.len, 100);
+  cut_assert_eq(*(int *)stdstack_peek(&s), 99);
+
+  size_t n = stdstack_pop_n(&s, out, 30);
+  cut_assert_eq(n, 30);
+  for (int i = 0; i < 30; ++i) {
+    cut_assert_eq(out[i], 70+i);
+  }
+  cut_assert_eq(*(int *)stdstack_peek(&s), 69);
+
+  n = stdstack_pop_n(&s, NULL, 5);
+  cut_assert_eq(n, 5);
+  cut_assert_eq(*(int *)stdstack_peek(&s), 64);
+
+  n = stdstack_pop_n(&s, out, 1000);
+  cut_assert_eq(n, 65);
+  for (int i = 0; i < 65; ++i) {
+    cut_assert_eq(out[i], i);
+  }
+  cut_assert_true(stdstack_empty(&s));
+
+  stdstack_push_n(&s, in, 3);
+  cut_assert_eq(*(int *)stdstack_peek(&s), 2);
+
+  stdstack_free(&s);
+}
+
 int
 main(void)
 {
   CUT_BEGIN;
   test_inserting_small_num_of_elems();
   test_inserting_large_num_of_elems();
+  test_segmented_stable_addresses();
+  test_segmented_boundary_keeps_spare();
+  test_push_pop_n(0);
+  test_push_pop_n(1);
   CUT_END;
   return 0;
 }
@@ -2,7 +2,9 @@
 #define CUT_SUPPRESS_TESTS
 #define CUT_IMPL
 #include "./cut.h"
+#define STD_MREMAP_THRESHOLD (1 << 16)
 #define STDSTR_IMPL
+#define STDVEC_IMPL
 #include "../cstd.h"
 #include <stdio.h>
 
@@ -110,6 +112,351 @@ test_creating_a_str_and_push(void)
   stdstr_free(&str);
 }
 
+// Without _GNU_SOURCE there is no mremap(), so a
+// string past the threshold grows by map and copy.
+void
+test_grow_past_mremap_threshold(void)
+{
+  StdStr str = stdstr_new();
+  size_t n = 1 << 18;
+  for (size_t i = 0; i < n; ++i) {
+    stdstr_push(&str, 'a'+i%26);
+  }
+  cut_assert_true(str.cap >= STD_MREMAP_THRESHOLD);
+  size_t bad = 0;
+  for (size_t i = 0; i < n; ++i) {
+    bad += str.data[i] != (char)('a'+i%26);
+  }
+  cut_assert_eq(bad, 0);
+  stdstr_free(&str);
+}
+
+void
+test_snapshot(void)
+{
+  const char *path = "./str.snap";
+  StdStr str = stdstr_from("hello, snapshot");
+  cut_assert_true(stdstr_save(&str, path));
+
+  StdStr loaded;
+  cut_assert_true(stdstr_load(&loaded, path));
+  cut_assert_eq(loaded.len, str.len);
+  cut_assert_eq(memcmp(loaded.data, str.data, str.len), 0);
+  stdstr_push(&loaded, '!');
+  cut_assert_eq(loaded.data[str.len], '!');
+  stdstr_free(&loaded);
+
+  // Not a snapshot at all.
+  FILE *fp = fopen(path, "wb");
+  fputs("hello, snapshot", fp);
+  fclose(fp);
+  errno = 0;
+  cut_assert_false(stdstr_load(&loaded, path));
+  cut_assert_eq(errno, EINVAL);
+  cut_assert_eq(remove(path), 0);
+  stdstr_free(&str);
+}
+
+// Writes `len` bytes of a pattern seeded by `seed`.
+void
+write_shard(const char *path, size_t len, int seed)
+{
+  FILE *fp = fopen(path, "wb");
+  for (size_t i = 0; i < len; ++i) {
+    fputc('a'+(i+seed)%26, fp);
+  }
+  fclose(fp);
+}
+
+int
+check_shard(const StdStr *str, size_t len, int seed)
+{
+  if (str->len != len) {
+    return 0;
+  }
+  for (size_t i = 0; i < len; ++i) {
+    if (str->data[i] != (char)('a'+(i+seed)%26)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void
+test_read_async(void)
+{
+  const char *path = "./async.shard";
+  write_shard(path, 100000, 3);
+  StdStrAsync *h = stdstr_read_async(path);
+  cut_assert_true(h != NULL);
+  while (!stdstr_async_poll(h)) {
+    sched_yield();
+  }
+  StdStr str;
+  cut_assert_true(stdstr_async_wait(h, &str));
+  cut_assert_true(check_shard(&str, 100000, 3));
+  stdstr_free(&str);
+
+  // Cancelling frees the handle whether or not
+  // the read got to finish.
+  h = stdstr_read_async(path);
+  cut_assert_true(h != NULL);
+  stdstr_async_cancel(h);
+
+  errno = 0;
+  h = stdstr_read_async("./no-such-file");
+  cut_assert_true(h == NULL);
+  cut_assert_eq(errno, ENOENT);
+  cut_assert_eq(remove(path), 0);
+}
+
+// More files than go in a single lio_listio() call,
+// one of them missing and one of them empty.
+void
+test_read_async_batch(void)
+{
+  enum { N = 150 };
+  char names[N][32];
+  const char *paths[N];
+  StdStrAsync *handles[N];
+  for (int i = 0; i < N; ++i) {
+    (void)snprintf(names[i], sizeof(names[i]), "./async-%d.shard", i);
+    paths[i] = names[i];
+    if (i != 7) {
+      write_shard(paths[i], i == 9 ? 0 : 1000+97*i, i);
+    }
+  }
+  size_t started = stdstr_read_async_batch(paths, N, handles);
+  cut_assert_eq(started, N-1);
+  cut_assert_true(handles[7] == NULL);
+
+  size_t seen = 0, good = 0;
+  for (size_t i; (i = stdstr_async_wait_any(handles, N)) < N; handles[i] = NULL) {
+    StdStr str;
+    seen += 1;
+    if (stdstr_async_wait(handles[i], &str)) {
+      good += check_shard(&str, i == 9 ? 0 : 1000+97*i, (int)i);
+      stdstr_free(&str);
+    }
+  }
+  cut_assert_eq(seen, N-1);
+  cut_assert_eq(good, N-1);
+  for (int i = 0; i < N; ++i) {
+    (void)remove(paths[i]);
+  }
+}
+
+void
+test_parse_ints(void)
+{
+  int64_t i;
+  uint64_t u;
+  const char *text = "-9223372036854775808,";
+  StdParseResult r = stdstr_parse_i64(text, strlen(text), &i);
+  cut_assert_eq(r.err, STD_PARSE_OK);
+  cut_assert_eq(r.len, 20);
+  cut_assert_true(i == INT64_MIN);
+
+  text = "9223372036854775808";
+  r = stdstr_parse_i64(text, strlen(text), &i);
+  cut_assert_eq(r.err, STD_PARSE_RANGE);
+  cut_assert_true(i == INT64_MAX);
+
+  text = "18446744073709551615";
+  r = stdstr_parse_u64(text, strlen(text), &u);
+  cut_assert_eq(r.err, STD_PARSE_OK);
+  cut_assert_true(u == UINT64_MAX);
+  r = stdstr_parse_u64("18446744073709551616", 20, &u);
+  cut_assert_eq(r.err, STD_PARSE_RANGE);
+  cut_assert_eq(r.len, 20);
+
+  // Leading zeros do not count towards the 19 digits
+  // that always fit, and `len` bounds the read.
+  text = "000000000000000000000000012345678";
+  r = stdstr_parse_u64(text, strlen(text)-3, &u);
+  cut_assert_eq(r.err, STD_PARSE_OK);
+  cut_assert_eq(u, 12345);
+
+  r = stdstr_parse_i64("+42abc", 6, &i);
+  cut_assert_eq(r.len, 3);
+  cut_assert_eq(i, 42);
+  r = stdstr_parse_u64("-1", 2, &u);
+  cut_assert_eq(r.err, STD_PARSE_INVALID);
+  cut_assert_eq(r.len, 0);
+  r = stdstr_parse_i64("-", 1, &i);
+  cut_assert_eq(r.err, STD_PARSE_INVALID);
+  r = stdstr_parse_i64("", 0, &i);
+  cut_assert_eq(r.err, STD_PARSE_INVALID);
+}
+
+// The result must be the same double as strtod() gives,
+// for the same number of bytes, and errno is not used.
+int
+parse_like_strtod(const char *text)
+{
+  char *end;
+  double want = strtod(text, &end), got;
+  errno = 0;
+  StdParseResult r = stdstr_parse_f64(text, strlen(text), &got);
+  return errno == 0 && r.len == (size_t)(end-text)
+    && memcmp(&want, &got, sizeof(got)) == 0;
+}
+
+void
+test_parse_f64(void)
+{
+  const char *cases[] = {
+    "0", "-0", "0.1", "1e23", "-.5e+3", "5.", "1e", "1e+",
+    "9007199254740993",
+    "2.2250738585072011e-308",
+    "4.9406564584124654e-324",
+    "1.7976931348623157e308",
+    // Halfway between two doubles, and just off it,
+    // which only the slow path can tell apart.
+    "1.00000000000000011102230246251565404236316680908203125",
+    "1.00000000000000011102230246251565404236316680908203124999",
+    "1.00000000000000011102230246251565404236316680908203125001",
+    "123456789012345678901234567890e-10",
+    "0.000000000000000000000000000000000000000000000000000000001234",
+  };
+  int ok = 1;
+  for (size_t k = 0; k < sizeof(cases)/sizeof(*cases); ++k) {
+    ok &= parse_like_strtod(cases[k]);
+  }
+  cut_assert_true(ok);
+
+  // Random doubles printed with every precision.
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  char buf[64];
+  for (int k = 0; k < 100000 && ok; ++k) {
+    state = state*6364136223846793005ull+1442695040888963407ull;
+    double d;
+    (void)memcpy(&d, &state, sizeof(d));
+    if (d != d || d == __builtin_inf() || d == -__builtin_inf()) {
+      continue;
+    }
+    (void)snprintf(buf, sizeof(buf), "%.*g", 1+k%17, d);
+    ok &= parse_like_strtod(buf);
+  }
+  cut_assert_true(ok);
+
+  double d;
+  StdParseResult r = stdstr_parse_f64("1e400", 5, &d);
+  cut_assert_eq(r.err, STD_PARSE_RANGE);
+  cut_assert_true(d == __builtin_inf());
+  r = stdstr_parse_f64("-1e-400", 7, &d);
+  cut_assert_eq(r.err, STD_PARSE_RANGE);
+  cut_assert_true(d == 0);
+  r = stdstr_parse_f64("-Infinity", 9, &d);
+  cut_assert_eq(r.len, 9);
+  cut_assert_true(d == -__builtin_inf());
+  r = stdstr_parse_f64("nan", 3, &d);
+  cut_assert_true(r.err == STD_PARSE_OK && d != d);
+  r = stdstr_parse_f64(".e1", 3, &d);
+  cut_assert_eq(r.err, STD_PARSE_INVALID);
+  // Not null terminated: the 5 after `len` is not read.
+  r = stdstr_parse_f64("1.25", 3, &d);
+  cut_assert_eq(r.len, 3);
+  cut_assert_true(d == 1.2);
+}
+
+void
+test_parse_column(void)
+{
+  const char *text = "1.5\n-2\n3e2\n";
+  StdVec v = stdvec_new(sizeof(double));
+  StdParseResult r = stdstr_parse_column_f64(text, strlen(text), '\n', &v);
+  cut_assert_eq(r.err, STD_PARSE_OK);
+  cut_assert_eq(r.len, strlen(text));
+  cut_assert_eq(v.len, 3);
+  cut_assert_true(*(double *)stdvec_at(&v, 2) == 300.0);
+  stdvec_free(&v);
+
+  text = "7,8,x9,10";
+  v = stdvec_new(sizeof(int64_t));
+  r = stdstr_parse_column_i64(text, strlen(text), ',', &v);
+  cut_assert_eq(r.err, STD_PARSE_INVALID);
+  cut_assert_eq(r.len, 4);
+  cut_assert_eq(v.len, 2);
+  stdvec_clr(&v);
+  text = "7,8 ,9";
+  r = stdstr_parse_column_i64(text, strlen(text), ',', &v);
+  cut_assert_eq(r.err, STD_PARSE_INVALID);
+  cut_assert_eq(r.len, 3);
+  stdvec_free(&v);
+}
+
+// Strings from a tiny alphabet that includes '\0', of
+// all lengths and with long shared prefixes, so there
+// are many duplicates, prefixes of others, and ranges
+// that cross the 8-byte cached prefixes.
+StdStr
+random_str(uint64_t *state)
+{
+  static const char prefixes[][24] = {"", "shared-prefix/", "shared-prefix/longer/"};
+  *state = *state*6364136223846793005ull+1442695040888963407ull;
+  StdStr str = stdstr_new();
+  stdstr_append(&str, (char *)prefixes[*state >> 62 == 3 ? 0 : *state >> 62]);
+  size_t len = (*state >> 32)%13;
+  for (size_t i = 0; i < len; ++i) {
+    *state = *state*6364136223846793005ull+1442695040888963407ull;
+    stdstr_push(&str, "\0abz\xff"[(*state >> 40)%5]);
+  }
+  return str;
+}
+
+void
+test_radix_sort(void)
+{
+  uint64_t state = 7;
+  size_t n = 5000;
+  StdVec v = stdvec_new(sizeof(StdStr));
+  for (size_t i = 0; i < n; ++i) {
+    StdStr str = random_str(&state);
+    stdvec_push(&v, &str);
+  }
+  StdStr *want = malloc(n*sizeof(StdStr));
+  (void)memcpy(want, v.data, n*sizeof(StdStr));
+  qsort(want, n, sizeof(StdStr), stdstr_cmp);
+
+  stdvec_radix_sort_str(&v);
+  StdStr *got = v.data;
+  size_t bad = 0;
+  for (size_t i = 0; i < n; ++i) {
+    bad += stdstr_cmp(&got[i], &want[i]) != 0;
+  }
+  cut_assert_eq(bad, 0);
+
+  // Views into one buffer sort the same way.
+  StdStrView *views = malloc(n*sizeof(StdStrView));
+  for (size_t i = 0; i < n; ++i) {
+    views[i] = stdstrview_from(&got[n-1-i]);
+  }
+  stdstrview_radix_sort(views, n);
+  for (size_t i = 0; i < n; ++i) {
+    bad += stdstrview_cmp(views[i], stdstrview_from(&want[i])) != 0;
+  }
+  cut_assert_eq(bad, 0);
+
+  // Sorting did not lose or duplicate any StdStr.
+  qsort(want, n, sizeof(StdStr), stdstr_cmp);
+  for (size_t i = 0; i < n; ++i) {
+    stdstr_free(&got[i]);
+  }
+  stdvec_free(&v);
+  free(views);
+  free(want);
+
+  StdStrView small[3] = {
+    stdstrview_new("b", 1), stdstrview_new("ab", 2), stdstrview_new("a", 1),
+  };
+  stdstrview_radix_sort(small, 3);
+  cut_assert_eq(small[0].len, 1);
+  cut_assert_eq(small[0].data[0], 'a');
+  cut_assert_eq(small[2].data[0], 'b');
+  stdstrview_radix_sort(small, 0);
+}
+
 int
 main(void)
 {
@@ -119,6 +466,14 @@ main(void)
   test_appending_a_str();
   test_reading_from_file();
   test_removing_all_chars_matching_value();
+  test_grow_past_mremap_threshold();
+  test_snapshot();
+  test_read_async();
+  test_read_async_batch();
+  test_parse_ints();
+  test_parse_f64();
+  test_parse_column();
+  test_radix_sort();
   CUT_END;
   return 0;
 }
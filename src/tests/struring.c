@@ -0,0 +1,135 @@
+#define CUT_ABORT_ON_FAIL
+#define CUT_SUPPRESS_TESTS
+#define CUT_IMPL
+#include "./cut.h"
+#define STD_STR_IO_URING
+#define STDSTR_IMPL
+#include "../cstd.h"
+#include <stdio.h>
+
+#define N_THREADS 4
+
+// Writes `len` bytes of a pattern seeded by `seed`.
+void
+write_shard(const char *path, size_t len, int seed)
+{
+  FILE *fp = fopen(path, "wb");
+  for (size_t i = 0; i < len; ++i) {
+    fputc('a'+(i+seed)%26, fp);
+  }
+  fclose(fp);
+}
+
+int
+check_shard(const StdStr *str, size_t len, int seed)
+{
+  if (str->len != len) {
+    return 0;
+  }
+  for (size_t i = 0; i < len; ++i) {
+    if (str->data[i] != (char)('a'+(i+seed)%26)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void
+test_read_async(void)
+{
+  const char *path = "./uring.shard";
+  write_shard(path, 100000, 3);
+  StdStrAsync *h = stdstr_read_async(path);
+  cut_assert_true(h != NULL);
+  while (!stdstr_async_poll(h)) {
+    sched_yield();
+  }
+  StdStr str;
+  cut_assert_true(stdstr_async_wait(h, &str));
+  cut_assert_true(check_shard(&str, 100000, 3));
+  stdstr_free(&str);
+
+  h = stdstr_read_async(path);
+  cut_assert_true(h != NULL);
+  stdstr_async_cancel(h);
+
+  errno = 0;
+  h = stdstr_read_async("./no-such-file");
+  cut_assert_true(h == NULL);
+  cut_assert_eq(errno, ENOENT);
+  cut_assert_eq(remove(path), 0);
+}
+
+// Reads `N` files, more than fit in the ring at once,
+// one of them missing and one of them empty. Some are
+// cancelled while they may still wait for room.
+void *
+read_batch(void *arg)
+{
+  enum { N = 150 };
+  int id = (int)(intptr_t)arg;
+  char names[N][32];
+  const char *paths[N];
+  StdStrAsync *handles[N];
+  for (int i = 0; i < N; ++i) {
+    (void)snprintf(names[i], sizeof(names[i]), "./uring-%d-%d.shard", id, i);
+    paths[i] = names[i];
+    if (i != 7) {
+      write_shard(paths[i], i == 9 ? 0 : 1000+97*i, i);
+    }
+  }
+  size_t started = stdstr_read_async_batch(paths, N, handles);
+  size_t cancelled = 0;
+  for (int i = 100; i < N; i += 10) {
+    stdstr_async_cancel(handles[i]);
+    handles[i] = NULL;
+    cancelled += 1;
+  }
+
+  size_t good = 0;
+  for (size_t i; (i = stdstr_async_wait_any(handles, N)) < N; handles[i] = NULL) {
+    StdStr str;
+    if (stdstr_async_wait(handles[i], &str)) {
+      good += check_shard(&str, i == 9 ? 0 : 1000+97*i, (int)i);
+      stdstr_free(&str);
+    }
+  }
+  for (int i = 0; i < N; ++i) {
+    (void)remove(paths[i]);
+  }
+  int ok = started == N-1 && good == N-1-cancelled;
+  return ok ? NULL : (void *)1;
+}
+
+void
+test_read_async_batch(void)
+{
+  cut_assert_null(read_batch(0));
+}
+
+// Threads waiting on the ring at the same time each
+// get their own reads.
+void
+test_many_threads(void)
+{
+  pthread_t threads[N_THREADS];
+  for (int i = 0; i < N_THREADS; ++i) {
+    pthread_create(&threads[i], NULL, read_batch, (void *)(intptr_t)(i+1));
+  }
+  for (int i = 0; i < N_THREADS; ++i) {
+    void *ret;
+    pthread_join(threads[i], &ret);
+    cut_assert_null(ret);
+  }
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_read_async();
+  test_read_async_batch();
+  test_many_threads();
+  CUT_END;
+  return 0;
+}
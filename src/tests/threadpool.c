@@ -0,0 +1,131 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDTHREADPOOL_IMPL
+#include "../cstd.h"
+
+StdThreadPool *pool;
+
+void *
+square(void *arg)
+{
+  long x = (long)(intptr_t)arg;
+  return (void *)(intptr_t)(x*x);
+}
+
+struct Fib
+{
+  int n;
+  long result;
+};
+
+// Fork-join fib, spawning one branch and
+// running the other on the current thread.
+void *
+fib(void *arg)
+{
+  struct Fib *f = (struct Fib *)arg;
+  if (f->n < 2) {
+    f->result = f->n;
+    return NULL;
+  }
+  struct Fib a = { .n = f->n-1 }, b = { .n = f->n-2 };
+  StdTaskGroup group = stdtaskgroup_new(pool);
+  stdtaskgroup_spawn(&group, fib, &a);
+  fib(&b);
+  stdtaskgroup_wait(&group);
+  f->result = a.result+b.result;
+  return NULL;
+}
+
+void
+add_range(void *first, size_t begin, size_t n, void *ctx)
+{
+  long sum = 0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += ((int *)first)[i];
+  }
+  (void)begin;
+  atomic_fetch_add((_Atomic long *)ctx, sum);
+}
+
+void
+mark_range(void *first, size_t begin, size_t n, void *ctx)
+{
+  for (size_t i = 0; i < n; ++i) {
+    ((int *)first)[i] += (int)(begin+i);
+  }
+  (void)ctx;
+}
+
+void
+test_futures(void)
+{
+  StdFuture *futures[100];
+  for (long i = 0; i < 100; ++i) {
+    futures[i] = stdthreadpool_submit(pool, square, (void *)(intptr_t)i);
+  }
+  int all_ok = 1;
+  for (long i = 0; i < 100; ++i) {
+    if ((long)(intptr_t)stdfuture_get(futures[i]) != i*i) {
+      all_ok = 0;
+    }
+  }
+  cut_assert_true(all_ok);
+}
+
+void
+test_fork_join(void)
+{
+  struct Fib f = { .n = 20 };
+  fib(&f);
+  cut_assert_eq(f.result, 6765);
+
+  // Also from inside of the pool.
+  struct Fib g = { .n = 18 };
+  StdFuture *fut = stdthreadpool_submit(pool, fib, &g);
+  stdfuture_get(fut);
+  cut_assert_eq(g.result, 2584);
+}
+
+void
+test_parallel_for(void)
+{
+  size_t n = 100000;
+  int *arr = malloc(n*sizeof(int));
+  for (size_t i = 0; i < n; ++i) {
+    arr[i] = 1;
+  }
+
+  _Atomic long sum = 0;
+  stdthreadpool_parallel_for(pool, arr, sizeof(int), n, 1000, add_range, &sum);
+  long total = atomic_load(&sum);
+  cut_assert_eq(total, (long)n);
+
+  // Every element is visited exactly once, with the
+  // right index, on the default pool with auto grain.
+  std_parallel_for(arr, sizeof(int), n, 0, mark_range, NULL);
+  int all_ok = 1;
+  for (size_t i = 0; i < n; ++i) {
+    if (arr[i] != (int)i+1) {
+      all_ok = 0;
+    }
+  }
+  cut_assert_true(all_ok);
+
+  free(arr);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  pool = stdthreadpool_new(4);
+  test_futures();
+  test_fork_join();
+  test_parallel_for();
+  stdthreadpool_free(pool);
+  CUT_END;
+  return 0;
+}
@@ -0,0 +1,100 @@
+#define CUT_SUPPRESS_TESTS
+#define CUT_ABORT_ON_FAIL
+#define CUT_IMPL
+#include "./cut.h"
+#define STDVEC_IMPL
+#define STDVARIANT_IMPL
+#include "../cstd.h"
+
+typedef struct { int x, y; } Point;
+
+STDVARIANT_DECL(Event, (int, click), (double, scroll), (Point, move));
+
+void
+test_basic_variant(void)
+{
+  Event e = Event_click(3);
+  cut_assert_eq(e.tag, Event_TAG_click);
+  cut_assert_eq(e.as.click, 3);
+  cut_assert_not_null(Event_get_click(&e));
+  cut_assert_null(Event_get_scroll(&e));
+
+  Point pt = {4, 5};
+  e = Event_move(pt);
+  cut_assert_eq(e.tag, Event_TAG_move);
+  cut_assert_eq(Event_get_move(&e)->y, 5);
+  cut_assert_null(Event_get_click(&e));
+
+  cut_assert_eq(Event_TAG_COUNT, 3);
+  cut_assert_true(sizeof(Event) <= 2*sizeof(double));
+}
+
+void
+on_click(int *value, void *ctx)
+{
+  *(double *)ctx += *value;
+}
+
+void
+on_scroll(double *value, void *ctx)
+{
+  *(double *)ctx += *value*10;
+}
+
+void
+on_move(Point *value, void *ctx)
+{
+  *(double *)ctx += value->x*100+value->y*1000;
+}
+
+void
+test_visit(void)
+{
+  double total = 0;
+  Event e = Event_scroll(.5);
+  STDVARIANT_VISIT(Event, &e, &total, .click = on_click, .scroll = on_scroll);
+  cut_assert_true(total == 5.);
+
+  // Members without a callback are skipped.
+  e = Event_move((Point){1, 1});
+  STDVARIANT_VISIT(Event, &e, &total, .click = on_click, .scroll = on_scroll);
+  cut_assert_true(total == 5.);
+
+  EventVisitor visitor = {on_click, on_scroll, on_move};
+  Event_visit(&e, &visitor, &total);
+  cut_assert_true(total == 1105.);
+}
+
+void
+test_variant_in_vec(void)
+{
+  StdVec v = stdvec_new(sizeof(Event));
+  for (int i = 0; i < 300; ++i) {
+    Event e = i%3 == 0 ? Event_click(i)
+      : i%3 == 1 ? Event_scroll(i)
+      : Event_move((Point){i, 0});
+    stdvec_push(&v, &e);
+  }
+  cut_assert_eq(v.stride, sizeof(Event));
+
+  EventVisitor visitor = {on_click, on_scroll, on_move};
+  double total = 0, want = 0;
+  for (size_t i = 0; i < v.len; ++i) {
+    Event_visit(stdvec_at(&v, i), &visitor, &total);
+    want += i%3 == 0 ? (double)i : i%3 == 1 ? (double)i*10 : (double)i*100;
+  }
+  cut_assert_true(total == want);
+
+  stdvec_free(&v);
+}
+
+int
+main(void)
+{
+  CUT_BEGIN;
+  test_basic_variant();
+  test_visit();
+  test_variant_in_vec();
+  CUT_END;
+  return 0;
+}
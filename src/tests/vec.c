@@ -1,7 +1,9 @@
+#define _GNU_SOURCE
 #define CUT_SUPPRESS_TESTS
 #define CUT_ABORT_ON_FAIL
 #define CUT_IMPL
 #include "./cut.h"
+#define STD_MREMAP_THRESHOLD (1 << 16)
 #define STDVEC_IMPL
 #include "../cstd.h"
 #include <stdio.h>
@@ -197,6 +199,108 @@ test_push_small_number_of_elems(void)
   stdvec_free(&vec);
 }
 
+// With a low threshold the vector crosses into its own
+// mapping early and then grows with mremap().
+void
+test_grow_past_mremap_threshold(void)
+{
+  StdVec v = stdvec_new(sizeof(size_t));
+  size_t n = 1 << 18;
+  for (size_t i = 0; i < n; ++i) {
+    stdvec_push(&v, &i);
+  }
+  cut_assert_true(v.cap*v.stride >= STD_MREMAP_THRESHOLD);
+  size_t bad = 0;
+  for (size_t i = 0; i < n; ++i) {
+    bad += *(size_t *)stdvec_at(&v, i) != i;
+  }
+  cut_assert_eq(bad, 0);
+  stdvec_free(&v);
+
+  // Starting out above the threshold.
+  v = stdvec_wcap(sizeof(size_t), n);
+  for (size_t i = 0; i < 2*n; ++i) {
+    stdvec_push(&v, &i);
+  }
+  cut_assert_eq(*(size_t *)stdvec_at(&v, 2*n-1), 2*n-1);
+  stdvec_free(&v);
+}
+
+// Saves to, loads from and maps the same snapshot, and
+// makes sure a damaged one is refused.
+void
+test_snapshot(void)
+{
+  const char *path = "./vec.snap";
+  StdVec v = stdvec_new(sizeof(double));
+  size_t n = 10000;
+  for (size_t i = 0; i < n; ++i) {
+    double d = (double)i/3;
+    stdvec_push(&v, &d);
+  }
+  cut_assert_true(stdvec_save(&v, path));
+
+  StdVec loaded;
+  cut_assert_true(stdvec_load(&loaded, path));
+  cut_assert_eq(loaded.len, n);
+  cut_assert_eq(loaded.stride, sizeof(double));
+  cut_assert_eq(memcmp(loaded.data, v.data, n*sizeof(double)), 0);
+  // A loaded vector is an ordinary one.
+  double d = -1;
+  stdvec_push(&loaded, &d);
+  cut_assert_eq(loaded.len, n+1);
+  stdvec_free(&loaded);
+
+  StdVec mapped;
+  cut_assert_true(stdvec_map_snapshot(&mapped, path, 1));
+  cut_assert_eq(mapped.len, n);
+  cut_assert_eq((uintptr_t)mapped.data % __STD_CACHE_LINE, 0);
+  cut_assert_eq(memcmp(mapped.data, v.data, n*sizeof(double)), 0);
+  stdvec_free(&mapped);
+
+  // Flip a bit of an element: only a checked load notices.
+  FILE *fp = fopen(path, "r+b");
+  fseek(fp, 64+8*100, SEEK_SET);
+  fputc(0x10, fp);
+  fclose(fp);
+  errno = 0;
+  cut_assert_false(stdvec_load(&loaded, path));
+  cut_assert_eq(errno, EINVAL);
+  cut_assert_false(stdvec_map_snapshot(&mapped, path, 1));
+  cut_assert_true(stdvec_map_snapshot(&mapped, path, 0));
+  stdvec_free(&mapped);
+
+  // A truncated file does not match its header.
+  cut_assert_eq(truncate(path, 64+8*10), 0);
+  cut_assert_false(stdvec_map_snapshot(&mapped, path, 0));
+  cut_assert_eq(errno, EINVAL);
+  cut_assert_eq(remove(path), 0);
+  cut_assert_false(stdvec_load(&loaded, path));
+  cut_assert_eq(errno, ENOENT);
+
+  // Empty vectors round-trip too.
+  stdvec_clr(&v);
+  cut_assert_true(stdvec_save(&v, path));
+  cut_assert_true(stdvec_map_snapshot(&mapped, path, 1));
+  cut_assert_eq(mapped.len, 0);
+  stdvec_free(&mapped);
+  cut_assert_true(stdvec_load(&loaded, path));
+  cut_assert_eq(loaded.len, 0);
+  stdvec_free(&loaded);
+  cut_assert_eq(remove(path), 0);
+  stdvec_free(&v);
+}
+
+// Built without STD_INSTRUMENT, the hooks still compile.
+void
+test_instrument_off(void)
+{
+  StdInstrumentStats st = {.allocs = 1};
+  cut_assert_false(std_instrument_stats("stdvec", &st));
+  cut_assert_eq(st.allocs, 0);
+  std_instrument_dump(stderr, 0);
+}
+
 int
 main(void)
 {
@@ -211,6 +315,9 @@ main(void)
   test_map();
   test_qsort();
   test_reverse();
+  test_grow_past_mremap_threshold();
+  test_snapshot();
+  test_instrument_off();
   CUT_END;
   return 0;
 }